@@ -0,0 +1,48 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+
+#include "Analysis/HappensBeforeGraph.h"
+#include "Corpus.h"
+
+namespace {
+
+// Happens-before queries, in both directions, for the pairs the race checker checks
+// The graph is built once, outside of the timed loop
+void BM_CanReach(benchmark::State &state, const char *file, race::HappensBeforeGraph::Engine engine) {
+  auto const trace = bench::getTraceOrSkip(state, file);
+  if (!trace) return;
+  auto const pairs = bench::getCheckedPairs(*trace);
+  race::HappensBeforeGraph const happensbefore(*trace, engine);
+
+  for (auto _ : state) {
+    for (auto const &[write, other] : pairs) {
+      benchmark::DoNotOptimize(happensbefore.canReach(write, other));
+      benchmark::DoNotOptimize(happensbefore.canReach(other, write));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs.size() * 2));
+  state.counters["pairs"] = pairs.size();
+}
+
+#define CAN_REACH_BENCHMARKS(NAME, FILE)                                                                    \
+  BENCHMARK_CAPTURE(BM_CanReach, NAME/reachability, FILE, race::HappensBeforeGraph::Engine::Reachability) \
+      ->Unit(benchmark::kMicrosecond);                                                                    \
+  BENCHMARK_CAPTURE(BM_CanReach, NAME/vectorclock, FILE, race::HappensBeforeGraph::Engine::VectorClock)   \
+      ->Unit(benchmark::kMicrosecond);
+
+CAN_REACH_BENCHMARKS(DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+CAN_REACH_BENCHMARKS(DRB169, "integration/dataracebench/DRB169-missingsyncwrite-orig-yes.ll")
+CAN_REACH_BENCHMARKS(PthreadAccount, "integration/pthreadrace/pthread-account-no.ll")
+CAN_REACH_BENCHMARKS(PthreadBarrier, "integration/pthreadrace/pthread-barrier-no.ll")
+
+}  // namespace
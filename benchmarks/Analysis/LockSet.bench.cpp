@@ -0,0 +1,45 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+
+#include "Analysis/LockSet.h"
+#include "Corpus.h"
+
+namespace {
+
+// Lock queries for the pairs the race checker checks
+// Results are memoized per pair of locksets, so after the first iteration this measures the memoized lookups,
+// the state the race checker is in for most of the pairs
+void BM_SharesLock(benchmark::State &state, const char *file) {
+  auto const trace = bench::getTraceOrSkip(state, file);
+  if (!trace) return;
+  auto const pairs = bench::getCheckedPairs(*trace);
+  race::LockSet lockset(*trace);
+
+  for (auto _ : state) {
+    for (auto const &[write, other] : pairs) {
+      benchmark::DoNotOptimize(lockset.sharesLock(write, other));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs.size()));
+  state.counters["pairs"] = pairs.size();
+}
+BENCHMARK_CAPTURE(BM_SharesLock, DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharesLock, OmpLockSetUnset, "integration/openmp/lock-set-unset-yes.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharesLock, PthreadAccount, "integration/pthreadrace/pthread-account-no.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharesLock, PthreadSpinlock, "integration/pthreadrace/pthread-spinlock-no.ll")
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,39 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+
+#include "Analysis/SharedMemory.h"
+#include "Corpus.h"
+
+namespace {
+
+// Building the index of accesses per shared object from a trace built once
+void BM_SharedMemory(benchmark::State &state, const char *file) {
+  auto const trace = bench::getTraceOrSkip(state, file);
+  if (!trace) return;
+
+  for (auto _ : state) {
+    race::SharedMemory const sharedmem(*trace);
+    benchmark::DoNotOptimize(&sharedmem);
+  }
+  state.counters["sharedObjects"] = race::SharedMemory(*trace).getSharedObjects().size();
+}
+BENCHMARK_CAPTURE(BM_SharedMemory, DRB001, "integration/dataracebench/DRB001-antidep1-orig-yes.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharedMemory, DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharedMemory, DRB110, "integration/dataracebench/DRB110-ordered-orig-no.ll")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SharedMemory, PthreadVector, "integration/pthreadrace/pthread-vector-yes.ll")
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,74 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "Corpus.h"
+
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <map>
+
+namespace bench {
+
+std::unique_ptr<llvm::Module> loadModule(const std::string &file, llvm::LLVMContext &context) {
+  llvm::SMDiagnostic err;
+  return llvm::parseIRFile(std::string(BENCHMARK_DATA_DIR) + file, err, context);
+}
+
+namespace {
+
+struct CachedTrace {
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module;
+  std::unique_ptr<race::ProgramTrace> trace;
+};
+
+}  // namespace
+
+const race::ProgramTrace *getTrace(const std::string &file) {
+  static std::map<std::string, std::unique_ptr<CachedTrace>> cache;
+
+  auto &cached = cache[file];
+  if (!cached) {
+    cached = std::make_unique<CachedTrace>();
+    cached->module = loadModule(file, cached->context);
+    if (cached->module) {
+      cached->trace = std::make_unique<race::ProgramTrace>(cached->module.get());
+    }
+  }
+  return cached->trace.get();
+}
+
+const race::ProgramTrace *getTraceOrSkip(benchmark::State &state, const std::string &file) {
+  auto const trace = getTrace(file);
+  if (!trace) {
+    state.SkipWithError("could not parse IR file");
+  }
+  return trace;
+}
+
+std::vector<RacePair> getCheckedPairs(const race::ProgramTrace &trace) {
+  race::SharedMemory const sharedmem(trace);
+  std::vector<RacePair> pairs;
+  // same order as the race checker
+  for (auto const obj : sharedmem.getSharedObjects()) {
+    auto const more = sharedmem.forEachPair(obj, [&](const race::WriteEvent *write, const race::MemAccessEvent *other) {
+      if (!race::SharedMemory::isFirstCommonObject(obj, write, other)) return true;
+      if (pairs.size() >= MAX_PAIRS) return false;
+      pairs.emplace_back(write, other);
+      return true;
+    });
+    if (!more) break;
+  }
+  return pairs;
+}
+
+}  // namespace bench
@@ -0,0 +1,48 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Analysis/SharedMemory.h"
+#include "Trace/ProgramTrace.h"
+
+// Inputs shared by the benchmarks, all taken from the IR files generated for the tests
+namespace bench {
+
+using RacePair = std::pair<const race::WriteEvent *, const race::MemAccessEvent *>;
+
+// Parse file, relative to tests/data/. Null if it could not be parsed
+std::unique_ptr<llvm::Module> loadModule(const std::string &file, llvm::LLVMContext &context);
+
+// Upper bound on the number of pairs the micro benchmarks run their query on
+constexpr size_t MAX_PAIRS = 1 << 16;
+
+// Trace of file under the default context policy, built on first use and kept until the process exits
+// so the micro benchmarks on the same file only pay for the pointer analysis once. Null if file could not be parsed
+const race::ProgramTrace *getTrace(const std::string &file);
+
+// getTrace, but marks the benchmark as skipped if file could not be parsed
+const race::ProgramTrace *getTraceOrSkip(benchmark::State &state, const std::string &file);
+
+// Every pair of accesses the race checker checks, once each: accesses to the same shared object by different
+// threads, at least one of them a write. Stops after MAX_PAIRS pairs, the order is the same on every run
+std::vector<RacePair> getCheckedPairs(const race::ProgramTrace &trace);
+
+}  // namespace bench
@@ -0,0 +1,107 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/IR/LLVMContext.h>
+
+#include "Corpus.h"
+#include "LanguageModel/RaceModel.h"
+#include "PreProcessing/PreProcessing.h"
+
+namespace {
+
+// Size of the hashed edge bitmap PartialUpdateSolver used to track pending copy edges
+constexpr size_t OLD_HASH_EDGE_LIMIT = 1000032953;
+
+// One solver round of tracking pending copy edges: record them, query them, then clear for the next round
+void BM_RequiredEdges_HashBitmap(benchmark::State &state) {
+  auto const numEdges = static_cast<pta::NodeID>(state.range(0));
+  llvm::BitVector requiredEdge(OLD_HASH_EDGE_LIMIT);
+  for (auto _ : state) {
+    for (pta::NodeID i = 0; i < numEdges; ++i) {
+      requiredEdge.set(llvm::hash_value(std::make_pair(i, i + 1)) % OLD_HASH_EDGE_LIMIT);
+    }
+    for (pta::NodeID i = 0; i < numEdges; ++i) {
+      benchmark::DoNotOptimize(requiredEdge.test(llvm::hash_value(std::make_pair(i, i + 1)) % OLD_HASH_EDGE_LIMIT));
+    }
+    requiredEdge.reset();
+  }
+}
+BENCHMARK(BM_RequiredEdges_HashBitmap)->Arg(16)->Arg(1024)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
+void BM_RequiredEdges_DenseSet(benchmark::State &state) {
+  auto const numEdges = static_cast<pta::NodeID>(state.range(0));
+  llvm::DenseSet<std::pair<pta::NodeID, pta::NodeID>> requiredEdge;
+  for (auto _ : state) {
+    for (pta::NodeID i = 0; i < numEdges; ++i) {
+      requiredEdge.insert({i, i + 1});
+    }
+    for (pta::NodeID i = 0; i < numEdges; ++i) {
+      benchmark::DoNotOptimize(requiredEdge.count({i, i + 1}));
+    }
+    requiredEdge.clear();
+  }
+}
+BENCHMARK(BM_RequiredEdges_DenseSet)->Arg(16)->Arg(1024)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
+// Cost of creating the edge tracking structure, paid once per solver
+void BM_RequiredEdges_HashBitmapStartup(benchmark::State &state) {
+  for (auto _ : state) {
+    llvm::BitVector requiredEdge(OLD_HASH_EDGE_LIMIT);
+    benchmark::DoNotOptimize(requiredEdge.size());
+  }
+}
+BENCHMARK(BM_RequiredEdges_HashBitmapStartup)->Unit(benchmark::kMillisecond);
+
+// End to end pointer analysis on small inputs, where solver startup dominates
+void BM_PartialUpdateSolver(benchmark::State &state, const char *file) {
+  llvm::LLVMContext context;
+  size_t nodes = 0;
+  size_t constraints = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto module = bench::loadModule(file, context);
+    if (!module) {
+      state.SkipWithError("could not parse IR file");
+      break;
+    }
+    preprocess(*module);
+    state.ResumeTiming();
+
+    pta::PTA pta;
+    pta.analyze(module.get(), "main");
+    nodes = pta.getConsGraph()->getNodeNum();
+    constraints = pta.getNumConstraints();
+  }
+  state.counters["nodes"] = nodes;
+  state.counters["constraints"] = constraints;
+}
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, DRB001, "integration/dataracebench/DRB001-antidep1-orig-yes.ll")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, DRB110, "integration/dataracebench/DRB110-ordered-orig-no.ll")
+    ->Unit(benchmark::kMillisecond);
+
+// Larger programs, where solving dominates
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, SpecEquake, "unit/PointerAnalysis/spec-equake.ll")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, SpecGap, "unit/PointerAnalysis/spec-gap.ll")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, SpecParser, "unit/PointerAnalysis/spec-parser.ll")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PartialUpdateSolver, SpecVortex, "unit/PointerAnalysis/spec-vortex.ll")
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
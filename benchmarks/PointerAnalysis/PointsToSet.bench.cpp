@@ -0,0 +1,188 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+#include <llvm/ADT/SparseBitVector.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Corpus.h"
+#include "PointerAnalysis/Context/NoCtx.h"
+#include "PointerAnalysis/Models/LanguageModel/DefaultLangModel/DefaultLangModel.h"
+#include "PointerAnalysis/Models/MemoryModel/FieldSensitive/FSMemModel.h"
+#include "PointerAnalysis/Solver/PartialUpdateSolver.h"
+#include "PointerAnalysis/Solver/PointsTo/AdaptivePointsToSet.h"
+#include "PreProcessing/Passes/CanonicalizeGEPPass.h"
+#include "PreProcessing/Passes/InsertGlobalCtorCallPass.h"
+#include "PreProcessing/Passes/LoweringMemCpyPass.h"
+#include "PreProcessing/Passes/RemoveExceptionHandlerPass.h"
+
+namespace {
+
+// The pointer analysis the unit tests run, it only needs the generic preprocessing passes
+using Solver = pta::PartialUpdateSolver<pta::DefaultLangModel<pta::NoCtx, pta::FSMemModel<pta::NoCtx>>>;
+
+// The non-empty points-to sets computed for a real program, in both representations
+struct PtsCorpus {
+  std::vector<llvm::SparseBitVector<>> sparse;
+  std::vector<pta::AdaptivePointsToSet> adaptive;
+};
+
+const PtsCorpus &loadCorpus(const std::string &file) {
+  static std::map<std::string, PtsCorpus> corpora;
+  auto it = corpora.find(file);
+  if (it != corpora.end()) return it->second;
+
+  auto &corpus = corpora[file];
+  llvm::LLVMContext context;
+  auto module = bench::loadModule(file, context);
+  if (!module) return corpus;
+  llvm::legacy::PassManager passes;
+  passes.add(new LegacyCanonicalizeGEPPass());
+  passes.add(new LoweringMemCpyLegacyPass());
+  passes.add(new RemoveExceptionHandlerLegacyPass());
+  passes.add(new InsertGlobalCtorCallPass());
+  passes.run(*module);
+
+  Solver pta;
+  pta.analyze(module.get(), "main");
+  auto const scope = pta.bind();
+  for (pta::NodeID id = 0; id < pta.getConsGraph()->getNodeNum(); id++) {
+    const auto &pts = pta::PTSTrait<pta::BitVectorPTS>::getPointsTo(id);
+    if (pts.empty()) continue;
+    corpus.sparse.push_back(pts);
+    pta::AdaptivePointsToSet adaptive;
+    for (auto elem : pts) {
+      adaptive.set(elem);
+    }
+    corpus.adaptive.push_back(std::move(adaptive));
+  }
+  return corpus;
+}
+
+// Apply op to every pair of neighbouring sets, as the solver mostly combines sets of related nodes
+template <typename Set, typename Op>
+void runOnPairs(benchmark::State &state, const std::vector<Set> &sets, Op op) {
+  if (sets.size() < 2) {
+    state.SkipWithError("no points-to sets to work on");
+    return;
+  }
+  for (auto _ : state) {
+    for (size_t i = 1; i < sets.size(); i++) {
+      op(sets[i - 1], sets[i]);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (sets.size() - 1)));
+}
+
+template <typename Set>
+const std::vector<Set> &getSets(const PtsCorpus &corpus) {
+  if constexpr (std::is_same_v<Set, pta::AdaptivePointsToSet>) {
+    return corpus.adaptive;
+  } else {
+    return corpus.sparse;
+  }
+}
+
+template <typename Set>
+void BM_PtsUnion(benchmark::State &state, const char *file) {
+  runOnPairs(state, getSets<Set>(loadCorpus(file)), [](const Set &lhs, const Set &rhs) {
+    Set result = lhs;
+    benchmark::DoNotOptimize(result |= rhs);
+  });
+}
+
+template <typename Set>
+void BM_PtsIntersects(benchmark::State &state, const char *file) {
+  runOnPairs(state, getSets<Set>(loadCorpus(file)),
+             [](const Set &lhs, const Set &rhs) { benchmark::DoNotOptimize(lhs.intersects(rhs)); });
+}
+
+template <typename Set>
+void BM_PtsContains(benchmark::State &state, const char *file) {
+  runOnPairs(state, getSets<Set>(loadCorpus(file)),
+             [](const Set &lhs, const Set &rhs) { benchmark::DoNotOptimize(lhs.contains(rhs)); });
+}
+
+template <typename Set>
+void BM_PtsIterate(benchmark::State &state, const char *file) {
+  runOnPairs(state, getSets<Set>(loadCorpus(file)), [](const Set & /* lhs */, const Set &rhs) {
+    for (auto elem : rhs) {
+      benchmark::DoNotOptimize(elem);
+    }
+  });
+}
+
+// Sets of numElements random draws from twice as many elements, dense enough for the word kernels to matter
+template <typename Set>
+std::vector<Set> makeDenseSets(size_t numElements) {
+  std::vector<Set> sets(64);
+  std::mt19937 random(42);
+  std::uniform_int_distribution<pta::NodeID> element(0, 2 * numElements - 1);
+  for (auto &set : sets) {
+    for (size_t i = 0; i < numElements; i++) {
+      set.set(element(random));
+    }
+  }
+  return sets;
+}
+
+template <typename Set>
+void BM_PtsDenseUnion(benchmark::State &state) {
+  runOnPairs(state, makeDenseSets<Set>(state.range(0)), [](const Set &lhs, const Set &rhs) {
+    Set result = lhs;
+    benchmark::DoNotOptimize(result |= rhs);
+  });
+}
+
+template <typename Set>
+void BM_PtsDenseContains(benchmark::State &state) {
+  runOnPairs(state, makeDenseSets<Set>(state.range(0)),
+             [](const Set &lhs, const Set &rhs) { benchmark::DoNotOptimize(lhs.contains(rhs)); });
+}
+
+constexpr const char *GAP = "unit/PointerAnalysis/spec-gap.ll";
+constexpr const char *MESA = "unit/PointerAnalysis/spec-mesa.ll";
+constexpr const char *PARSER = "unit/PointerAnalysis/spec-parser.ll";
+constexpr const char *VORTEX = "unit/PointerAnalysis/spec-vortex.ll";
+
+// benchmark names are built from the function name, so give every instantiation its own name
+#define PTS_BENCHMARKS(BM)                                       \
+  const auto BM##_SparseBitVector = BM<llvm::SparseBitVector<>>; \
+  const auto BM##_Adaptive = BM<pta::AdaptivePointsToSet>;       \
+  BENCHMARK_CAPTURE(BM##_SparseBitVector, gap, GAP);             \
+  BENCHMARK_CAPTURE(BM##_Adaptive, gap, GAP);                    \
+  BENCHMARK_CAPTURE(BM##_SparseBitVector, mesa, MESA);           \
+  BENCHMARK_CAPTURE(BM##_Adaptive, mesa, MESA);                  \
+  BENCHMARK_CAPTURE(BM##_SparseBitVector, parser, PARSER);       \
+  BENCHMARK_CAPTURE(BM##_Adaptive, parser, PARSER);              \
+  BENCHMARK_CAPTURE(BM##_SparseBitVector, vortex, VORTEX);       \
+  BENCHMARK_CAPTURE(BM##_Adaptive, vortex, VORTEX);
+
+PTS_BENCHMARKS(BM_PtsUnion)
+PTS_BENCHMARKS(BM_PtsIntersects)
+PTS_BENCHMARKS(BM_PtsContains)
+PTS_BENCHMARKS(BM_PtsIterate)
+
+#define DENSE_PTS_BENCHMARKS(BM)                                                    \
+  BENCHMARK_TEMPLATE(BM, llvm::SparseBitVector<>)->Arg(64)->Arg(4096);             \
+  BENCHMARK_TEMPLATE(BM, pta::AdaptivePointsToSet)->Arg(64)->Arg(4096);
+
+DENSE_PTS_BENCHMARKS(BM_PtsDenseUnion)
+DENSE_PTS_BENCHMARKS(BM_PtsDenseContains)
+
+}  // namespace
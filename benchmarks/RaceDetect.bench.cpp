@@ -0,0 +1,73 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include "Corpus.h"
+#include "RaceDetect.h"
+
+namespace {
+
+// End to end race detection under one context policy, parsing excluded.
+// maxRSS is the peak of the whole benchmark process, run one policy per process
+// (--benchmark_filter=/none$ etc.) to compare the memory of the policies
+void BM_DetectRaces(benchmark::State &state, const char *file, pta::ContextPolicy policy) {
+  size_t races = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    llvm::LLVMContext context;
+    auto module = bench::loadModule(file, context);
+    if (!module) {
+      state.SkipWithError("could not parse IR file");
+      break;
+    }
+    state.ResumeTiming();
+
+    auto report = race::detectRaces(module.get(), race::DetectRaceConfig{
+                                                      .printTrace = false,
+                                                      .doCoverage = false,
+                                                      .context = policy,
+                                                  });
+    races = report.size();
+  }
+
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  state.counters["races"] = races;
+  state.counters["maxRSS_MB"] = usage.ru_maxrss / 1024.0;
+}
+
+// origin3 is the default policy
+#define DETECT_RACES_BENCHMARKS(NAME, FILE)                                                                      \
+  BENCHMARK_CAPTURE(BM_DetectRaces, NAME/none, FILE, pta::ContextPolicy::Insensitive)                        \
+      ->Unit(benchmark::kMillisecond);                                                                          \
+  BENCHMARK_CAPTURE(BM_DetectRaces, NAME/origin1, FILE, pta::ContextPolicy::Origin1)                         \
+      ->Unit(benchmark::kMillisecond);                                                                          \
+  BENCHMARK_CAPTURE(BM_DetectRaces, NAME/origin3, FILE, pta::ContextPolicy::Origin3)                         \
+      ->Unit(benchmark::kMillisecond);                                                                          \
+  BENCHMARK_CAPTURE(BM_DetectRaces, NAME/callsite1, FILE, pta::ContextPolicy::CallSite1)                     \
+      ->Unit(benchmark::kMillisecond);
+
+DETECT_RACES_BENCHMARKS(DRB001, "integration/dataracebench/DRB001-antidep1-orig-yes.ll")
+DETECT_RACES_BENCHMARKS(DRB005, "integration/dataracebench/DRB005-indirectaccess1-orig-yes.ll")
+DETECT_RACES_BENCHMARKS(DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+DETECT_RACES_BENCHMARKS(DRB110, "integration/dataracebench/DRB110-ordered-orig-no.ll")
+DETECT_RACES_BENCHMARKS(DRB169, "integration/dataracebench/DRB169-missingsyncwrite-orig-yes.ll")
+DETECT_RACES_BENCHMARKS(OmpLockSetUnset, "integration/openmp/lock-set-unset-yes.ll")
+DETECT_RACES_BENCHMARKS(OmpReduction, "integration/openmp/reduction-yes.ll")
+DETECT_RACES_BENCHMARKS(OmpLastprivate, "integration/openmp/lastprivate-yes.ll")
+DETECT_RACES_BENCHMARKS(OmpThreadNumInterproc, "integration/openmp/get-thread-num-interproc-yes.ll")
+DETECT_RACES_BENCHMARKS(OmpSectionsInterproc, "integration/openmp/sections-interproc-no-deep.ll")
+DETECT_RACES_BENCHMARKS(PthreadAccount, "integration/pthreadrace/pthread-account-no.ll")
+DETECT_RACES_BENCHMARKS(PthreadVector, "integration/pthreadrace/pthread-vector-yes.ll")
+
+}  // namespace
@@ -0,0 +1,75 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <benchmark/benchmark.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "Corpus.h"
+#include "Reporter/Reporter.h"
+
+namespace {
+
+// Every pair the race checker checks is collected, as if none of them were filtered out
+race::Reporter collectAll(const std::vector<bench::RacePair> &pairs) {
+  race::Reporter reporter;
+  for (auto const &[write, other] : pairs) {
+    reporter.collect(write, other);
+  }
+  return reporter;
+}
+
+// Turning collected race pairs into a report: one race per pair of instructions, their source locations and sorting.
+// Call stacks and source lines are only computed when the report is printed, see BM_PrintReport
+void BM_GetReport(benchmark::State &state, const char *file) {
+  auto const trace = bench::getTraceOrSkip(state, file);
+  if (!trace) return;
+  auto const pairs = bench::getCheckedPairs(*trace);
+  auto const reporter = collectAll(pairs);
+
+  size_t races = 0;
+  for (auto _ : state) {
+    auto report = reporter.getReport();
+    races = report.size();
+  }
+  state.counters["pairs"] = pairs.size();
+  state.counters["races"] = races;
+}
+
+// Printing a report built once: source lines, IR and the call stacks of both accesses of every race.
+// Source files are read once per process, so after the first iteration this measures the cached lines
+void BM_PrintReport(benchmark::State &state, const char *file) {
+  auto const trace = bench::getTraceOrSkip(state, file);
+  if (!trace) return;
+  auto const report = collectAll(bench::getCheckedPairs(*trace)).getReport();
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    std::string output;
+    llvm::raw_string_ostream os(output);
+    for (auto const &race : report.races) {
+      os << race << "\n";
+    }
+    bytes = os.str().size();
+  }
+  state.counters["races"] = report.races.size();
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+#define REPORT_BENCHMARK(NAME, FILE)                                                                            \
+  BENCHMARK_CAPTURE(BM_GetReport, NAME, FILE)->Unit(benchmark::kMicrosecond);                                   \
+  BENCHMARK_CAPTURE(BM_PrintReport, NAME, FILE)->Unit(benchmark::kMicrosecond);
+
+REPORT_BENCHMARK(DRB001, "integration/dataracebench/DRB001-antidep1-orig-yes.ll")
+REPORT_BENCHMARK(DRB005, "integration/dataracebench/DRB005-indirectaccess1-orig-yes.ll")
+REPORT_BENCHMARK(DRB062, "integration/dataracebench/DRB062-matrixvector2-orig-no.ll")
+REPORT_BENCHMARK(PthreadVector, "integration/pthreadrace/pthread-vector-yes.ll")
+
+}  // namespace
@@ -9,12 +9,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include "PointerAnalysis/Solver/PointsTo/BitVectorPTS.h"
-#include "PointerAnalysis/Solver/PointsTo/PointedByPts.h"
+#include <benchmark/benchmark.h>
 
-namespace pta {
-std::vector<BitVectorPTS::PtsTy> BitVectorPTS::ptsVec;
-
-std::vector<PointedByPts::PtsTy> PointedByPts::pointsTo;
-std::vector<PointedByPts::PtsTy> PointedByPts::pointedBy;
-}  // namespace pta
\ No newline at end of file
+BENCHMARK_MAIN();
@@ -154,7 +154,7 @@ const ThreadTrace *getJoinedThread(const JoinEvent *join, const ProgramTrace &pr
 
 }  // namespace
 
-HappensBeforeGraph::HappensBeforeGraph(const race::ProgramTrace &program) {
+HappensBeforeGraph::HappensBeforeGraph(const race::ProgramTrace &program, Engine engine) : engine(engine) {
   // Barriers are handled by adding two edges between each barrier event
   // e.g.
   //   T1       T2
@@ -229,6 +229,17 @@ HappensBeforeGraph::HappensBeforeGraph(const race::ProgramTrace &program) {
     }
   }
 
+  switch (engine) {
+    case Engine::Reachability:
+      computeSyncReachable();
+      break;
+    case Engine::VectorClock:
+      computeVectorClocks();
+      break;
+  }
+}
+
+void HappensBeforeGraph::computeSyncReachable() {
   // we repeatedly need to check if one node is reachable from another
   // to optimise this, and since the connectivity of this graph is relatively low, we pre-search all reachable sync
   // events from each sync event and keep a cache for later since this graph is (effectively) unmodifiable
@@ -282,6 +293,74 @@ HappensBeforeGraph::HappensBeforeGraph(const race::ProgramTrace &program) {
   }
 }
 
+void HappensBeforeGraph::computeVectorClocks() {
+  // Number every sync event, chain by chain
+  size_t numSyncs = 0;
+  for (auto const &[tid, syncs] : threadSyncs) {
+    chainIndex[tid] = chainStart.size();
+    chainStart.push_back(numSyncs);
+    numSyncs += syncs.size();
+  }
+  auto const numChains = chainStart.size();
+
+  auto const globalIndex = [this](EventPID node) {
+    auto const &syncs = threadSyncs.at(node.tid);
+    auto const pos = std::lower_bound(syncs.begin(), syncs.end(), node) - syncs.begin();
+    return chainStart[chainIndex.at(node.tid)] + pos;
+  };
+
+  // successors of each sync event: the next sync on the same thread, plus its cross-thread sync edges
+  std::vector<std::vector<size_t>> succs(numSyncs);
+  clocks.assign(numSyncs * numChains, -1);
+  for (auto const &[tid, syncs] : threadSyncs) {
+    auto const chain = chainIndex.at(tid);
+    auto const start = chainStart[chain];
+    for (size_t pos = 0; pos < syncs.size(); ++pos) {
+      // every sync event reaches itself
+      clocks[(start + pos) * numChains + chain] = static_cast<int32_t>(pos);
+      if (pos + 1 < syncs.size()) {
+        succs[start + pos].push_back(start + pos + 1);
+      }
+    }
+  }
+  for (auto const &[src, dsts] : syncEdges) {
+    auto const srcIdx = globalIndex(src);
+    for (auto const &dst : dsts) {
+      succs[srcIdx].push_back(globalIndex(dst));
+    }
+  }
+
+  // Push clocks forward along every edge until nothing changes.
+  // Barriers add two-way edges, so the graph may have cycles, but clocks only grow and are bounded so this terminates.
+  std::deque<size_t> worklist;
+  std::vector<bool> inWorklist(numSyncs, true);
+  for (size_t node = 0; node < numSyncs; ++node) {
+    worklist.push_back(node);
+  }
+
+  while (!worklist.empty()) {
+    auto const node = worklist.front();
+    worklist.pop_front();
+    inWorklist[node] = false;
+
+    auto const nodeClock = clocks.begin() + node * numChains;
+    for (auto const next : succs[node]) {
+      auto const nextClock = clocks.begin() + next * numChains;
+      bool changed = false;
+      for (size_t chain = 0; chain < numChains; ++chain) {
+        if (nodeClock[chain] > nextClock[chain]) {
+          nextClock[chain] = nodeClock[chain];
+          changed = true;
+        }
+      }
+      if (changed && !inWorklist[next]) {
+        inWorklist[next] = true;
+        worklist.push_back(next);
+      }
+    }
+  }
+}
+
 void HappensBeforeGraph::addSync(const Event *syncEvent) {
   auto &syncs = threadSyncs[syncEvent->getThread().id];
   EventPID syncPID(syncEvent);
@@ -324,6 +403,18 @@ bool HappensBeforeGraph::canReach(const Event *src, const Event *dst) const {
 }
 
 bool HappensBeforeGraph::isReachable(EventPID src, EventPID dst) const {
+  if (engine == Engine::VectorClock) {
+    // src and dst are sync events, so both are on a chain
+    auto const &srcSyncs = threadSyncs.at(src.tid);
+    auto const srcPos = std::lower_bound(srcSyncs.begin(), srcSyncs.end(), src) - srcSyncs.begin();
+    auto const &dstSyncs = threadSyncs.at(dst.tid);
+    auto const dstPos = std::lower_bound(dstSyncs.begin(), dstSyncs.end(), dst) - dstSyncs.begin();
+
+    auto const numChains = chainStart.size();
+    auto const dstIdx = chainStart[chainIndex.at(dst.tid)] + dstPos;
+    return srcPos <= clocks[dstIdx * numChains + chainIndex.at(src.tid)];
+  }
+
   // cppcheck-suppress stlIfFind
   if (auto const reachable = syncReachable.find(src); reachable != syncReachable.end()) {
     return reachable->second.find(dst) != reachable->second.end();
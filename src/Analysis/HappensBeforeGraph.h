@@ -17,8 +17,18 @@ namespace race {
 
 class HappensBeforeGraph {
  public:
+  // How reachability between sync events is answered
+  enum class Engine {
+    // precompute the set of sync events reachable from every sync event
+    // memory is quadratic in the number of sync events
+    Reachability,
+    // give every sync event a vector clock over the per-thread chains of sync events
+    // memory is (number of sync events) x (number of threads with sync events)
+    VectorClock
+  };
+
   // constructs an graph from the events currently stored in program
-  explicit HappensBeforeGraph(const ProgramTrace &program);
+  explicit HappensBeforeGraph(const ProgramTrace &program, Engine engine = Engine::VectorClock);
 
   // return true if there is a happens before edge from src to dst
   [[nodiscard]] bool canReach(const Event *src, const Event *dst) const;
@@ -49,9 +59,25 @@ class HappensBeforeGraph {
     bool operator<=(const EventPID &other) const { return *this < other || *this == other; }
   };
 
+  Engine engine;
+
   std::map<EventPID, std::set<EventPID>> syncEdges;
+
+  // Reachability engine: every sync event reachable from each sync event
   std::map<EventPID, std::set<EventPID>> syncReachable;
-  // DFS on syncEdges to see if src can reach dst
+  void computeSyncReachable();
+
+  // VectorClock engine
+  // Each thread's sorted list of sync events is a chain, and the sync events of chain c are numbered
+  // chainStart[c], chainStart[c] + 1, ... in program order. Row n of clocks is the vector clock of sync event n:
+  // clocks[n][c] is the position on chain c of the last sync event on c that can reach n, or -1 if there is none.
+  // Because each chain is ordered by program order, src can reach dst iff pos(src) <= clocks[dst][chain(src)].
+  std::map<ThreadID, size_t> chainIndex;
+  std::vector<size_t> chainStart;
+  std::vector<int32_t> clocks;
+  void computeVectorClocks();
+
+  // Return true if sync event src can reach sync event dst
   [[nodiscard]] bool isReachable(EventPID src, EventPID dst) const;
   [[nodiscard]] bool hasEdge(EventPID src, EventPID dst) const;
 
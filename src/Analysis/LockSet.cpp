@@ -11,80 +11,120 @@ limitations under the License.
 
 #include "LockSet.h"
 
-#include <set>
+#include <algorithm>
+#include <map>
 
 using namespace race;
 
-std::multiset<const llvm::Value *> LockSet::heldLocks(const Event *targetEvent) {
-  // check if we have it cached
-  // cppcheck-suppress stlIfFind
-  if (auto it = cache.find(targetEvent); it != cache.end()) {
-    return it->second;
-  }
-  std::multiset<const llvm::Value *> locks;
-  if (DEBUG_PTA) {
-    llvm::outs() << "--------------------------\n";
-  }
-  auto const &thread = targetEvent->getThread();
-  for (auto const &event : thread.getEvents()) {
-    if (event->getID() == targetEvent->getID()) {
-      break;
+LockSet::LockSet(const ProgramTrace &program) {
+  auto built = std::make_shared<Index>();
+  auto &threadIntervals = built->threadIntervals;
+  auto &locksets = built->locksets;
+
+  llvm::DenseMap<const llvm::Value *, uint32_t> lockIDs;
+  std::map<std::vector<uint32_t>, LockSetID> locksetIDs;
+  // the empty lockset is always id 0
+  locksetIDs[{}] = 0;
+  locksets.emplace_back();
+
+  auto const getLockID = [&lockIDs](const llvm::Value *lock) {
+    return lockIDs.try_emplace(lock, lockIDs.size()).first->second;
+  };
+
+  // held is a multiset: a lock acquired twice must be released twice
+  auto const intern = [&](const std::map<uint32_t, size_t> &held) {
+    std::vector<uint32_t> key;
+    key.reserve(held.size());
+    for (auto const &[lock, count] : held) {
+      key.push_back(lock);
     }
-    switch (event->type) {
-      case Event::Type::Lock: {
-        auto lockEvent = llvm::cast<LockEvent>(event.get());
-        locks.insert(lockEvent->getIRInst()->getLockValue());
-        if (DEBUG_PTA) {
-          llvm::outs() << "After lock: {";
-          auto it = locks.begin();
-          for (; it != locks.end(); it++) llvm::outs() << *it << " ";
-          llvm::outs() << "}\n";
-        }
-        break;
+
+    auto [it, inserted] = locksetIDs.try_emplace(std::move(key), locksets.size());
+    if (inserted) {
+      llvm::BitVector bits;
+      for (auto const lock : it->first) {
+        if (bits.size() <= lock) bits.resize(lock + 1);
+        bits.set(lock);
       }
-      case Event::Type::Unlock: {
-        auto unlockEvent = llvm::cast<UnlockEvent>(event.get());
-        const llvm::Value *ele = unlockEvent->getIRInst()->getLockValue();
-        const auto &first = locks.find(ele);
-        if (first != locks.end()) {  // only remove the first element
-          locks.erase(first);
+      locksets.push_back(std::move(bits));
+    }
+    return it->second;
+  };
+
+  // One linear pass over every thread, recording where its held lockset changes
+  for (auto const &thread : program.getThreads()) {
+    if (threadIntervals.size() <= thread->id) threadIntervals.resize(thread->id + 1);
+    auto &intervals = threadIntervals[thread->id];
+    intervals.push_back({0, 0});
+
+    if (DEBUG_PTA) {
+      llvm::outs() << "--------------------------\n";
+    }
+
+    std::map<uint32_t, size_t> held;
+    for (auto const &event : thread->getEvents()) {
+      switch (event->type) {
+        case Event::Type::Lock: {
+          auto lockEvent = llvm::cast<LockEvent>(event.get());
+          ++held[getLockID(lockEvent->getIRInst()->getLockValue())];
+          break;
         }
-        if (DEBUG_PTA) {
-          llvm::outs() << "After unlock: {";
-          auto it = locks.begin();
-          for (; it != locks.end(); it++) llvm::outs() << *it << " ";
-          llvm::outs() << "}\n";
+        case Event::Type::Unlock: {
+          auto unlockEvent = llvm::cast<UnlockEvent>(event.get());
+          auto it = held.find(getLockID(unlockEvent->getIRInst()->getLockValue()));
+          if (it == held.end()) {
+            // unlocking a lock that is not held has no effect
+            continue;
+          }
+          // only remove one acquisition
+          if (--it->second == 0) {
+            held.erase(it);
+          }
+          break;
         }
-        break;
+        default:
+          // Do Nothing
+          continue;
+      }
+
+      // The new lockset applies starting from the event after the lock/unlock
+      auto const lockset = intern(held);
+      if (DEBUG_PTA) {
+        llvm::outs() << "After " << event->type << ": lockset " << lockset << " {";
+        for (auto const &[lock, count] : held) llvm::outs() << lock << "x" << count << " ";
+        llvm::outs() << "}\n";
+      }
+      if (intervals.back().lockset != lockset) {
+        intervals.push_back({event->getID() + 1, lockset});
       }
-      default:
-        // Do Nothing
-        break;
     }
   }
 
-  cache.emplace(targetEvent, locks);
-  return locks;
+  index = std::move(built);
 }
 
-LockSet::LockSet(const ProgramTrace & /* program */) : cache({}) {}
+LockSet::LockSetID LockSet::heldLocks(const Event *event) const {
+  auto const tid = event->getThread().id;
+  auto const &threadIntervals = index->threadIntervals;
+  if (tid >= threadIntervals.size() || threadIntervals[tid].empty()) return 0;
+
+  // last interval starting at or before event
+  auto const &intervals = threadIntervals[tid];
+  auto it = std::upper_bound(intervals.begin(), intervals.end(), event->getID(),
+                             [](EventID id, const Interval &interval) { return id < interval.start; });
+  return std::prev(it)->lockset;
+}
 
 bool LockSet::sharesLock(const MemAccessEvent *lhs, const MemAccessEvent *rhs) {
-  auto const lhsLocks = heldLocks(lhs);
-  auto const rhsLocks = heldLocks(rhs);
-
-  auto lhsIter = lhsLocks.begin();
-  auto rhsIter = rhsLocks.begin();
-
-  while (lhsIter != lhsLocks.end() && rhsIter != rhsLocks.end()) {
-    if (rhsIter == rhsLocks.end() || *lhsIter < *rhsIter) {
-      lhsIter++;
-    } else if (lhsIter == lhsLocks.end() || *lhsIter > *rhsIter) {
-      rhsIter++;
-    } else {
-      return true;
-    }
-  }
+  auto lhsLocks = heldLocks(lhs);
+  auto rhsLocks = heldLocks(rhs);
+  if (lhsLocks == 0 || rhsLocks == 0) return false;
+  if (lhsLocks == rhsLocks) return true;
 
-  return false;
+  if (rhsLocks < lhsLocks) std::swap(lhsLocks, rhsLocks);
+  auto [it, inserted] = sharedCache.try_emplace({lhsLocks, rhsLocks}, false);
+  if (inserted) {
+    it->second = index->locksets[lhsLocks].anyCommon(index->locksets[rhsLocks]);
+  }
+  return it->second;
 }
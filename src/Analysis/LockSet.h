@@ -11,19 +11,53 @@ limitations under the License.
 
 #pragma once
 
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include <memory>
+
 #include "LanguageModel/RaceModel.h"
 #include "Trace/ProgramTrace.h"
 
 namespace race {
 
 class LockSet {
+ public:
+  // Dense id of a distinct set of held locks. 0 is the empty lockset
+  using LockSetID = uint32_t;
+
  private:
-  std::map<const Event *, std::multiset<const llvm::Value *>> cache;
-  std::multiset<const llvm::Value *> heldLocks(const Event *targetEvent);
+  // The lockset held by a thread from event start until the start of the next interval
+  struct Interval {
+    EventID start;
+    LockSetID lockset;
+  };
+
+  // Built once from the trace and immutable afterwards, shared by every LockSet made with share()
+  struct Index {
+    // Indexed by ThreadID. Intervals are sorted by start, and the first always starts at event 0
+    std::vector<std::vector<Interval>> threadIntervals;
+
+    // Interned locksets, as bitsets over dense lock ids
+    std::vector<llvm::BitVector> locksets;
+  };
+  std::shared_ptr<const Index> index;
+
+  // Memoized sharesLock results, keyed on the pair of lockset ids ordered so (a,b) and (b,a) share an entry
+  llvm::DenseMap<std::pair<LockSetID, LockSetID>, bool> sharedCache;
+
+  explicit LockSet(std::shared_ptr<const Index> index) : index(std::move(index)) {}
+
+  // Lockset held when event is reached (not including the effect of event itself)
+  [[nodiscard]] LockSetID heldLocks(const Event *event) const;
 
  public:
   explicit LockSet(const ProgramTrace &program);
 
+  // A LockSet over the same trace that shares the index of this one but has its own memoized results,
+  // so each of them can be queried by a different thread
+  [[nodiscard]] LockSet share() const { return LockSet(index); }
+
   [[nodiscard]] bool sharesLock(const MemAccessEvent *lhs, const MemAccessEvent *rhs);
 };
 }  // namespace race
@@ -20,17 +20,11 @@ limitations under the License.
 using namespace race;
 using namespace llvm;
 
-OpenMPAnalysis::OpenMPAnalysis(const ProgramTrace &program) : lastprivate(program.getModule()), arrayAnalysis() {
-  PB.registerFunctionAnalyses(FAM);
-}
-
 namespace {
 
-bool regionEndLessThan(const race::Region &region1, const race::Region &region2) { return region1.end < region2.end; }
-
-// recursively find the spawn site of the closest/innermost OpenMPFork for this event
-std::optional<const ForkEvent *> getRootSpawnSite(const Event *event) {
-  auto eSpawn = event->getThread().spawnSite;
+// recursively find the spawn site of the closest/innermost OpenMPFork for this thread
+std::optional<const ForkEvent *> getRootSpawnSite(const ThreadTrace &thread) {
+  auto eSpawn = thread.spawnSite;
   if (!eSpawn) return std::nullopt;
   if (eSpawn.value()->getIRInst()->type == IR::Type::OpenMPTaskFork) {
     // this works when the event is from omp task fork: we need the parent spawn site here,
@@ -44,109 +38,136 @@ std::optional<const ForkEvent *> getRootSpawnSite(const Event *event) {
   return eSpawn;
 }
 
-// return true if both events belong to the same OpenMP team (e.g., under the same #pragma omp parallel)
-// This function is split out so that it can be called from the template functions below (in, inSame, etc)
-bool _fromSameParallelRegion(const Event *event1, const Event *event2) {
-  // Check both spawn events are OpenMP forks
-  auto e1Spawn = getRootSpawnSite(event1);
-  if (!e1Spawn || !e1Spawn.value()) return false;
-
-  auto e2Spawn = getRootSpawnSite(event2);
-  if (!e2Spawn || !e2Spawn.value()) return false;
-
-  // Check they are spawned from same thread
-  if (e1Spawn.value()->getThread().id != e2Spawn.value()->getThread().id) return false;
-
-  // Check that they are adjacent. Only matching omp forks can be adjacent, because they are always followed by joins
-  auto const eid1 = e1Spawn.value()->getID();
-  auto const eid2 = e2Spawn.value()->getID();
-  auto const diff = (eid1 > eid2) ? (eid1 - eid2) : (eid2 - eid1);
-  return diff == 1;
-}
-
-// Get list of (non-nested) event regions
-// template definition can be in cpp as long as we dont expose the template outside of this file
+// Tracks one kind of (non-nested) region while walking over a thread's events
 template <IR::Type Start, IR::Type End>
-std::vector<Region> getRegions(const ThreadTrace &thread) {
-  std::vector<Region> regions;
-
+class RegionCollector {
   std::optional<EventID> start;
-  for (auto const &event : thread.getEvents()) {
+
+ public:
+  // Returns true if event closed a region, which is then the last element of regions
+  bool visit(const Event *event, std::vector<Region> &regions) {
     switch (event->getIRType()) {
       case Start: {
         assert(!start.has_value() && "encountered two start types in a row");
         start = event->getID();
-        break;
+        return false;
       }
       case End: {
         assert(start.has_value() && "encountered end type without a matching start type");
-        regions.emplace_back(start.value(), event->getID(), thread);
+        regions.emplace_back(start.value(), event->getID(), event->getThread());
         start.reset();
-        break;
+        return true;
       }
       default:
         // Nothing
-        break;
+        return false;
     }
   }
+};
 
-  return regions;
+uint64_t getGuardedTID(const Event *guardEvent) {
+  auto guardCall = llvm::cast<llvm::CallInst>(guardEvent->getInst());
+  auto guardedTID = llvm::cast<llvm::ConstantInt>(guardCall->getArgOperand(0));
+  return guardedTID->getZExtValue();
 }
 
-auto constexpr _getLoopRegions = getRegions<IR::Type::OpenMPForInit, IR::Type::OpenMPForFini>;
+}  // namespace
 
-// Get the innermost region that contains event
-template <IR::Type Start, IR::Type End>
-std::optional<Region> getContainingRegion(const Event *event) {
-  if (!event) return std::nullopt;
+OpenMPRegionIndex::OpenMPRegionIndex(const ProgramTrace &program) {
+  for (auto const &thread : program.getThreads()) {
+    if (threads.size() <= thread->id) threads.resize(thread->id + 1);
+    auto &regions = threads[thread->id];
+    regions.rootSpawn = getRootSpawnSite(*thread);
+
+    RegionCollector<IR::Type::OpenMPSingleStart, IR::Type::OpenMPSingleEnd> singles;
+    RegionCollector<IR::Type::OpenMPForInit, IR::Type::OpenMPForFini> loops;
+    RegionCollector<IR::Type::OpenMPGetThreadNumGuardStart, IR::Type::OpenMPGetThreadNumGuardEnd> guarded;
+
+    const llvm::BasicBlock *lastSection = nullptr;
+    for (auto const &event : thread->getEvents()) {
+      singles.visit(event.get(), regions.singles);
+      loops.visit(event.get(), regions.loops);
+      if (guarded.visit(event.get(), regions.guarded)) {
+        auto const &region = regions.guarded.back();
+        auto const tid = getGuardedTID(thread->getEvent(region.start));
+        assert(tid == getGuardedTID(thread->getEvent(region.end)) &&
+               "the region guarded by omp_get_thread_num should have the same TID");
+        regions.guardedTIDs.push_back(tid);
+      }
 
-  auto const &thread = event->getThread();
-  auto const regions = getRegions<Start, End>(thread);
+      if (event->getIRType() == IR::Type::OpenMPReduce) {
+        regions.reduces.push_back(event->getID());
+      }
 
-  // If we are on thread spawned within parallel region,
-  // we can also check to see if this thread was spawned within a region on the parent thread:
-  // This ONLY valid when the event is from threads spawned by OpenMPTask (or maybe also OpenMPForkTeams later if we
-  // also need such checks). For other cases (e.g., events from threads spawned by OpenMPFork), if there exists such a
-  // region, the region must be in the same thread, not parent thread. If we remove the check, we will get wrong/null
-  // regions for the other cases.
-  if (regions.empty()) {
-    auto parent = thread.spawnSite.value();
-    if (parent->getIRInst()->type == IR::Type::OpenMPTaskFork) {
-      return getContainingRegion<Start, End>(parent);
+      // a new section starts at the first event in each omp sections case block
+      auto const inst = event->getInst();
+      if (!inst) continue;
+      auto const block = inst->getParent();
+      if (block && block != lastSection && block->hasName() && block->getName().startswith(".omp.sections.case")) {
+        regions.sections.push_back(event->getID());
+        lastSection = block;
+      }
     }
-    return std::nullopt;
   }
+}
 
-  for (auto const &region : regions) {
-    if (region.contains(event->getID())) {
-      return region;
-    }
-  }
+std::optional<size_t> OpenMPRegionIndex::find(const std::vector<Region> &regions, EventID eid) {
+  // last region starting at or before eid
+  auto it = std::upper_bound(regions.begin(), regions.end(), eid,
+                             [](EventID id, const Region &region) { return id < region.start; });
+  if (it == regions.begin()) return std::nullopt;
+  --it;
+  if (!it->contains(eid)) return std::nullopt;
+  return std::distance(regions.begin(), it);
+}
 
-  return std::nullopt;
+OpenMPAnalysis::Shared::Shared(const ProgramTrace &program) : lastprivate(program.getModule()), regions(program) {}
+
+OpenMPAnalysis::OpenMPAnalysis(const ProgramTrace &program) : OpenMPAnalysis(std::make_shared<Shared>(program)) {}
+
+OpenMPAnalysis::OpenMPAnalysis(std::shared_ptr<const Shared> shared)
+    : shared(std::move(shared)), lastprivate(this->shared->lastprivate), regions(this->shared->regions), arrayAnalysis() {
+  PB.registerFunctionAnalyses(FAM);
 }
 
+namespace {
+
+// return true if both events belong to the same OpenMP team (e.g., under the same #pragma omp parallel)
+// This function is split out so that it can be called from the helpers below (inSame, etc)
+bool _fromSameParallelRegion(const OpenMPRegionIndex &index, const Event *event1, const Event *event2) {
+  // Check both spawn events are OpenMP forks
+  auto e1Spawn = index.get(event1->getThread()).rootSpawn;
+  if (!e1Spawn || !e1Spawn.value()) return false;
+
+  auto e2Spawn = index.get(event2->getThread()).rootSpawn;
+  if (!e2Spawn || !e2Spawn.value()) return false;
+
+  // Check they are spawned from same thread
+  if (e1Spawn.value()->getThread().id != e2Spawn.value()->getThread().id) return false;
+
+  // Check that they are adjacent. Only matching omp forks can be adjacent, because they are always followed by joins
+  auto const eid1 = e1Spawn.value()->getID();
+  auto const eid2 = e2Spawn.value()->getID();
+  auto const diff = (eid1 > eid2) ? (eid1 - eid2) : (eid2 - eid1);
+  return diff == 1;
+}
+
+using RegionTable = std::vector<Region> OpenMPRegionIndex::ThreadRegions::*;
+
 // Count the number of regions and return the index of the region containing the event
 //
 // This assumes that because each thread is executing the same parallel region
 // the number and ordering of regions should be the same on each thread.
-template <IR::Type Start, IR::Type End>
-std::optional<size_t> getRegionID(const Event *event) {
-  auto const regions = getRegions<Start, End>(event->getThread());
-  auto region = std::find_if(regions.begin(), regions.end(),
-                             [&event](auto const &region) { return region.contains(event->getID()); });
-  if (region == regions.end()) return std::nullopt;
-  return std::distance(regions.begin(), region);
+std::optional<size_t> getRegionID(const OpenMPRegionIndex &index, RegionTable table, const Event *event) {
+  return OpenMPRegionIndex::find(index.get(event->getThread()).*table, event->getID());
 }
 
-// return true if both events are inside of the region marked by Start and End
-// see getRegions for more detail on regions
-template <IR::Type Start, IR::Type End>
-bool inSame(const Event *event1, const Event *event2) {
-  assert(_fromSameParallelRegion(event1, event2) && "events must be from same omp parallel region");
+// return true if both events are inside of the same region from table
+bool inSame(const OpenMPRegionIndex &index, RegionTable table, const Event *event1, const Event *event2) {
+  assert(_fromSameParallelRegion(index, event1, event2) && "events must be from same omp parallel region");
 
-  auto const region1 = getRegionID<Start, End>(event1);
-  auto const region2 = getRegionID<Start, End>(event2);
+  auto const region1 = getRegionID(index, table, event1);
+  auto const region2 = getRegionID(index, table, event2);
 
   if (!region1 || !region2) {
     return false;
@@ -156,73 +177,51 @@ bool inSame(const Event *event1, const Event *event2) {
   return region1.value() == region2.value();
 }
 
-// return true if both events are inside of the region marked by Start and End
-// AND they share the same guarded TID
-template <IR::Type Start, IR::Type End>
-bool haveSameTID(const Event *event1, const Event *event2) {
-  assert(_fromSameParallelRegion(event1, event2) && "events must be from same omp parallel region");
+bool _inSameSingleBlock(const OpenMPRegionIndex &index, const Event *event1, const Event *event2) {
+  return inSame(index, &OpenMPRegionIndex::ThreadRegions::singles, event1, event2);
+}
 
-  // get omp region contains the event
-  auto const region1 = getContainingRegion<Start, End>(event1);
-  auto const region2 = getContainingRegion<Start, End>(event2);
+// Get the TID guarding the innermost guarded region that contains event
+std::optional<uint64_t> getGuardedTID(const OpenMPRegionIndex &index, const Event *event) {
+  auto const &thread = event->getThread();
+  auto const &regions = index.get(thread);
 
-  if (!region1 || !region2) {
-    return false;
+  // If we are on thread spawned within parallel region,
+  // we can also check to see if this thread was spawned within a region on the parent thread:
+  // This ONLY valid when the event is from threads spawned by OpenMPTask (or maybe also OpenMPForkTeams later if we
+  // also need such checks). For other cases (e.g., events from threads spawned by OpenMPFork), if there exists such a
+  // region, the region must be in the same thread, not parent thread. If we remove the check, we will get wrong/null
+  // regions for the other cases.
+  if (regions.guarded.empty()) {
+    auto parent = thread.spawnSite.value();
+    if (parent->getIRInst()->type == IR::Type::OpenMPTaskFork) {
+      return getGuardedTID(index, parent);
+    }
+    return std::nullopt;
   }
 
-  auto const getGuardedTID = [](Region r, EventID id) {
-    auto guardCall = llvm::cast<llvm::CallInst>(r.thread.getEvent(id)->getInst());
-    auto guardedTID = llvm::cast<llvm::ConstantInt>(guardCall->getArgOperand(0));
-    return guardedTID->getZExtValue();
-  };
-
-  auto const sameGuardedTID = [&getGuardedTID](Region r) {
-    return getGuardedTID(r, r.start) == getGuardedTID(r, r.end);
-  };
+  if (auto const region = OpenMPRegionIndex::find(regions.guarded, event->getID())) {
+    return regions.guardedTIDs[region.value()];
+  }
+  return std::nullopt;
+}
 
-  assert(sameGuardedTID(region1.value()) && "the region guarded by omp_get_thread_num should have the same TID");
-  assert(sameGuardedTID(region2.value()) && "the region guarded by omp_get_thread_num should have the same TID");
+// return true if both events are inside of a region guarded by omp_get_thread_num
+// AND they share the same guarded TID
+bool _inSameGuardedTID(const OpenMPRegionIndex &index, const Event *event1, const Event *event2) {
+  assert(_fromSameParallelRegion(index, event1, event2) && "events must be from same omp parallel region");
 
   // regions do not need to be the same (i.e., sameAs), but must have the same guarded TID passed as the only parameter
   // to four call to omp_get_thread_num_guard_start and omp_get_thread_num_guard_end from two regions
-  if (getGuardedTID(region1.value(), region1.value().start) == getGuardedTID(region2.value(), region2.value().start)) {
-    return true;
-  }
-
-  return false;
+  auto const tid1 = getGuardedTID(index, event1);
+  auto const tid2 = getGuardedTID(index, event2);
+  return tid1 && tid2 && tid1.value() == tid2.value();
 }
 
-auto const _inSameSingleBlock = inSame<IR::Type::OpenMPSingleStart, IR::Type::OpenMPSingleEnd>;
-
-auto const _inSameGuardedTID =
-    haveSameTID<IR::Type::OpenMPGetThreadNumGuardStart, IR::Type::OpenMPGetThreadNumGuardEnd>;
-
 }  // namespace
 
-const std::vector<OpenMPAnalysis::LoopRegion> &OpenMPAnalysis::getOmpForLoops(const ThreadTrace &thread) {
-  // Check if result is already computed
-  auto it = ompForLoops.find(thread.id);
-  if (it != ompForLoops.end()) {
-    return it->second;
-  }
-
-  // Else find the loop regions
-  ompForLoops[thread.id] = _getLoopRegions(thread);
-
-  return ompForLoops.at(thread.id);
-}
-
-bool OpenMPAnalysis::inParallelFor(const race::MemAccessEvent *event) {
-  auto loopRegions = getOmpForLoops(event->getThread());
-  auto const eid = event->getID();
-
-  auto it =
-      lower_bound(loopRegions.begin(), loopRegions.end(), Region(eid, eid, event->getThread()), regionEndLessThan);
-  if (it != loopRegions.end()) {
-    if (it->contains(eid)) return true;
-  }
-
-  return false;
+bool OpenMPAnalysis::inParallelFor(const race::MemAccessEvent *event) const {
+  return getRegionID(regions, &OpenMPRegionIndex::ThreadRegions::loops, event).has_value();
 }
 
 bool OpenMPAnalysis::isNonOverlappingLoopAccess(const MemAccessEvent *event1, const MemAccessEvent *event2) {
@@ -230,7 +229,7 @@ bool OpenMPAnalysis::isNonOverlappingLoopAccess(const MemAccessEvent *event1, co
 }
 
 bool OpenMPAnalysis::fromSameParallelRegion(const Event *event1, const Event *event2) const {
-  return _fromSameParallelRegion(event1, event2);
+  return _fromSameParallelRegion(regions, event1, event2);
 }
 
 namespace {
@@ -269,13 +268,13 @@ std::optional<const ForkEvent *> getOuterTaskSpawn(const Event *event) {
 // but the task will only be spawned on the first thread trace.
 // The task code will have a HB relationship with the taskwait on the first threadtrace
 // but will still be allowed torace with the read on the second thread trace.
-bool isTaskSingleEdgeCase(const Event *event1, const Event *event2) {
+bool isTaskSingleEdgeCase(const OpenMPRegionIndex &index, const Event *event1, const Event *event2) {
   if (auto const outerSpawn = getOuterTaskSpawn(event1)) {
-    return _inSameSingleBlock(outerSpawn.value(), event2);
+    return _inSameSingleBlock(index, outerSpawn.value(), event2);
   }
 
   if (auto const outerSpawn = getOuterTaskSpawn(event2)) {
-    return _inSameSingleBlock(outerSpawn.value(), event1);
+    return _inSameSingleBlock(index, outerSpawn.value(), event1);
   }
 
   return false;
@@ -283,15 +282,15 @@ bool isTaskSingleEdgeCase(const Event *event1, const Event *event2) {
 }  // namespace
 
 bool OpenMPAnalysis::inSameSingleBlock(const Event *event1, const Event *event2) const {
-  return _inSameSingleBlock(event1, event2)
+  return _inSameSingleBlock(regions, event1, event2)
          // Or if one event was spawned in a task inside of a single region
          // and the other event is in the same single region.
          // See isTaskSingleEdgeCase definition for detailed comment.
-         || isTaskSingleEdgeCase(event1, event2);
+         || isTaskSingleEdgeCase(regions, event1, event2);
 }
 
 bool OpenMPAnalysis::guardedBySameTID(const Event *event1, const Event *event2) const {
-  return _inSameGuardedTID(event1, event2);
+  return _inSameGuardedTID(regions, event1, event2);
 }
 
 std::vector<const llvm::BasicBlock *> &ReduceAnalysis::computeGuardedBlocks(ReduceInst reduce) const {
@@ -384,26 +383,25 @@ bool ReduceAnalysis::reduceContains(const llvm::Instruction *reduce, const llvm:
 }
 
 bool OpenMPAnalysis::inSameReduce(const Event *event1, const Event *event2) const {
+  auto const &thread = event1->getThread();
   // Find reduce events
-  for (auto const &event : event1->getThread().getEvents()) {
+  for (auto const reduceID : regions.get(thread).reduces) {
     // If an event e is inside of a reduce block it must occur *after* the reduce event
     // so, if either event is encountered before finding a reduce that contains event1
     // we know that they are not in the same reduce block
     // since event2 might in a thread that removes single/master events (since we always traverse
     // them in a small thread ID and here the TID of event1 <= TID of event2), so event2 can
     // have smaller eventID than event1's
-    if (event->getID() == event1->getID()) return false;
+    if (reduceID >= event1->getID()) return false;
 
     // Once a reduce is found, check that it contains both events (true)
     // or that it contains neither event (keep searching)
     // if it contains one but not the other, return false
-    if (event->getIRType() == IR::Type::OpenMPReduce) {
-      auto const reduce = event->getInst();
-      auto const contains1 = reduceAnalysis.reduceContains(reduce, event1->getInst());
-      auto const contains2 = reduceAnalysis.reduceContains(reduce, event2->getInst());
-      if (contains1 && contains2) return true;
-      if (contains1 || contains2) return false;
-    }
+    auto const reduce = thread.getEvent(reduceID)->getInst();
+    auto const contains1 = reduceAnalysis.reduceContains(reduce, event1->getInst());
+    auto const contains2 = reduceAnalysis.reduceContains(reduce, event2->getInst());
+    if (contains1 && contains2) return true;
+    if (contains1 || contains2) return false;
   }
 
   return false;
@@ -457,62 +455,23 @@ LastprivateAnalysis::LastprivateAnalysis(const llvm::Module &module) {
   }
 }
 
-bool OpenMPAnalysis::insideCompatibleSections(const Event *event1, const Event *event2) {
+bool OpenMPAnalysis::insideCompatibleSections(const Event *event1, const Event *event2) const {
   // assertion: threads of the same team are identical
   // assertion: we aren't given events from threads in different parallel sections blocks because those would be
   //            different teams
 
   // observation: we only enter a section if any event in the queue passes through a section case
   // assertion: this vector is distinct but ordered because a given section isn't a descendent of another section
-  std::vector<const Event *> sections;
-  auto lastID = std::max(event1->getID(), event2->getID());
-  for (auto &event : event1->getThread().getEvents()) {
-    auto ir = event->getInst();
-    if (!ir) continue;
-    auto block = ir->getParent();
-    if ((sections.empty() || block != sections.back()->getInst()->getParent()) && block->hasName() &&
-        block->getName().startswith(".omp.sections.case")) {  // add for body check
-      sections.push_back(event.get());
-    }
-    // this is our end event; anything beyond this is not worth capturing
-    if (event->getID() > lastID) {
-      break;
-    }
-  }
-
-  if (sections.empty()) {
-    return false;
-  }
-
-  std::vector<const Event *> events;
-  events.reserve(event1->getThread().getEvents().size());
-  std::transform(event1->getThread().getEvents().begin(), event1->getThread().getEvents().end(),
-                 std::back_inserter(events), [&](const auto &event) { return event.get(); });
+  auto const &sections = regions.get(event1->getThread()).sections;
 
-  const Event *ev1sec = nullptr;
-  const Event *ev2sec = nullptr;
-
-  auto currSecEv = sections.begin();
-  for (auto currEvent = std::find(events.begin(), events.end(), *currSecEv); (*currEvent)->getID() <= lastID;
-       ++currSecEv) {
-    do {
-      if (event1->getID() == (*currEvent)->getID()) {
-        ev1sec = *currSecEv;
-      }
-      if (event2->getID() == (*currEvent)->getID()) {
-        ev2sec = *currSecEv;
-      }
-
-      if (ev1sec != nullptr && ev2sec != nullptr) {
-        if (ev1sec == ev2sec) {
-          return true;
-        } else {
-          return false;
-        }
-      }
-      ++currEvent;
-    } while (std::find(sections.begin(), sections.end(), *currEvent) == sections.end());
-  }
+  // Each event belongs to the last section that starts at or before it
+  auto const getSection = [&sections](EventID eid) -> std::optional<EventID> {
+    auto it = std::upper_bound(sections.begin(), sections.end(), eid);
+    if (it == sections.begin()) return std::nullopt;
+    return *std::prev(it);
+  };
 
-  return false;
+  auto const ev1sec = getSection(event1->getID());
+  auto const ev2sec = getSection(event2->getID());
+  return ev1sec && ev2sec && ev1sec.value() == ev2sec.value();
 }
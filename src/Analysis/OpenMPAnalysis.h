@@ -13,6 +13,8 @@ limitations under the License.
 
 #include <llvm/Passes/PassBuilder.h>
 
+#include <memory>
+
 #include "Analysis/SimpleArrayAnalysis.h"
 #include "Trace/Event.h"
 #include "Trace/ThreadTrace.h"
@@ -37,6 +39,36 @@ struct Region {
   }
 };  // namespace race
 
+// Per-thread tables of the OpenMP regions on every thread, built with one pass over each thread.
+// Regions of one kind never nest, so each table is sorted and can be binary searched.
+class OpenMPRegionIndex {
+ public:
+  struct ThreadRegions {
+    std::vector<Region> singles;
+    std::vector<Region> loops;
+    // regions guarded by omp_get_thread_num, and the TID guarding each one
+    std::vector<Region> guarded;
+    std::vector<uint64_t> guardedTIDs;
+    // reduce call events
+    std::vector<EventID> reduces;
+    // first event of each omp sections case
+    std::vector<EventID> sections;
+    // spawn site of the closest OpenMPFork this thread belongs to (looking through tasks)
+    std::optional<const ForkEvent*> rootSpawn;
+  };
+
+  explicit OpenMPRegionIndex(const ProgramTrace& program);
+
+  [[nodiscard]] const ThreadRegions& get(const ThreadTrace& thread) const { return threads.at(thread.id); }
+
+  // Return the index of the region containing eid
+  [[nodiscard]] static std::optional<size_t> find(const std::vector<Region>& regions, EventID eid);
+
+ private:
+  // indexed by ThreadID
+  std::vector<ThreadRegions> threads;
+};
+
 class ReduceAnalysis {
   using ReduceInst = const llvm::Instruction*;
 
@@ -73,28 +105,35 @@ class LastprivateAnalysis {
 };
 
 class OpenMPAnalysis {
+  // Built once from the trace and immutable afterwards, shared by every OpenMPAnalysis made with share()
+  struct Shared {
+    LastprivateAnalysis lastprivate;
+    OpenMPRegionIndex regions;
+
+    explicit Shared(const ProgramTrace& program);
+  };
+  std::shared_ptr<const Shared> shared;
+  const LastprivateAnalysis& lastprivate;
+  const OpenMPRegionIndex& regions;
+
+  // filled lazily while answering queries, owned by each instance
   llvm::PassBuilder PB;
   llvm::FunctionAnalysisManager FAM;
-
   ReduceAnalysis reduceAnalysis;
-  LastprivateAnalysis lastprivate;
   SimpleArrayAnalysis arrayAnalysis;
 
-  // Start/End of omp loop
-  using LoopRegion = Region;
-
-  // per-thread map of omp for loop regions
-  std::map<ThreadID, std::vector<LoopRegion>> ompForLoops;
-
-  // get cached list of loop regions, else create them
-  const std::vector<LoopRegion>& getOmpForLoops(const ThreadTrace& trace);
+  explicit OpenMPAnalysis(std::shared_ptr<const Shared> shared);
 
   // return true if this event is in a omp for loop
-  bool inParallelFor(const race::MemAccessEvent* event);
+  bool inParallelFor(const race::MemAccessEvent* event) const;
 
  public:
   explicit OpenMPAnalysis(const ProgramTrace& program);
 
+  // An OpenMPAnalysis over the same trace that shares the region index of this one but has its own caches,
+  // so each of them can be queried by a different thread
+  [[nodiscard]] OpenMPAnalysis share() const { return OpenMPAnalysis(shared); }
+
   // return true if both events are part of the same omp team
   bool fromSameParallelRegion(const Event* event1, const Event* event2) const;
 
@@ -111,7 +150,7 @@ class OpenMPAnalysis {
   bool inSameReduce(const Event* event1, const Event* event2) const;
 
   // return true if both events are in compatible sections
-  static bool insideCompatibleSections(const Event* event1, const Event* event2);
+  bool insideCompatibleSections(const Event* event1, const Event* event2) const;
 
   bool isInLastprivate(const Event* event) const { return lastprivate.isGuarded(event->getInst()->getParent()); }
 
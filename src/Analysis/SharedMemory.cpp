@@ -10,19 +10,68 @@ limitations under the License.
 ==============================================================================*/
 
 #include "Analysis/SharedMemory.h"
+
+#include <algorithm>
+
 using namespace race;
 
-SharedMemory::SharedMemory(const ProgramTrace &program) {
-  auto const getObjId = [&](const pta::ObjTy *obj) {
-    // cppcheck-suppress stlIfFind
-    if (auto it = objIDs.find(obj); it != objIDs.end()) {
-      return it->second;
+template <typename EventT>
+SharedMemory::AccessIndex<EventT>::AccessIndex(size_t numObjs, std::vector<Access> accesses) {
+  // Counting sort by object. Accesses keep program order within each object
+  objOffsets.assign(numObjs + 1, 0);
+  for (auto const &access : accesses) {
+    ++objOffsets[access.obj + 1];
+  }
+  for (size_t id = 0; id < numObjs; ++id) {
+    objOffsets[id + 1] += objOffsets[id];
+  }
+
+  std::vector<std::pair<ThreadID, const EventT *>> sorted(accesses.size());
+  {
+    auto next = objOffsets;
+    for (auto const &access : accesses) {
+      sorted[next[access.obj]++] = {access.tid, access.event};
+    }
+    accesses = {};
+  }
+
+  // Threads are not necessarily visited in id order, so group each object's accesses by thread
+  auto const byThread = [](auto const &lhs, auto const &rhs) { return lhs.first < rhs.first; };
+  for (size_t id = 0; id < numObjs; ++id) {
+    auto const begin = sorted.begin() + objOffsets[id];
+    auto const end = sorted.begin() + objOffsets[id + 1];
+    if (!std::is_sorted(begin, end, byThread)) {
+      std::stable_sort(begin, end, byThread);
+    }
+  }
+
+  events.reserve(sorted.size());
+  for (auto const &[tid, event] : sorted) {
+    events.push_back(event);
+  }
+
+  // events is complete and will not be reallocated, so it is safe to hand out views into it.
+  // objOffsets is rewritten from offsets into events to offsets into threads
+  llvm::ArrayRef<const EventT *> allEvents(events);
+  size_t eventIdx = 0;
+  for (size_t id = 0; id < numObjs; ++id) {
+    auto const objEnd = objOffsets[id + 1];
+    objOffsets[id] = threads.size();
+    while (eventIdx < objEnd) {
+      auto const tid = sorted[eventIdx].first;
+      auto groupEnd = eventIdx;
+      while (groupEnd < objEnd && sorted[groupEnd].first == tid) ++groupEnd;
+      threads.push_back({tid, allEvents.slice(eventIdx, groupEnd - eventIdx)});
+      eventIdx = groupEnd;
     }
+  }
+  objOffsets[numObjs] = threads.size();
+}
 
-    auto id = objIDs.size();
-    objIDs[obj] = id;
-    return id;
-  };
+SharedMemory::SharedMemory(const ProgramTrace &program) : objects(program.objects) {
+  // every (object, thread, event) access, collected in a single pass over the program
+  std::vector<AccessIndex<ReadEvent>::Access> readAccesses;
+  std::vector<AccessIndex<WriteEvent>::Access> writeAccesses;
 
   if (DEBUG_PTA) {
     llvm::outs() << "** SharedMemory **"
@@ -53,11 +102,11 @@ SharedMemory::SharedMemory(const ProgramTrace &program) {
             }
           }
           // TODO: filter?
-          for (auto obj : ptsTo) {
-            auto &reads = objReads[getObjId(obj)][tid];
-            reads.push_back(readEvent);
+          for (auto id : ptsTo) {
+            readAccesses.push_back({id, tid, readEvent});
             if (DEBUG_PTA) {
-              llvm::outs() << obj->getValue() << " " << obj->getObjectID() << " " << getObjId(obj) << ", ";
+              auto const obj = objects.getObject(id);
+              llvm::outs() << obj->getValue() << " " << obj->getObjectID() << " " << id << ", ";
             }
           }
           if (DEBUG_PTA) {
@@ -82,11 +131,11 @@ SharedMemory::SharedMemory(const ProgramTrace &program) {
             }
           }
           // TODO: filter?
-          for (auto obj : ptsTo) {
-            auto &writes = objWrites[getObjId(obj)][tid];
-            writes.push_back(writeEvent);
+          for (auto id : ptsTo) {
+            writeAccesses.push_back({id, tid, writeEvent});
             if (DEBUG_PTA) {
-              llvm::outs() << obj->getValue() << " " << obj->getObjectID() << " " << getObjId(obj) << ", ";
+              auto const obj = objects.getObject(id);
+              llvm::outs() << obj->getValue() << " " << obj->getObjectID() << " " << id << ", ";
             }
           }
           if (DEBUG_PTA) {
@@ -100,54 +149,58 @@ SharedMemory::SharedMemory(const ProgramTrace &program) {
       }
     }
   }
+
+  reads = AccessIndex<ReadEvent>(objects.size(), std::move(readAccesses));
+  writes = AccessIndex<WriteEvent>(objects.size(), std::move(writeAccesses));
 }
+
 std::vector<const pta::ObjTy *> SharedMemory::getSharedObjects() const {
   std::vector<const pta::ObjTy *> sharedObjects;
-  for (auto const &[obj, objID] : objIDs) {
-    auto const nWriters = numThreadsWrite(objID);
-    auto const nReaders = numThreadsRead(objID);
+  for (ObjID id = 0; id < objects.size(); ++id) {
+    auto const threadedWrites = writes.get(id);
+    auto const threadedReads = reads.get(id);
+    auto const nWriters = threadedWrites.size();
+    auto const nReaders = threadedReads.size();
 
     // Common case: If > 1 writer or 1 writer and 2 reader, guaranteed shared across threads
     if (nWriters > 1 || (nWriters == 1 && nReaders > 1)) {
-      sharedObjects.push_back(obj);
+      sharedObjects.push_back(objects.getObject(id));
     }
     // When 1 writer and 1 reader, obj is shared if they are not the same thread
-    else if (nWriters == 1 && nReaders == 1 &&
-             objWrites.at(objID).begin()->first != objReads.at(objID).begin()->first) {
-      sharedObjects.push_back(obj);
+    else if (nWriters == 1 && nReaders == 1 && threadedWrites.front().tid != threadedReads.front().tid) {
+      sharedObjects.push_back(objects.getObject(id));
     }
   }
   return sharedObjects;
 }
-size_t SharedMemory::numThreadsWrite(ObjID id) const {
-  auto it = objWrites.find(id);
-  if (it == objWrites.end()) return 0;
-  return it->second.size();
-}
-size_t SharedMemory::numThreadsRead(SharedMemory::ObjID id) const {
-  auto it = objReads.find(id);
-  if (it == objReads.end()) return 0;
-  return it->second.size();
-}
-std::map<ThreadID, std::vector<const ReadEvent *>> SharedMemory::getThreadedReads(const pta::ObjTy *obj) const {
-  auto id = objIDs.find(obj);
-  if (id == objIDs.end()) return {};
 
-  // cppcheck-suppress stlIfFind
-  if (auto it = objReads.find(id->second); it != objReads.end()) {
-    return it->second;
-  }
+llvm::ArrayRef<ThreadAccesses<ReadEvent>> SharedMemory::getThreadedReads(const pta::ObjTy *obj) const {
+  auto const id = objects.getID(obj);
+  if (!id) return {};
+  return reads.get(id.value());
+}
 
-  return {};
+llvm::ArrayRef<ThreadAccesses<WriteEvent>> SharedMemory::getThreadedWrites(const pta::ObjTy *obj) const {
+  auto const id = objects.getID(obj);
+  if (!id) return {};
+  return writes.get(id.value());
 }
-std::map<ThreadID, std::vector<const WriteEvent *>> SharedMemory::getThreadedWrites(const pta::ObjTy *obj) const {
-  auto id = objIDs.find(obj);
-  if (id == objIDs.end()) return {};
 
-  // cppcheck-suppress stlIfFind
-  if (auto it = objWrites.find(id->second); it != objWrites.end()) {
-    return it->second;
-  }
+bool SharedMemory::isFirstCommonObject(const pta::ObjTy *obj, const WriteEvent *write, const MemAccessEvent *other) {
+  auto const writePtsTo = write->getAccessedMemory();
+  auto const otherPtsTo = other->getAccessedMemory();
+  // Common case: a single target must be obj
+  if (writePtsTo.size() == 1 || otherPtsTo.size() == 1) return true;
 
-  return {};
+  // Both are sorted and both contain obj, so they intersect
+  auto wIt = writePtsTo.begin();
+  auto oIt = otherPtsTo.begin();
+  while (*wIt != *oIt) {
+    if (*wIt < *oIt) {
+      ++wIt;
+    } else {
+      ++oIt;
+    }
+  }
+  return write->getThread().program.objects.getObject(*wIt) == obj;
 }
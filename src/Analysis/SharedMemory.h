@@ -11,37 +11,108 @@ limitations under the License.
 
 #pragma once
 
-#include <map>
+#include <llvm/ADT/ArrayRef.h>
+
+#include <iterator>
+#include <vector>
 
 #include "LanguageModel/RaceModel.h"
 #include "Trace/ProgramTrace.h"
 
 namespace race {
 
-struct SharedMemory {
-  using ObjID = size_t;
-  std::map<const pta::ObjTy *, ObjID> objIDs;
+// All accesses of one type made by one thread to one object, in program order
+template <typename EventT>
+struct ThreadAccesses {
+  ThreadID tid;
+  llvm::ArrayRef<const EventT *> events;
+};
 
-  struct Accesses {
-    std::vector<const ReadEvent *> reads;
-    std::vector<const WriteEvent *> writes;
-  };
+class SharedMemory {
+  // Immutable CSR style index from object to the accesses made to it.
+  // The accesses to object id are threads[objOffsets[id], objOffsets[id+1]), one entry per thread sorted by
+  // thread id. Each entry points into events, which holds every access contiguously grouped by object then thread.
+  template <typename EventT>
+  class AccessIndex {
+    std::vector<size_t> objOffsets;
+    std::vector<ThreadAccesses<EventT>> threads;
+    std::vector<const EventT *> events;
 
-  std::map<ObjID, std::map<ThreadID, Accesses>> objAccesses;
+   public:
+    struct Access {
+      ObjID obj;
+      ThreadID tid;
+      const EventT *event;
+    };
 
-  std::map<ObjID, std::map<ThreadID, std::vector<const ReadEvent *>>> objReads;
-  std::map<ObjID, std::map<ThreadID, std::vector<const WriteEvent *>>> objWrites;
+    AccessIndex() = default;
+    // accesses must be in program order for each thread, and are released once the index is built
+    AccessIndex(size_t numObjs, std::vector<Access> accesses);
+
+    // threads holds views into events, so the index can be moved but not copied
+    AccessIndex(const AccessIndex &) = delete;
+    AccessIndex &operator=(const AccessIndex &) = delete;
+    AccessIndex(AccessIndex &&) noexcept = default;
+    AccessIndex &operator=(AccessIndex &&) noexcept = default;
+
+    [[nodiscard]] llvm::ArrayRef<ThreadAccesses<EventT>> get(ObjID id) const {
+      if (id + 1 >= objOffsets.size()) return {};
+      return llvm::makeArrayRef(threads).slice(objOffsets[id], objOffsets[id + 1] - objOffsets[id]);
+    }
+  };
 
-  [[nodiscard]] size_t numThreadsWrite(ObjID id) const;
-  [[nodiscard]] size_t numThreadsRead(ObjID id) const;
+  // dense object ids assigned while building the trace
+  const ObjectTable &objects;
+
+  AccessIndex<ReadEvent> reads;
+  AccessIndex<WriteEvent> writes;
 
  public:
   explicit SharedMemory(const ProgramTrace &);
 
   [[nodiscard]] std::vector<const pta::ObjTy *> getSharedObjects() const;
 
-  // TODO: wrap this in option?? Make a copy?? Iterator??
-  [[nodiscard]] std::map<ThreadID, std::vector<const ReadEvent *>> getThreadedReads(const pta::ObjTy *obj) const;
-  [[nodiscard]] std::map<ThreadID, std::vector<const WriteEvent *>> getThreadedWrites(const pta::ObjTy *obj) const;
+  // Accesses to obj grouped by thread and sorted by thread id
+  // The result is a view into this SharedMemory and is never copied
+  [[nodiscard]] llvm::ArrayRef<ThreadAccesses<ReadEvent>> getThreadedReads(const pta::ObjTy *obj) const;
+  [[nodiscard]] llvm::ArrayRef<ThreadAccesses<WriteEvent>> getThreadedWrites(const pta::ObjTy *obj) const;
+
+  // Calls visit(write, other) for every write/read and write/write pair of accesses to obj from different threads,
+  // in the same order on every run. Stops and returns false as soon as visit returns false
+  template <typename Visit>
+  bool forEachPair(const pta::ObjTy *obj, Visit &&visit) const {
+    auto const threadedWrites = getThreadedWrites(obj);
+    auto const threadedReads = getThreadedReads(obj);
+
+    for (auto it = threadedWrites.begin(), end = threadedWrites.end(); it != end; ++it) {
+      auto const wtid = it->tid;
+      auto const writes = it->events;
+      // Read/Write pairs
+      for (auto const &[rtid, reads] : threadedReads) {
+        if (wtid == rtid) continue;
+        for (auto write : writes) {
+          for (auto read : reads) {
+            if (!visit(write, read)) return false;
+          }
+        }
+      }
+
+      // Write/Write pairs
+      for (auto wit = std::next(it, 1); wit != end; ++wit) {
+        auto const otherWrites = wit->events;
+        for (auto write : writes) {
+          for (auto otherWrite : otherWrites) {
+            if (!visit(write, otherWrite)) return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  // A pair of accesses is visited under every shared object both may access. This is only true for the first of
+  // those objects (by ObjID), so each pair can be handled once without remembering which pairs were seen
+  [[nodiscard]] static bool isFirstCommonObject(const pta::ObjTy *obj, const WriteEvent *write,
+                                                const MemAccessEvent *other);
 };
-}  // namespace race
\ No newline at end of file
+}  // namespace race
@@ -11,6 +11,8 @@ limitations under the License.
 
 #include "Analysis/ThreadLocalAnalysis.h"
 
+#include "Trace/ProgramTrace.h"
+
 using namespace race;
 
 bool ThreadLocalAnalysis::isThreadLocalAccess(const MemAccessEvent *write, const MemAccessEvent *other) {
@@ -25,8 +27,10 @@ bool ThreadLocalAnalysis::isThreadLocalAccess(const MemAccessEvent *write, const
   // We should not report a race because the only possible
   // shared object is thread local.
 
-  const auto &writePtsTo = write->getAccessedMemory();
-  const auto &otherPtsTo = other->getAccessedMemory();
+  // Both are sorted arrays of dense object ids, owned by the trace
+  auto const writePtsTo = write->getAccessedMemory();
+  auto const otherPtsTo = other->getAccessedMemory();
+  auto const &objects = write->getThread().program.objects;
 
   // this is set intersection, but we can fail fast unlike the stl implementation
   // this allows us to have superior speeds in cases that definitely don't involve globals faster since it will just
@@ -34,12 +38,12 @@ bool ThreadLocalAnalysis::isThreadLocalAccess(const MemAccessEvent *write, const
   auto wptIter = writePtsTo.begin();
   auto optIter = otherPtsTo.begin();
   while (wptIter != writePtsTo.end() && optIter != otherPtsTo.end()) {
-    if (optIter == otherPtsTo.end() || *wptIter < *optIter) {
+    if (*wptIter < *optIter) {
       wptIter++;
-    } else if (wptIter == writePtsTo.end() || *wptIter > *optIter) {
+    } else if (*wptIter > *optIter) {
       optIter++;
     } else {
-      auto const val = (*wptIter)->getValue();
+      auto const val = objects.getObject(*wptIter)->getValue();
 
       auto const global = llvm::dyn_cast_or_null<llvm::GlobalVariable>(val);
       if (!global || !global->isThreadLocal()) {
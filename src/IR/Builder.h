@@ -11,6 +11,7 @@ limitations under the License.
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
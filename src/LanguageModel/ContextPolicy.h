@@ -0,0 +1,30 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+namespace pta {
+
+// How context sensitive the race model pointer analysis is, chosen at runtime.
+// Every policy uses the same context type (originCtx), they only differ in when a context evolves and in how many
+// call sites it remembers.
+enum class ContextPolicy {
+  // never evolve, every function is analyzed once
+  Insensitive,
+  // remember the last origin (thread/task creation site)
+  Origin1,
+  // remember the last three origins
+  Origin3,
+  // remember the last call site, regardless of whether it creates an origin
+  CallSite1,
+};
+
+}  // namespace pta
@@ -17,10 +17,28 @@ limitations under the License.
 
 using namespace pta;
 
-RaceModel::RaceModel(llvm::Module *M, llvm::StringRef entry) : Super(M, entry) {
-  originCtx::setOriginRules([&](const originCtx *context, const llvm::Instruction *I) -> bool {
+RaceModel::RaceModel(llvm::Module *M, llvm::StringRef entry, ContextPolicy contextPolicy)
+    : Super(M, entry), contextPolicy(contextPolicy) {
+  auto const invokesOrigin = [&](const originCtx *context, const llvm::Instruction *I) -> bool {
     return this->isInvokingAnOrigin(context, I);
-  });
+  };
+  auto const never = [](const originCtx *, const llvm::Instruction *) { return false; };
+  auto const always = [](const originCtx *, const llvm::Instruction *) { return true; };
+
+  switch (contextPolicy) {
+    case ContextPolicy::Insensitive:
+      originCtx::setOriginRules(never, 0);
+      break;
+    case ContextPolicy::Origin1:
+      originCtx::setOriginRules(invokesOrigin, 1);
+      break;
+    case ContextPolicy::Origin3:
+      originCtx::setOriginRules(invokesOrigin, 3);
+      break;
+    case ContextPolicy::CallSite1:
+      originCtx::setOriginRules(always, 1);
+      break;
+  }
 }
 
 InterceptResult RaceModel::interceptFunction(const ctx * /* callerCtx */, const ctx * /* calleeCtx */,
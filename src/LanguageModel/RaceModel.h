@@ -10,6 +10,7 @@ limitations under the License.
 ==============================================================================*/
 
 #pragma once
+#include "LanguageModel/ContextPolicy.h"
 #include "PointerAnalysis/Context/HybridCtx.h"
 #include "PointerAnalysis/Context/KCallSite.h"
 #include "PointerAnalysis/Context/KOrigin.h"
@@ -31,6 +32,8 @@ class RaceModel : public LangModelBase<ctx, MemModel, PtsTy, RaceModel> {
  private:
   DefaultHeapModel heapModel;
 
+  ContextPolicy contextPolicy;
+
   using Super = LangModelBase<ctx, MemModel, PtsTy, RaceModel>;
 
   bool isInvokingAnOrigin(const originCtx *prevCtx, const llvm::Instruction *I);
@@ -53,7 +56,9 @@ class RaceModel : public LangModelBase<ctx, MemModel, PtsTy, RaceModel> {
 
   bool isHeapAllocAPI(const llvm::Function *F, const llvm::Instruction *callsite = nullptr);
 
-  RaceModel(llvm::Module *M, llvm::StringRef entry);
+  RaceModel(llvm::Module *M, llvm::StringRef entry, ContextPolicy contextPolicy = ContextPolicy::Origin3);
+
+  [[nodiscard]] ContextPolicy getContextPolicy() const { return contextPolicy; }
 };
 
 template <>
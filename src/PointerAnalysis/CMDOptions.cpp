@@ -23,6 +23,25 @@ cl::opt<bool> USE_MEMLAYOUT_FILTERING(
     "Xmemlayout-filtering", cl::desc("Use memory layout to filter out incompatible types in field-sensitive PTA"));
 cl::opt<bool> CONFIG_VTABLE_MODE("Xenable-vtable", cl::desc("model vtable specially"), cl::init(false));
 cl::opt<bool> CONFIG_USE_FI_MODE("Xuse-fi-model", cl::desc("use field insensitive analyse"), cl::init(false));
+cl::opt<unsigned> ConfigPTAJobs("pta-jobs",
+                                cl::desc("Number of threads used by the pointer analysis solver (0 = one per core)"),
+                                cl::init(1));
+cl::opt<bool> ConfigPTAOfflineHVN("pta-hvn",
+                                  cl::desc("Merge pointers with provably identical points-to sets before solving"),
+                                  cl::init(false));
+cl::opt<unsigned> ConfigPTATimeBudget(
+    "pta-time-budget",
+    cl::desc("Seconds the pointer analysis may take before it starts giving up precision (0 = unlimited)"),
+    cl::init(0));
+cl::opt<unsigned> ConfigPTAMemBudget(
+    "pta-mem-budget",
+    cl::desc("MB of memory the pointer analysis may use before it starts giving up precision (0 = unlimited)"),
+    cl::init(0));
+cl::opt<bool> ConfigPTABudgetStopSolving(
+    "pta-budget-stop-solving",
+    cl::desc("Let the pointer analysis stop before a fixed point when giving up precision did not keep it within "
+             "budget. Unsound: races may be missed"),
+    cl::init(false));
 
 // pta cmd options: set to default values
 cl::opt<bool> DEBUG_PTA("DEBUG_PTA", cl::desc("debug pointer analysis"), cl::init(false));
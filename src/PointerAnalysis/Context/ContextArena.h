@@ -0,0 +1,122 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Instruction.h>
+
+#include <deque>
+#include <unordered_set>
+
+namespace pta {
+
+// Owns the contexts of one kind created by contextEvolve.
+//
+// Every distinct context is interned once, constructed with its hash already computed and with a dense 32-bit ID
+// (FIRST_ID + its index in the arena). Evolving a context at a call site is memoized on (context ID, call site), so
+// evolving the same context at the same call site again is a single hash probe.
+//
+// Ctx needs a Ctx(const Ctx *prevCtx, const llvm::Instruction *I, uint32_t id) constructor, getID(), getHash()
+// and operator==.
+template <typename Ctx>
+class ContextArena {
+ public:
+  // the initial and the global context are not owned by the arena but still need an ID
+  static constexpr uint32_t INITIAL_CTX_ID = 0;
+  static constexpr uint32_t GLOBAL_CTX_ID = 1;
+  static constexpr uint32_t FIRST_ID = 2;
+
+ private:
+  struct CtxHash {
+    size_t operator()(const Ctx *context) const { return context->getHash(); }
+  };
+
+  struct CtxEqual {
+    bool operator()(const Ctx *lhs, const Ctx *rhs) const { return *lhs == *rhs; }
+  };
+
+  // a deque never relocates its elements, contexts can be neither copied nor moved
+  std::deque<Ctx> contexts;
+  std::unordered_set<const Ctx *, CtxHash, CtxEqual> interned;
+  llvm::DenseMap<std::pair<uint32_t, const llvm::Instruction *>, const Ctx *> evolved;
+  // a frozen arena only hands out contexts it already has
+  bool frozen = false;
+
+ public:
+  // the memoized result of evolving prevCtx at I, nullptr if that has not happened yet
+  [[nodiscard]] const Ctx *lookup(const Ctx *prevCtx, const llvm::Instruction *I) const {
+    auto it = evolved.find({prevCtx->getID(), I});
+    return it == evolved.end() ? nullptr : it->second;
+  }
+
+  void memoize(const Ctx *prevCtx, const llvm::Instruction *I, const Ctx *result) {
+    evolved[{prevCtx->getID(), I}] = result;
+  }
+
+  // the unique context that extends prevCtx with I, not memoized.
+  // once frozen, prevCtx is returned instead of creating a new context
+  const Ctx *intern(const Ctx *prevCtx, const llvm::Instruction *I) {
+    auto const &candidate = contexts.emplace_back(prevCtx, I, static_cast<uint32_t>(FIRST_ID + contexts.size()));
+    if (frozen) {
+      auto const it = interned.find(&candidate);
+      contexts.pop_back();
+      return it == interned.end() ? prevCtx : *it;
+    }
+
+    auto const result = interned.insert(&candidate);
+    if (!result.second) {
+      // already interned, give the ID back
+      contexts.pop_back();
+    }
+    return *result.first;
+  }
+
+  // the unique context that extends prevCtx with I, memoized
+  const Ctx *evolve(const Ctx *prevCtx, const llvm::Instruction *I) {
+    auto &result = evolved[{prevCtx->getID(), I}];
+    if (result == nullptr) {
+      result = intern(prevCtx, I);
+    }
+    return result;
+  }
+
+  // drop the memoized evolutions but keep the contexts alive
+  void forgetEvolutions() { evolved.clear(); }
+
+  // stop creating contexts, returns false if the arena was already frozen
+  bool freeze() {
+    if (frozen) {
+      return false;
+    }
+    frozen = true;
+    return true;
+  }
+
+  // create contexts again, evolutions memoized while frozen are dropped
+  void thaw() {
+    if (frozen) {
+      frozen = false;
+      evolved.clear();
+    }
+  }
+
+  [[nodiscard]] size_t size() const { return contexts.size(); }
+
+  void clear() {
+    frozen = false;
+    evolved.clear();
+    interned.clear();
+    contexts.clear();
+  }
+};
+
+}  // namespace pta
@@ -11,8 +11,12 @@ limitations under the License.
 
 #pragma once
 
+#include "PointerAnalysis/Util/ThreadBound.h"
+
 namespace pta {
 
+// Every context kind specializes CtxTrait. The contexts created by one PTA are kept in a CtxTrait<ctx>::State owned by
+// the PTA, CtxTrait<ctx>::bind(state) makes the static functions of the trait use it on the calling thread.
 template <typename ctx>
 class CtxTrait {
   using unknownTypeError = typename ctx::unknownTypeErrorType;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <tuple>
 #include <unordered_set>
+#include <utility>
 
 #include "CtxTrait.h"
 #include "KOrigin.h"
@@ -74,17 +75,52 @@ bool operator==(const HybridCtx<Args...> &lhs, const HybridCtx<Args...> &rhs) {
 // basically just delegate it to different CtxTrait
 template <typename... Args>
 struct CtxTrait<HybridCtx<Args...>> {
+  struct State {
+    std::unordered_set<HybridCtx<Args...>> ctxSet;
+    bool frozen = false;
+    // the contexts of every kind combined
+    std::tuple<typename CtxTrait<Args>::State...> inner;
+  };
+  // binds the inner states as well
+  using Scope = std::pair<typename ThreadBound<State>::Scope, std::tuple<typename CtxTrait<Args>::Scope...>>;
+
  private:
   static const HybridCtx<Args...> initCtx;
   static const HybridCtx<Args...> globCtx;
-  static std::unordered_set<HybridCtx<Args...>> ctxSet;
+
+  static State &state() { return ThreadBound<State>::get(); }
+
+  template <size_t... N>
+  static Scope bind(State &state, std::index_sequence<N...>) {
+    return Scope(typename ThreadBound<State>::Scope(state),
+                 std::tuple<typename CtxTrait<Args>::Scope...>(CtxTrait<Args>::bind(std::get<N>(state.inner))...));
+  }
 
  public:
+  static Scope bind(State &state) { return bind(state, std::index_sequence_for<Args...>{}); }
+
   static const HybridCtx<Args...> *contextEvolve(const HybridCtx<Args...> *prevCtx, const llvm::Instruction *I) {
+    auto &ctxSet = state().ctxSet;
+    if (state().frozen) {
+      auto it = ctxSet.find(HybridCtx<Args...>(prevCtx, I));
+      return it == ctxSet.end() ? prevCtx : &*it;
+    }
     auto result = ctxSet.emplace(prevCtx, I);
     return &*result.first;
   }
 
+  // the inner contexts are frozen as well, so no combination of them is created either
+  static bool freeze() {
+    bool changed = !std::exchange(state().frozen, true);
+    ((changed |= CtxTrait<Args>::freeze()), ...);
+    return changed;
+  }
+
+  static void thaw() {
+    state().frozen = false;
+    (CtxTrait<Args>::thaw(), ...);
+  }
+
   static const HybridCtx<Args...> *getInitialCtx() { return &initCtx; }
   static const HybridCtx<Args...> *getGlobalCtx() { return &globCtx; }
 
@@ -95,7 +131,10 @@ struct CtxTrait<HybridCtx<Args...>> {
     return context->toString(detailed);
   }
 
-  static void release() { ctxSet.clear(); }
+  static void release() {
+    state().frozen = false;
+    state().ctxSet.clear();
+  }
 };
 
 template <typename... Args>
@@ -104,9 +143,6 @@ const HybridCtx<Args...> CtxTrait<HybridCtx<Args...>>::initCtx{CtxTrait<Args>::g
 template <typename... Args>
 const HybridCtx<Args...> CtxTrait<HybridCtx<Args...>>::globCtx{CtxTrait<Args>::getGlobalCtx()...};
 
-template <typename... Args>
-std::unordered_set<HybridCtx<Args...>> CtxTrait<HybridCtx<Args...>>::ctxSet{};
-
 }  // namespace pta
 
 namespace std {
@@ -14,6 +14,7 @@ limitations under the License.
 #include <llvm/ADT/Hashing.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include "ContextArena.h"
 #include "CtxTrait.h"
 #include "PointerAnalysis/Program/CallSite.h"
 #include "PointerAnalysis/Util/SingleInstanceOwner.h"
@@ -26,15 +27,27 @@ class KCallSite {
  private:
   using self = KCallSite<K>;
   PtrRingBuffer<const llvm::Instruction, K> ctxBuffer;
+  // contexts are interned, see ContextArena
+  size_t hash;
+  uint32_t id;
+
+  [[nodiscard]] size_t computeHash() const {
+    return static_cast<size_t>(llvm::hash_combine_range(ctxBuffer.begin(), ctxBuffer.end()));
+  }
 
  public:
   using iterator = typename PtrRingBuffer<const llvm::Instruction, K>::iterator;
 
-  KCallSite() noexcept : ctxBuffer() {}
+  explicit KCallSite(uint32_t id) noexcept : ctxBuffer(), hash(computeHash()), id(id) {}
 
-  KCallSite(const self *prevCtx, const llvm::Instruction *I) : ctxBuffer(prevCtx->ctxBuffer) {
+  // only the depth most recent call sites are kept, the others are forgotten
+  KCallSite(const self *prevCtx, const llvm::Instruction *I, uint32_t id, uint32_t depth = K)
+      : ctxBuffer(prevCtx->ctxBuffer), id(id) {
     assert(pta::CallSite(I).isCallOrInvoke());
+    assert(depth <= K);
     ctxBuffer.push(I);
+    ctxBuffer.truncate(depth);
+    hash = computeHash();
   }
 
   KCallSite(const self &) = delete;
@@ -46,6 +59,11 @@ class KCallSite {
 
   iterator end() const { return ctxBuffer.end(); }
 
+  [[nodiscard]] size_t getHash() const { return hash; }
+
+  // dense ID of the context, unique among the contexts of this kind
+  [[nodiscard]] uint32_t getID() const { return id; }
+
   [[nodiscard]] std::string toString(bool detailed = false) const {
     std::string str;
     llvm::raw_string_ostream os(str);
@@ -79,6 +97,9 @@ class KCallSite {
   bool empty() const { return getLast() == nullptr; };
 
   bool operator==(const self &rhs) const {
+    if (this->hash != rhs.hash) {
+      return false;
+    }
     // bz: seems like it is comparing this and rhs, but where is the use of rhs?? fix this by assigning xx2 to rhs's
     auto it1 = this->begin();
     auto it2 = rhs.begin();
@@ -98,17 +119,29 @@ class KCallSite {
 
 template <uint32_t K>
 struct CtxTrait<KCallSite<K>> {
+  // the contexts of one PTA
+  using State = ContextArena<KCallSite<K>>;
+  using Scope = typename ThreadBound<State>::Scope;
+
  private:
   static const KCallSite<K> initCtx;
   static const KCallSite<K> globCtx;
-  static std::unordered_set<KCallSite<K>> ctxSet;
+
+  static State &arena() { return ThreadBound<State>::get(); }
 
  public:
+  static Scope bind(State &state) { return Scope(state); }
+
   static const KCallSite<K> *contextEvolve(const KCallSite<K> *prevCtx, const llvm::Instruction *I) {
-    auto result = ctxSet.emplace(prevCtx, I);
-    return &*result.first;
+    return arena().evolve(prevCtx, I);
   }
 
+  inline static size_t getNumCtx() { return arena().size(); }
+
+  // stop creating new contexts, evolving then keeps the previous context
+  static bool freeze() { return arena().freeze(); }
+  static void thaw() { arena().thaw(); }
+
   static const KCallSite<K> *getInitialCtx() { return &initCtx; }
 
   static const KCallSite<K> *getGlobalCtx() { return &globCtx; }
@@ -119,29 +152,23 @@ struct CtxTrait<KCallSite<K>> {
     return context->toString(detailed);
   }
 
-  static void release() { ctxSet.clear(); }
+  static void release() { arena().clear(); }
 };
 
 template <uint32_t K>
-const KCallSite<K> CtxTrait<KCallSite<K>>::initCtx{};
+const KCallSite<K> CtxTrait<KCallSite<K>>::initCtx{ContextArena<KCallSite<K>>::INITIAL_CTX_ID};
 
 template <uint32_t K>
-const KCallSite<K> CtxTrait<KCallSite<K>>::globCtx{};
-
-template <uint32_t K>
-std::unordered_set<KCallSite<K>> CtxTrait<KCallSite<K>>::ctxSet{};
+const KCallSite<K> CtxTrait<KCallSite<K>>::globCtx{ContextArena<KCallSite<K>>::GLOBAL_CTX_ID};
 
 }  // namespace pta
 
 namespace std {
 
-// only hash context and value
+// the hash is computed once when the context is created
 template <uint32_t K>
 struct hash<pta::KCallSite<K>> {
-  size_t operator()(const pta::KCallSite<K> &cs) const {
-    llvm::hash_code hash = llvm::hash_combine_range(cs.begin(), cs.end());
-    return hash_value(hash);
-  }
+  size_t operator()(const pta::KCallSite<K> &cs) const { return cs.getHash(); }
 };
 
 }  // namespace std
@@ -33,13 +33,20 @@ class KOrigin : public KCallSite<K * L> {
   using self = KOrigin<K, L>;
   using super = KCallSite<K * L>;
 
-  static std::function<bool(const self *, const llvm::Instruction *)> callback;
-
  public:
-  KOrigin() noexcept : super() {}
-  KOrigin(const self *prevCtx, const llvm::Instruction *I) : super(prevCtx, I) {}
-
-  static void setOriginRules(std::function<bool(const self *, const llvm::Instruction *)> cb) { callback = cb; }
+  explicit KOrigin(uint32_t id) noexcept : super(id) {}
+  KOrigin(const self *prevCtx, const llvm::Instruction *I, uint32_t id)
+      : super(prevCtx, I, id, CtxTrait<self>::state().depth) {}
+
+  // the rules of the PTA bound to the calling thread, see CtxTrait<KOrigin>::bind
+  static void setOriginRules(std::function<bool(const self *, const llvm::Instruction *)> cb, uint32_t depth = K * L) {
+    assert(depth <= K * L);
+    auto &state = CtxTrait<self>::state();
+    state.callback = cb;
+    state.depth = depth;
+    // memoized evolutions were decided by the old rules
+    state.arena.forgetEvolutions();
+  }
 
   KOrigin(const self &) = delete;
   KOrigin(self &&) = delete;
@@ -52,25 +59,48 @@ class KOrigin : public KCallSite<K * L> {
 
 template <uint32_t K, uint32_t L>
 struct CtxTrait<KOrigin<K, L>> {
+  // the contexts of one PTA and the rules that decide them
+  struct State {
+    ContextArena<KOrigin<K, L>> arena;
+    // by default no function is origin
+    std::function<bool(const KOrigin<K, L> *, const llvm::Instruction *)> callback =
+        [](const KOrigin<K, L> *, const llvm::Instruction *) { return false; };
+    // how many origins a context remembers, chosen at runtime but at most K * L
+    uint32_t depth = K * L;
+  };
+  using Scope = typename ThreadBound<State>::Scope;
+
  private:
   static const KOrigin<K, L> initCtx;
   static const KOrigin<K, L> globCtx;
-  static std::unordered_set<KOrigin<K, L>> ctxSet;
+
+  static State &state() { return ThreadBound<State>::get(); }
 
  public:
+  static Scope bind(State &state) { return Scope(state); }
+
   static const KOrigin<K, L> *contextEvolve(const KOrigin<K, L> *prevCtx, const llvm::Instruction *I) {
     if constexpr (L == 1) {
-      if (KOrigin<K, L>::callback(prevCtx, I)) {
-        auto result = ctxSet.emplace(prevCtx, I);
-        return &*result.first;
+      auto &arena = state().arena;
+      // the origin rule is only asked once per (context, call site)
+      if (auto evolved = arena.lookup(prevCtx, I)) {
+        return evolved;
       }
-      return prevCtx;
+      auto evolved = state().callback(prevCtx, I) ? arena.intern(prevCtx, I) : prevCtx;
+      arena.memoize(prevCtx, I, evolved);
+      return evolved;
     } else {
       llvm_unreachable("No support yet");
     }
   }
 
-  inline static size_t getNumCtx() { return ctxSet.size(); }
+  inline static size_t getNumCtx() { return state().arena.size(); }
+
+  // stop creating new contexts, evolving then keeps the previous context
+  static bool freeze() { return state().arena.freeze(); }
+  static void thaw() { state().arena.thaw(); }
+
+  static void forgetEvolutions() { state().arena.forgetEvolutions(); }
 
   static const KOrigin<K, L> *getInitialCtx() { return &initCtx; }
 
@@ -83,24 +113,16 @@ struct CtxTrait<KOrigin<K, L>> {
     return context->toString(detailed);
   }
 
-  static void release() { ctxSet.clear(); }
-};
-
-template <uint32_t K, uint32_t L>
-const KOrigin<K, L> CtxTrait<KOrigin<K, L>>::initCtx{};
+  static void release() { state().arena.clear(); }
 
-template <uint32_t K, uint32_t L>
-const KOrigin<K, L> CtxTrait<KOrigin<K, L>>::globCtx{};
+  friend KOrigin<K, L>;
+};
 
 template <uint32_t K, uint32_t L>
-std::unordered_set<KOrigin<K, L>> CtxTrait<KOrigin<K, L>>::ctxSet{};
+const KOrigin<K, L> CtxTrait<KOrigin<K, L>>::initCtx{ContextArena<KOrigin<K, L>>::INITIAL_CTX_ID};
 
 template <uint32_t K, uint32_t L>
-std::function<bool(const KOrigin<K, L> *, const llvm::Instruction *)> KOrigin<K, L>::callback =
-    [](const KOrigin<K, L> *, const llvm::Instruction *) {
-      // by default no function is origin
-      return false;
-    };
+const KOrigin<K, L> CtxTrait<KOrigin<K, L>>::globCtx{ContextArena<KOrigin<K, L>>::GLOBAL_CTX_ID};
 
 }  // namespace pta
 
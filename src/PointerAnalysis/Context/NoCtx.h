@@ -27,12 +27,19 @@ using NoCtx = std::nullptr_t;
 
 template <>
 struct CtxTrait<NoCtx> {
+  // there is no context to keep
+  struct State {};
+  struct Scope {};
+  constexpr static Scope bind(State&) { return {}; }
+
   // No runtime overhead when
   constexpr static const NoCtx* contextEvolve(const NoCtx*, const llvm::Instruction*) { return nullptr; }
   constexpr static const NoCtx* getInitialCtx() { return nullptr; }
   constexpr static const NoCtx* getGlobalCtx() { return nullptr; }
 
   inline static std::string toString(const NoCtx*, bool /* detailed */ = false) { return "<Empty>"; }
+  constexpr static bool freeze() { return false; }
+  constexpr static void thaw() {}
   inline static void release(){};
 };
 
@@ -85,6 +85,14 @@ class PtrRingBuffer {
     return popped;
   }
 
+  // only keep the n most recently pushed items
+  void truncate(uint32_t n) {
+    for (uint32_t i = n; i < N; i++) {
+      // last - 1 is the most recent item, last - N the oldest
+      buffer[(last + N - 1 - i) % N] = nullptr;
+    }
+  }
+
   iterator begin() const { return RingBufferIterator<PtrT, N>(this, last); }
 
   iterator end() const { return RingBufferIterator<PtrT, N>(this, N); }
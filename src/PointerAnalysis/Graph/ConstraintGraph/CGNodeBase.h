@@ -20,11 +20,13 @@ limitations under the License.
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/Utils/Local.h>
 
+#include <atomic>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "PointerAnalysis/Graph/ConstraintGraph/ConstraintEdgeSet.h"
 #include "PointerAnalysis/Graph/GraphBase/GraphBase.h"
 namespace std {
 
@@ -82,14 +84,21 @@ class CGNodeBase {
   const NodeID id;
   GraphTy *graph;
 
-  Self *superNode;  // the super node
+  // super nodes are resolved through a union-find forest over the collapsed nodes.
+  // parent is the parent in the forest (nullptr for a root); it is rewritten by path compression, which may run
+  // concurrently from the parallel solver, hence the atomic.
+  mutable std::atomic<Self *> parent;
+  // only meaningful on a root: the number of nodes in its tree and the super node that represents the tree.
+  // the representative is chosen by collapseSCCTo and need not be the root itself (union by size picks the root)
+  uint32_t treeSize;
+  Self *representative;
   llvm::SparseBitVector<> childNodes;
   // whether the node is immutable (the points-to set should not be updated)
   bool isImmutable;
 #define USE_NODE_ID_FOR_CONSTRAINTS
 #ifdef USE_NODE_ID_FOR_CONSTRAINTS
   // maybe use ID for the constraints
-  using SetTy = llvm::SparseBitVector<64>;
+  using SetTy = ConstraintEdgeSet;
 #else
   using SetTy = llvm::DenseSet<Self *>;
 #endif
@@ -105,9 +114,38 @@ class CGNodeBase {
   IndirectNodeSet indirectNodes;
 
   inline CGNodeBase(NodeID id, CGNodeKind type)
-      : type(type), id(id), superNode(nullptr), childNodes{}, isImmutable(false), indirectNodes{} {}
+      : type(type),
+        id(id),
+        parent(nullptr),
+        treeSize(1),
+        representative(this),
+        childNodes{},
+        isImmutable(false),
+        indirectNodes{} {}
 
  private:
+  // the root of the tree that contains the node, every node on the walked path is re-pointed to the root
+  inline Self *findRoot() const {
+    auto root = const_cast<Self *>(this);
+    uint32_t hops = 0;
+    for (Self *next = root->parent.load(std::memory_order_relaxed); next != nullptr;
+         next = root->parent.load(std::memory_order_relaxed)) {
+      root = next;
+      hops++;
+    }
+
+    // concurrent finds can only ever store the same root here, merging never runs in parallel with them
+    for (Self *node = const_cast<Self *>(this); node != root;) {
+      Self *next = node->parent.load(std::memory_order_relaxed);
+      if (next != root) {
+        node->parent.store(root, std::memory_order_relaxed);
+      }
+      node = next;
+    }
+    static_cast<ConstraintGraph<ctx> *>(graph)->recordSuperNodeLookup(hops);
+    return root;
+  }
+
   inline bool insertConstraint(Self *node, Constraints edgeKind) {
     // this --edge-> node
     if (edgeKind != Constraints::special && node->isImmutable) {
@@ -168,14 +206,29 @@ class CGNodeBase {
 
   inline bool isSuperNode() const { return !childNodes.empty(); }
 
-  inline void setSuperNode(Self *node) { this->superNode = node; }
+  // merge the node into the set represented by node, both of them must not have a super node yet
+  inline void setSuperNode(Self *node) {
+    assert(this != node && !this->hasSuperNode() && !node->hasSuperNode());
+    Self *root = this->findRoot();
+    Self *otherRoot = node->findRoot();
+    // the chain of every node merged so far grows by one without path compression
+    static_cast<ConstraintGraph<ctx> *>(graph)->recordSuperNodeMerge(root->treeSize);
+
+    // union by size: hang the smaller tree below the larger one, the representative stays the given node
+    if (root->treeSize > otherRoot->treeSize) {
+      std::swap(root, otherRoot);
+    }
+    root->parent.store(otherRoot, std::memory_order_relaxed);
+    otherRoot->treeSize += root->treeSize;
+    otherRoot->representative = node;
+  }
 
-  inline Self *getSuperNode() {
-    Self *node = this;
-    while (node->superNode != nullptr) {
-      node = node->superNode;
+  inline Self *getSuperNode() const {
+    // fast path, the node has never been merged into another node (or is the root of its tree)
+    if (parent.load(std::memory_order_relaxed) == nullptr) {
+      return representative;
     }
-    return node;
+    return findRoot()->representative;
   }
 
   // remove all the edges
@@ -231,7 +284,7 @@ class CGNodeBase {
 
   [[nodiscard]] inline CGNodeKind getType() const { return type; }
 
-  [[nodiscard]] inline bool hasSuperNode() const { return superNode != nullptr; }
+  [[nodiscard]] inline bool hasSuperNode() const { return getSuperNode() != this; }
 
   inline void setIndirectCallNode(CallGraphNode<ctx> *callNode) {
     // assert(callNode->isIndirectCall() && this->indirectNode == nullptr);
@@ -0,0 +1,208 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/SparseBitVector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "PointerAnalysis/Graph/NodeID.def"
+
+namespace pta {
+
+// The node ids on one kind of constraint edge (e.g. the copy successors) of a constraint graph node.
+//
+// Most nodes only have one or two edges of a kind, so up to INLINE_CAPACITY ids are kept sorted inside the object
+// and only larger sets are upgraded to a heap allocated SparseBitVector. The set is 16 bytes, half of an empty
+// SparseBitVector<64>, and does not allocate at all while it stays small.
+class ConstraintEdgeSet {
+ public:
+  using BitVector = llvm::SparseBitVector<64>;
+  static constexpr uint32_t INLINE_CAPACITY = 3;
+
+ private:
+  // marks that ids holds a pointer to the bit vector instead of inline node ids
+  static constexpr uint32_t LARGE = std::numeric_limits<uint32_t>::max();
+
+  // sorted inline ids, or the BitVector pointer stored in the first two slots once the set is large
+  NodeID ids[INLINE_CAPACITY];
+  uint32_t size;
+
+  [[nodiscard]] inline bool isLarge() const { return size == LARGE; }
+
+  [[nodiscard]] inline BitVector *getBits() const {
+    assert(isLarge());
+    BitVector *bits;
+    std::memcpy(&bits, ids, sizeof(bits));
+    return bits;
+  }
+
+  inline void setBits(BitVector *bits) {
+    static_assert(sizeof(bits) <= sizeof(ids), "the inline ids must be able to hold the bit vector pointer");
+    std::memcpy(ids, &bits, sizeof(bits));
+    size = LARGE;
+  }
+
+  inline void upgrade() {
+    auto bits = new BitVector();
+    for (uint32_t i = 0; i < size; i++) {
+      bits->set(ids[i]);
+    }
+    setBits(bits);
+  }
+
+ public:
+  // forward iterator over the ids in increasing order.
+  // the ids of a small set are copied into the iterator, so growing the set while iterating it is safe
+  class iterator {
+    const BitVector *bits = nullptr;
+    BitVector::iterator bitIt{};
+    NodeID ids[INLINE_CAPACITY] = {};
+    uint32_t pos = 0;
+    uint32_t size = 0;
+
+    friend class ConstraintEdgeSet;
+
+    [[nodiscard]] inline bool atEnd() const { return bits == nullptr ? pos == size : bitIt == bits->end(); }
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = NodeID;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const NodeID *;
+    using reference = const NodeID &;
+
+    iterator() = default;
+
+    inline NodeID operator*() const { return bits == nullptr ? ids[pos] : *bitIt; }
+
+    inline iterator &operator++() {
+      if (bits == nullptr) {
+        pos++;
+      } else {
+        ++bitIt;
+      }
+      return *this;
+    }
+
+    inline iterator operator++(int) {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    inline bool operator==(const iterator &rhs) const {
+      if (bits != nullptr && rhs.bits != nullptr) {
+        return bitIt == rhs.bitIt;
+      }
+      if (bits == nullptr && rhs.bits == nullptr && pos == rhs.pos) {
+        return true;
+      }
+      // the set changed its layout between creating the two iterators
+      return atEnd() && rhs.atEnd();
+    }
+
+    inline bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+  };
+
+  ConstraintEdgeSet() : ids{}, size(0) {}
+  ~ConstraintEdgeSet() { clear(); }
+
+  ConstraintEdgeSet(const ConstraintEdgeSet &) = delete;
+  ConstraintEdgeSet(ConstraintEdgeSet &&) = delete;
+  ConstraintEdgeSet &operator=(const ConstraintEdgeSet &) = delete;
+  ConstraintEdgeSet &operator=(ConstraintEdgeSet &&) = delete;
+
+  [[nodiscard]] inline bool empty() const { return size == 0; }
+
+  [[nodiscard]] inline bool test(NodeID id) const {
+    if (isLarge()) {
+      return getBits()->test(id);
+    }
+    return std::binary_search(ids, ids + size, id);
+  }
+
+  // insert the id, return true if it was not in the set before
+  inline bool test_and_set(NodeID id) {
+    if (isLarge()) {
+      return getBits()->test_and_set(id);
+    }
+
+    auto it = std::lower_bound(ids, ids + size, id);
+    if (it != ids + size && *it == id) {
+      return false;
+    }
+    if (size == INLINE_CAPACITY) {
+      upgrade();
+      getBits()->set(id);
+      return true;
+    }
+    std::copy_backward(it, ids + size, ids + size + 1);
+    *it = id;
+    size++;
+    return true;
+  }
+
+  inline void reset(NodeID id) {
+    if (isLarge()) {
+      auto bits = getBits();
+      bits->reset(id);
+      if (bits->empty()) {
+        clear();
+      }
+      return;
+    }
+
+    auto it = std::lower_bound(ids, ids + size, id);
+    if (it != ids + size && *it == id) {
+      std::copy(it + 1, ids + size, it);
+      size--;
+    }
+  }
+
+  inline void clear() {
+    if (isLarge()) {
+      delete getBits();
+    }
+    size = 0;
+  }
+
+  [[nodiscard]] inline iterator begin() const {
+    iterator it;
+    if (isLarge()) {
+      it.bits = getBits();
+      it.bitIt = it.bits->begin();
+    } else {
+      std::copy(ids, ids + size, it.ids);
+      it.size = size;
+    }
+    return it;
+  }
+
+  [[nodiscard]] inline iterator end() const {
+    iterator it;
+    if (isLarge()) {
+      it.bits = getBits();
+      it.bitIt = it.bits->end();
+    } else {
+      it.pos = size;
+      it.size = size;
+    }
+    return it;
+  }
+};
+
+}  // namespace pta
@@ -13,6 +13,8 @@ limitations under the License.
 
 #include <llvm/Support/CommandLine.h>
 
+#include <atomic>
+
 #include "CGObjNode.h"
 #include "CGPtrNode.h"
 #include "PointerAnalysis/Graph/GraphBase/GraphBase.h"
@@ -40,15 +42,57 @@ class ConstraintGraph : public GraphBase<CGNodeBase<ctx>, Constraints> {
     virtual void onNewConstraint(CGNodeTy *src, CGNodeTy *dst, Constraints constraint) = 0;
   };
 
+  // how long the super node chains are, see CGNodeBase::getSuperNode()
+  struct SuperNodeStats {
+    // number of nodes merged into a super node
+    uint64_t mergedNodes;
+    // sum over the merged nodes of the length of their super node chain without path compression
+    uint64_t linkedChainLength;
+    // number of lookups that had to walk the union-find forest and the number of hops they took
+    uint64_t lookups;
+    uint64_t lookupHops;
+
+    [[nodiscard]] double avgChainLengthWithoutCompression() const {
+      return mergedNodes == 0 ? 0.0 : static_cast<double>(linkedChainLength) / mergedNodes;
+    }
+
+    [[nodiscard]] double avgChainLengthWithCompression() const {
+      return lookups == 0 ? 0.0 : static_cast<double>(lookupHops) / lookups;
+    }
+  };
+
  private:
   OnNewConstraintCallBack *callBack;
   std::vector<CGNodeTy *> objVec;
 
+  // merges only happen in sequential phases, lookups may come from every solver thread
+  uint64_t mergedNodes = 0;
+  uint64_t linkedChainLength = 0;
+  std::atomic<uint64_t> superNodeLookups{0};
+  std::atomic<uint64_t> superNodeLookupHops{0};
+
+  inline void recordSuperNodeMerge(uint32_t mergedTreeSize) {
+    mergedNodes++;
+    linkedChainLength += mergedTreeSize;
+  }
+
+  inline void recordSuperNodeLookup(uint32_t hops) {
+    superNodeLookups.fetch_add(1, std::memory_order_relaxed);
+    superNodeLookupHops.fetch_add(hops, std::memory_order_relaxed);
+  }
+
+  friend CGNodeTy;
+
  public:
   inline void registerCallBack(OnNewConstraintCallBack *cb) { callBack = cb; }
 
   inline void unregisterCallBack() { callBack = nullptr; }
 
+  [[nodiscard]] inline SuperNodeStats getSuperNodeStats() const {
+    return {mergedNodes, linkedChainLength, superNodeLookups.load(std::memory_order_relaxed),
+            superNodeLookupHops.load(std::memory_order_relaxed)};
+  }
+
   //    inline CGNodeTy *operator[](NodeID id) const {
   //        return this->getNode(id);
   //    }
@@ -0,0 +1,320 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "ConstraintGraph.h"
+
+namespace pta {
+
+// A topological order of the super nodes in the copy graph that is kept up to date across solver rounds, so the
+// solver does not need to run a full SCC pass every round.
+//
+// Nodes added since the last update are ordered among themselves by Tarjan's algorithm and placed after all the
+// existing nodes. Every recorded copy edge that goes against the order is then fixed with Pearce and Kelly's dynamic
+// topological sort: only the nodes positioned between the two ends of the edge are searched, and if the edge closes
+// a cycle, the cycle is collapsed into one super node.
+template <typename ctx>
+class CopyGraphOrder {
+ public:
+  using CGNodeTy = CGNodeBase<ctx>;
+  using ConsGraphTy = ConstraintGraph<ctx>;
+
+  // the work done by update(), to see how much of the graph is re-traversed
+  struct Stats {
+    size_t addedNodes = 0;
+    size_t insertedEdges = 0;
+    // edges that went against the order
+    size_t reorderedEdges = 0;
+    // nodes searched to fix the order
+    size_t searchedNodes = 0;
+    size_t collapsedCycles = 0;
+
+    Stats &operator+=(const Stats &other) {
+      addedNodes += other.addedNodes;
+      insertedEdges += other.insertedEdges;
+      reorderedEdges += other.reorderedEdges;
+      searchedNodes += other.searchedNodes;
+      collapsedCycles += other.collapsedCycles;
+      return *this;
+    }
+  };
+
+ private:
+  static constexpr uint8_t FORWARD = 1;
+  static constexpr uint8_t BACKWARD = 2;
+
+  // the position of every super node in the order, indexed by node id. positions are unique but not dense
+  std::vector<uint32_t> position;
+  uint32_t nextPosition = 0;
+  // nodes [0, orderedNodes) have been added to the order
+  NodeID orderedNodes = 0;
+  std::vector<std::pair<NodeID, NodeID>> pendingEdges;
+  Stats stats;
+
+  // scratch space reused by every edge insertion
+  std::vector<uint8_t> marks;
+  std::vector<CGNodeTy *> forward;
+  std::vector<CGNodeTy *> backward;
+  std::vector<CGNodeTy *> stack;
+  std::vector<uint32_t> pool;
+
+  // order the new nodes [orderedNodes, graph.getNodeNum()) after all the existing ones
+  template <typename Collapse>
+  void addNewNodes(ConsGraphTy &graph, Collapse &collapse) {
+    constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+    const NodeID first = orderedNodes;
+    const NodeID last = graph.getNodeNum();
+    orderedNodes = last;
+    position.resize(last);
+    marks.resize(last, 0);
+
+    auto const isNew = [&](CGNodeTy *node) { return node->getNodeID() >= first; };
+
+    // iterative Tarjan restricted to the new nodes, SCCs come out in reverse topological order
+    std::vector<uint32_t> index(last - first, UNVISITED);
+    std::vector<uint32_t> lowLink(last - first, 0);
+    std::vector<bool> onStack(last - first, false);
+    std::vector<CGNodeTy *> sccStack;
+    std::vector<std::pair<CGNodeTy *, typename CGNodeTy::cg_iterator>> visitStack;
+    std::vector<std::vector<CGNodeTy *>> sccs;
+    uint32_t nextIndex = 0;
+
+    auto const visit = [&](CGNodeTy *node) {
+      index[node->getNodeID() - first] = lowLink[node->getNodeID() - first] = nextIndex++;
+      onStack[node->getNodeID() - first] = true;
+      sccStack.push_back(node);
+      visitStack.emplace_back(node, node->succ_copy_begin());
+    };
+
+    for (NodeID id = first; id < last; id++) {
+      CGNodeTy *root = graph.getNode(id);
+      if (root->hasSuperNode() || index[id - first] != UNVISITED) {
+        continue;
+      }
+      stats.addedNodes++;
+
+      visit(root);
+      while (!visitStack.empty()) {
+        auto &[node, it] = visitStack.back();
+        const NodeID slot = node->getNodeID() - first;
+        if (it != node->succ_copy_end()) {
+          CGNodeTy *succ = (*it)->getSuperNode();
+          ++it;
+          if (!isNew(succ) || succ == node) {
+            continue;
+          }
+          const NodeID succSlot = succ->getNodeID() - first;
+          if (index[succSlot] == UNVISITED) {
+            stats.addedNodes++;
+            visit(succ);
+          } else if (onStack[succSlot]) {
+            lowLink[slot] = std::min(lowLink[slot], index[succSlot]);
+          }
+          continue;
+        }
+
+        CGNodeTy *done = node;
+        visitStack.pop_back();
+        if (!visitStack.empty()) {
+          const NodeID parentSlot = visitStack.back().first->getNodeID() - first;
+          lowLink[parentSlot] = std::min(lowLink[parentSlot], lowLink[slot]);
+        }
+        if (lowLink[slot] == index[slot]) {
+          auto &scc = sccs.emplace_back();
+          do {
+            scc.push_back(sccStack.back());
+            onStack[sccStack.back()->getNodeID() - first] = false;
+            sccStack.pop_back();
+          } while (scc.back() != done);
+          // the root of the SCC becomes the super node
+          std::swap(scc.front(), scc.back());
+        }
+      }
+    }
+
+    // nodes are only collapsed after the DFS, collapsing changes the edge sets being iterated
+    for (auto it = sccs.rbegin(), ie = sccs.rend(); it != ie; ++it) {
+      if (it->size() > 1) {
+        collapse(*it);
+        stats.collapsedCycles++;
+      }
+      position[it->front()->getNodeID()] = nextPosition++;
+    }
+
+    // edges among the new nodes follow the order now, edges from old to new nodes always do.
+    // only the edges from new to old nodes may go against it
+    for (auto const &scc : sccs) {
+      CGNodeTy *node = scc.front();
+      for (auto it = node->succ_copy_begin(), ie = node->succ_copy_end(); it != ie; ++it) {
+        if (!isNew(*it)) {
+          pendingEdges.emplace_back(node->getNodeID(), (*it)->getNodeID());
+        }
+      }
+    }
+  }
+
+  // make the order agree with the copy edge src --> dst
+  template <typename Collapse>
+  void insertEdge(ConsGraphTy &graph, CGNodeTy *src, CGNodeTy *dst, Collapse &collapse) {
+    src = src->getSuperNode();
+    dst = dst->getSuperNode();
+    stats.insertedEdges++;
+    if (src == dst) {
+      return;
+    }
+
+    const uint32_t lowerBound = position[dst->getNodeID()];
+    const uint32_t upperBound = position[src->getNodeID()];
+    if (upperBound < lowerBound) {
+      return;
+    }
+    stats.reorderedEdges++;
+
+    // only the nodes positioned between dst and src are searched and reordered
+    auto const inWindow = [&](CGNodeTy *node) {
+      return position[node->getNodeID()] > lowerBound && position[node->getNodeID()] < upperBound;
+    };
+
+    // the nodes reachable from dst, src is only reached if the edge closes a cycle
+    bool isCycle = false;
+    forward.clear();
+    stack.assign(1, dst);
+    marks[dst->getNodeID()] |= FORWARD;
+    while (!stack.empty()) {
+      CGNodeTy *node = stack.back();
+      stack.pop_back();
+      forward.push_back(node);
+      for (auto it = node->succ_copy_begin(), ie = node->succ_copy_end(); it != ie; ++it) {
+        CGNodeTy *succ = (*it)->getSuperNode();
+        if (succ == src) {
+          isCycle = true;
+        } else if (inWindow(succ) && !(marks[succ->getNodeID()] & FORWARD)) {
+          marks[succ->getNodeID()] |= FORWARD;
+          stack.push_back(succ);
+        }
+      }
+    }
+
+    // the nodes that reach src
+    backward.clear();
+    stack.assign(1, src);
+    marks[src->getNodeID()] |= BACKWARD;
+    while (!stack.empty()) {
+      CGNodeTy *node = stack.back();
+      stack.pop_back();
+      backward.push_back(node);
+      for (auto it = node->pred_copy_begin(), ie = node->pred_copy_end(); it != ie; ++it) {
+        CGNodeTy *pred = (*it)->getSuperNode();
+        if (pred == dst) {
+          marks[dst->getNodeID()] |= BACKWARD;
+        } else if (inWindow(pred) && !(marks[pred->getNodeID()] & BACKWARD)) {
+          marks[pred->getNodeID()] |= BACKWARD;
+          stack.push_back(pred);
+        }
+      }
+    }
+    stats.searchedNodes += forward.size() + backward.size();
+
+    // the positions of the searched nodes are handed out again, the backward nodes take the lowest ones and the
+    // forward nodes the highest ones, so every node only moves away from the other side of the edge
+    pool.clear();
+    for (CGNodeTy *node : forward) {
+      pool.push_back(position[node->getNodeID()]);
+    }
+    for (CGNodeTy *node : backward) {
+      if (!(marks[node->getNodeID()] & FORWARD)) {
+        pool.push_back(position[node->getNodeID()]);
+      }
+    }
+    std::sort(pool.begin(), pool.end());
+
+    // a node found by both searches is on a path dst --> ... --> src, i.e., on a cycle closed by the edge
+    auto const onBothSides = [&](CGNodeTy *node) { return marks[node->getNodeID()] == (FORWARD | BACKWARD); };
+    isCycle |= (marks[dst->getNodeID()] & BACKWARD) || std::any_of(backward.begin(), backward.end(), onBothSides);
+    std::vector<CGNodeTy *> cycle;
+    if (isCycle) {
+      marks[src->getNodeID()] = marks[dst->getNodeID()] = FORWARD | BACKWARD;
+      std::copy_if(forward.begin(), forward.end(), std::back_inserter(cycle), onBothSides);
+      cycle.push_back(src);
+    }
+
+    auto const byPosition = [&](CGNodeTy *lhs, CGNodeTy *rhs) {
+      return position[lhs->getNodeID()] < position[rhs->getNodeID()];
+    };
+    for (auto nodes : {&forward, &backward}) {
+      nodes->erase(std::remove_if(nodes->begin(), nodes->end(), onBothSides), nodes->end());
+      for (CGNodeTy *node : *nodes) {
+        marks[node->getNodeID()] = 0;
+      }
+      std::sort(nodes->begin(), nodes->end(), byPosition);
+    }
+    for (CGNodeTy *node : cycle) {
+      marks[node->getNodeID()] = 0;
+    }
+
+    size_t next = 0;
+    for (CGNodeTy *node : backward) {
+      position[node->getNodeID()] = pool[next++];
+    }
+    if (!cycle.empty()) {
+      collapse(cycle);
+      stats.collapsedCycles++;
+      position[cycle.front()->getNodeID()] = pool[next++];
+    }
+    next = pool.size() - forward.size();
+    for (CGNodeTy *node : forward) {
+      position[node->getNodeID()] = pool[next++];
+    }
+  }
+
+ public:
+  // a copy edge added since the last update
+  inline void recordEdge(CGNodeTy *src, CGNodeTy *dst) { pendingEdges.emplace_back(src->getNodeID(), dst->getNodeID()); }
+
+  // Bring the order up to date with the nodes and the recorded copy edges added since the last update.
+  // collapse(const std::vector<CGNodeTy *> &cycle) must merge the cycle into cycle.front().
+  // Returns the work done by this update.
+  template <typename Collapse>
+  Stats update(ConsGraphTy &graph, Collapse collapse) {
+    const Stats before = stats;
+    if (orderedNodes < graph.getNodeNum()) {
+      addNewNodes(graph, collapse);
+    }
+
+    // edges recorded during the insertions below belong to the next update
+    auto edges = std::move(pendingEdges);
+    pendingEdges.clear();
+    for (auto [src, dst] : edges) {
+      insertEdge(graph, graph.getNode(src), graph.getNode(dst), collapse);
+    }
+
+    Stats delta;
+    delta.addedNodes = stats.addedNodes - before.addedNodes;
+    delta.insertedEdges = stats.insertedEdges - before.insertedEdges;
+    delta.reorderedEdges = stats.reorderedEdges - before.reorderedEdges;
+    delta.searchedNodes = stats.searchedNodes - before.searchedNodes;
+    delta.collapsedCycles = stats.collapsedCycles - before.collapsedCycles;
+    return delta;
+  }
+
+  // the position of a super node, a node is positioned before every copy successor
+  [[nodiscard]] inline uint32_t getPosition(const CGNodeTy *node) const { return position[node->getNodeID()]; }
+
+  [[nodiscard]] inline const Stats &getStats() const { return stats; }
+};
+
+}  // namespace pta
@@ -0,0 +1,163 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/Hashing.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ConstraintGraph.h"
+#include "SCCIterator.h"
+
+namespace pta {
+
+// Offline variable substitution by hash-based value numbering (HVN).
+//
+// Before solving, every pointer node gets a label such that nodes with the same label are guaranteed to end up with
+// the same points-to set. The label of a node is computed from the labels of its copy predecessors in topological
+// order: a node with a single labelled predecessor inherits its label (copy chains from bitcasts, PHIs, ...), a node
+// whose predecessors have the same set of labels as another node shares the label of that node. Nodes that can gain
+// points-to targets in other ways (load/offset/special targets, or nodes the caller says may get new constraints
+// while solving) get a label of their own.
+// Pointer nodes with the same label are then collapsed into a super node, just like a copy cycle.
+template <typename ctx, typename PT>
+class PointerEquivalence {
+ public:
+  using CGNodeTy = CGNodeBase<ctx>;
+  using ConsGraphTy = ConstraintGraph<ctx>;
+
+  struct Stats {
+    size_t mergedNodes = 0;
+    size_t removedEdges = 0;
+  };
+
+ private:
+  // the label of nodes whose points-to set is empty in every solution
+  static constexpr uint32_t EMPTY_LABEL = 0;
+
+  struct LabelsHash {
+    size_t operator()(const std::vector<uint32_t> &labels) const {
+      return llvm::hash_combine_range(labels.begin(), labels.end());
+    }
+  };
+
+  ConsGraphTy &graph;
+  std::vector<uint32_t> labels;
+  std::vector<bool> labelled;
+  uint32_t nextLabel = EMPTY_LABEL + 1;
+  // the sorted labels of the predecessors ==> the label of the node
+  std::unordered_map<std::vector<uint32_t>, uint32_t, LabelsHash> labelOfPreds;
+
+  // nodes that can be collapsed into a super node, collapseSCCTo does not merge the points-to sets
+  static bool isMergeable(CGNodeTy *node) {
+    if (node->isSpecialNode() || node->hasSuperNode() || !PT::isEmpty(node->getNodeID())) return false;
+    // anonymous nodes are referred to by the id of their object
+    auto ptrNode = llvm::dyn_cast<CGPtrNode<ctx>>(node);
+    return ptrNode != nullptr && !ptrNode->isAnonNode();
+  }
+
+  // whether the copy edges are the only way the node can get points-to targets
+  static bool onlyCopyTargets(CGNodeTy *node) {
+    return node->pred_load_begin() == node->pred_load_end() && node->pred_offset_begin() == node->pred_offset_end() &&
+           node->pred_special_begin() == node->pred_special_end();
+  }
+
+  static size_t countEdges(ConsGraphTy &graph) {
+    size_t edges = 0;
+    for (NodeID id = 0; id < graph.getNodeNum(); id++) {
+      auto node = graph.getNode(id);
+      edges += std::distance(node->succ_edge_begin(), node->succ_edge_end());
+    }
+    return edges;
+  }
+
+  explicit PointerEquivalence(ConsGraphTy &graph)
+      : graph(graph), labels(graph.getNodeNum(), EMPTY_LABEL), labelled(graph.getNodeNum(), false) {}
+
+  template <typename IsClosed>
+  uint32_t labelSCC(const std::vector<CGNodeTy *> &scc, IsClosed &isClosed) {
+    for (auto node : scc) {
+      if (!isMergeable(node) || !onlyCopyTargets(node) || !isClosed(node)) {
+        return nextLabel++;
+      }
+    }
+
+    std::vector<uint32_t> predLabels;
+    for (auto node : scc) {
+      for (auto it = node->pred_copy_begin(), ie = node->pred_copy_end(); it != ie; it++) {
+        auto const predID = (*it)->getNodeID();
+        // predecessors outside of the scc are labelled before the scc
+        if (labelled[predID] && labels[predID] != EMPTY_LABEL) {
+          predLabels.push_back(labels[predID]);
+        }
+      }
+    }
+    std::sort(predLabels.begin(), predLabels.end());
+    predLabels.erase(std::unique(predLabels.begin(), predLabels.end()), predLabels.end());
+
+    if (predLabels.empty()) return EMPTY_LABEL;
+    if (predLabels.size() == 1) return predLabels.front();
+
+    auto result = labelOfPreds.try_emplace(std::move(predLabels), nextLabel);
+    if (result.second) {
+      nextLabel++;
+    }
+    return result.first->second;
+  }
+
+  template <typename IsClosed>
+  Stats reduce(IsClosed &isClosed) {
+    auto const edgesBefore = countEdges(graph);
+
+    // the pointer nodes of every label
+    std::map<uint32_t, std::vector<CGNodeTy *>> groups;
+    // DFS on the predecessors, so every scc comes after the sccs of its predecessors
+    llvm::BitVector allNodes(graph.getNodeNum(), false);
+    for (auto it = scc_begin<ctx, Constraints::copy, true>(graph, allNodes),
+              ie = scc_end<ctx, Constraints::copy, true>(graph, allNodes);
+         it != ie; ++it) {
+      const std::vector<CGNodeTy *> &scc = *it;
+      auto const label = labelSCC(scc, isClosed);
+      for (auto node : scc) {
+        labels[node->getNodeID()] = label;
+        labelled[node->getNodeID()] = true;
+        if (label != EMPTY_LABEL && isMergeable(node)) {
+          groups[label].push_back(node);
+        }
+      }
+    }
+
+    Stats stats;
+    for (auto &[label, nodes] : groups) {
+      if (nodes.size() > 1) {
+        graph.collapseSCCTo(nodes, nodes.front());
+        stats.mergedNodes += nodes.size() - 1;
+      }
+    }
+    stats.removedEdges = edgesBefore - countEdges(graph);
+    return stats;
+  }
+
+ public:
+  // Collapse the pointer nodes that provably have identical points-to sets.
+  // isClosed(node) returns false for the nodes that can get new incoming constraints or points-to targets while
+  // solving, they will only be merged with nodes that copy everything from them.
+  template <typename IsClosed>
+  static Stats run(ConsGraphTy &graph, IsClosed isClosed) {
+    PointerEquivalence<ctx, PT> hvn(graph);
+    return hvn.reduce(isClosed);
+  }
+};
+
+}  // namespace pta
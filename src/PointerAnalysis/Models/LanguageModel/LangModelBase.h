@@ -166,8 +166,9 @@ struct LangModelTrait<LangModelBase<ctx, MemModel, PtsTy, SubClass>> {
   using ObjectTy = typename MMT::ObjectTy;
 
   // build initial langModel from a llvm module
-  static inline LangModelTy *buildInitModel(llvm::Module *M, llvm::StringRef entry) {
-    return new LangModelTy(M, entry);
+  template <typename... Args>
+  static inline LangModelTy *buildInitModel(llvm::Module *M, llvm::StringRef entry, Args &&...args) {
+    return new LangModelTy(M, entry, std::forward<Args>(args)...);
   }
 
   static inline void addPreProcessingPass(llvm::legacy::PassManagerBase &passes) { MMT::addPreProcessingPass(passes); }
@@ -187,6 +188,9 @@ struct LangModelTrait<LangModelBase<ctx, MemModel, PtsTy, SubClass>> {
   // get constructed call callgraph
   static inline const CallGraphTy *getCallGraph(LangModelTy *model) { return model->getCallGraph(); }
 
+  // get the memory model that allocates the objects
+  static inline MemModelTy &getMemModel(LangModelTy *model) { return model->getMemModel(); }
+
   // true if at least one indirect call site is updated.
   static inline bool updateFunPtrs(LangModelTy *model, const llvm::SparseBitVector<> &resolved) {
     return model->updateFunPtrs(resolved);
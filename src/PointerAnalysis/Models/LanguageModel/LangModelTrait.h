@@ -44,9 +44,9 @@ struct LangModelTrait {
   // set analysis usage
   // static void getAnalysisUsage(AnalysisUsage &AU);
 
-  // build initial langModel from a llvm module
+  // build initial langModel from a llvm module, args are model specific options
   // static inline LangModelTy *buildInitModel(llvm::Module *M, StringRef
-  // entry)
+  // entry, Args &&...args)
 
   // get constructed call callgraph
   // static inline ConsGraphTy *getConsGraph(LangModelTy *langModel);
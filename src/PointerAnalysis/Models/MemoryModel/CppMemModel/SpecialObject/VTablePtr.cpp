@@ -18,16 +18,18 @@ using namespace llvm;
 namespace pta {
 
 bool isVTablePtrType(const llvm::Type *type) {
-  static Type *vtableType = nullptr;
-
-  if (vtableType == nullptr) {
-    // vtable type i32 (...)**
-    auto &C = type->getContext();
-    auto elemTy = FunctionType::get(IntegerType::get(C, 32), true);
-    vtableType = PointerType::get(PointerType::get(elemTy, 0), 0);
+  // vtable type i32 (...)**
+  // checked structurally, types belong to an LLVMContext and the modules analyzed may be in different ones
+  if (!type->isPointerTy() || type->getPointerAddressSpace() != 0) {
+    return false;
   }
-
-  return type == vtableType;
+  auto const elemPtrTy = type->getPointerElementType();
+  if (!elemPtrTy->isPointerTy() || elemPtrTy->getPointerAddressSpace() != 0) {
+    return false;
+  }
+  auto const elemTy = llvm::dyn_cast<FunctionType>(elemPtrTy->getPointerElementType());
+  return elemTy != nullptr && elemTy->isVarArg() && elemTy->getNumParams() == 0 &&
+         elemTy->getReturnType()->isIntegerTy(32);
 }
 
 }  // namespace pta
\ No newline at end of file
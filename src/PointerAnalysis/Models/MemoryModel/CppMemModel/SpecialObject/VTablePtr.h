@@ -48,7 +48,8 @@ class VTablePtr : public FSObject<ctx> {
     objType = stripArray(objType);
     // resolve the type metadata
     auto structType = llvm::cast<StructType>(objType);
-    const DICompositeType *typeMD = getTypeMetaData(block->getValue(), block->getAllocKind(), structType);
+    const DICompositeType *typeMD =
+        getTypeMetaData(block->getLLVMModule(), block->getValue(), block->getAllocKind(), structType);
 
     if (typeMD != nullptr) {
       SmallVector<const DIType *, 8> vptrPath;
@@ -156,6 +156,10 @@ class FIMemModel : public SingleInstanceOwner<FIObject<ctx>> {
       // gNode, Constraints::addr_of);
     }
   }
+
+  // every object is already field-insensitive and anonymous objects are never created recursively
+  inline constexpr bool useFieldInsensitiveObjects() const { return false; }
+  inline constexpr bool capAnonObjects() const { return false; }
 };
 
 template <typename ctx>
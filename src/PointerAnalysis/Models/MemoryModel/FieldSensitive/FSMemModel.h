@@ -21,6 +21,7 @@ limitations under the License.
 #include "PointerAnalysis/Models/MemoryModel/FieldSensitive/FSObject.h"
 #include "PointerAnalysis/Models/MemoryModel/FieldSensitive/Layout/MemLayoutManager.h"
 #include "PointerAnalysis/Models/MemoryModel/FieldSensitive/MemBlock.h"
+#include "PointerAnalysis/Util/TypeMetaData.h"
 #include "PointerAnalysis/Util/Util.h"
 
 extern cl::opt<bool> CONFIG_USE_FI_MODE;
@@ -137,7 +138,7 @@ class FSMemModel {
   template <typename PT>
   ObjNode *allocValueWithType(const ctx *C, const llvm::Value *V, AllocKind T, llvm::Type *type,
                               const llvm::DataLayout &DL) {
-    if (CONFIG_USE_FI_MODE) {
+    if (CONFIG_USE_FI_MODE || fiObjects) {
       return allocFIObject<PT>(C, V, T);
     }
 
@@ -186,7 +187,9 @@ class FSMemModel {
   using Canonicalizer = FSCanonicalizer;
 
   FSMemModel(ConsGraphTy &consGraph, PtrManager &owner, llvm::Module &M, MemModelKind kind = MemModelKind::FS)
-      : kind(kind), ptrManager(owner), consGraph(consGraph), module(M) {}
+      : kind(kind), ptrManager(owner), consGraph(consGraph), module(M) {
+    TypeMDinit(&M);
+  }
 
  protected:
   template <typename PT>
@@ -342,6 +345,11 @@ class FSMemModel {
   }
 
   unsigned int allocatedCount;
+  // the upperbound of allocatedCount, 0 means unlimited
+  unsigned int anonRecLimit = ANON_REC_LIMIT;
+  // allocate every new object field-insensitively, set when the analysis runs out of budget
+  bool fiObjects = false;
+
   template <typename PT>
   ObjNode *allocAnonObjRec(const ctx *C, const llvm::DataLayout &DL, llvm::Type *T, const llvm::Value *tag,
                            std::vector<const llvm::Type *> &typeTree) {
@@ -351,7 +359,7 @@ class FSMemModel {
     }
 
     if (std::find(typeTree.begin(), typeTree.end(), T) != typeTree.end() || T == nullptr ||
-        (ANON_REC_LIMIT && allocatedCount > ANON_REC_LIMIT)) {
+        (anonRecLimit && allocatedCount > anonRecLimit)) {
       // recursive type
       // i.e., link_list {link_list *next};
       return nullptr;
@@ -601,6 +609,26 @@ class FSMemModel {
     return {F, InterceptResult::Option::EXPAND_BODY};
   }
 
+  // allocate the objects created from now on as one field-insensitive object,
+  // returns false if they already are
+  bool useFieldInsensitiveObjects() {
+    if (CONFIG_USE_FI_MODE || fiObjects) {
+      return false;
+    }
+    fiObjects = true;
+    return true;
+  }
+
+  // create anonymous objects recursively as if ANON_REC_LIMIT=1 from now on,
+  // returns false if the limit is already that low
+  bool capAnonObjects() {
+    if (anonRecLimit == 1) {
+      return false;
+    }
+    anonRecLimit = 1;
+    return true;
+  }
+
   // return *true* when the callsite handled by the
   template <typename PT>
   inline constexpr bool interceptCallSite(const CtxFunction<CtxTy> * /* caller */,
@@ -194,6 +194,10 @@ struct MemModelHelper {
                                                   const llvm::Instruction *callSite) {
     return memModel.interceptFunction(F, callSite);
   }
+
+  // give up precision on the objects allocated from now on, return false if there is nothing left to give up
+  inline static bool useFieldInsensitiveObjects(MemModel &memModel) { return memModel.useFieldInsensitiveObjects(); }
+  inline static bool capAnonObjects(MemModel &memModel) { return memModel.capAnonObjects(); }
 };
 
 }  // namespace pta
@@ -31,8 +31,7 @@ class PointerAnalysisPass : public llvm::ImmutablePass {
         return;
       }
     }
-    // release previous context
-    Solver::CT::release();
+    // the contexts and points-to sets of the previous solver are released with it
     solver.reset(new Solver());
     // auto start = std::chrono::steady_clock::now();
     solver->analyze(M, entry);
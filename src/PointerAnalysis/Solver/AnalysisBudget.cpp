@@ -0,0 +1,56 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Solver/AnalysisBudget.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <fstream>
+
+using namespace pta;
+
+size_t AnalysisBudget::getCurrentRSSMB() {
+  // the second field of statm is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t residentPages = 0;
+  if (statm >> pages >> residentPages) {
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+  }
+
+  // no procfs, fall back to the peak RSS (in KB on Linux, in bytes on macOS)
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024 * 1024);
+#else
+  return usage.ru_maxrss / 1024;
+#endif
+}
+
+std::string AnalysisBudget::checkTimeExceeded() const {
+  if (timeLimit != 0) {
+    auto const elapsed = getElapsedSeconds();
+    if (elapsed > timeLimit) {
+      return "time budget exceeded (" + std::to_string(static_cast<size_t>(elapsed)) + "s > " +
+             std::to_string(timeLimit) + "s)";
+    }
+  }
+  return "";
+}
+
+std::string AnalysisBudget::checkMemoryExceeded(size_t rssMB) const {
+  if (memoryLimit != 0 && rssMB > memoryLimit) {
+    return "memory budget exceeded (" + std::to_string(rssMB) + "MB > " + std::to_string(memoryLimit) + "MB)";
+  }
+  return "";
+}
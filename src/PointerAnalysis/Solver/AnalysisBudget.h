@@ -0,0 +1,48 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace pta {
+
+// The wall-clock time and memory a pointer analysis run may use, 0 means unlimited.
+// The clock starts when the budget is created.
+class AnalysisBudget {
+  std::chrono::steady_clock::time_point start;
+  unsigned timeLimit;    // seconds
+  unsigned memoryLimit;  // MB
+
+ public:
+  AnalysisBudget(unsigned timeLimitSeconds, unsigned memoryLimitMB)
+      : start(std::chrono::steady_clock::now()), timeLimit(timeLimitSeconds), memoryLimit(memoryLimitMB) {}
+
+  [[nodiscard]] bool isLimited() const { return timeLimit != 0 || memoryLimit != 0; }
+  [[nodiscard]] bool isMemoryLimited() const { return memoryLimit != 0; }
+
+  [[nodiscard]] double getElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // By how much the time budget is exceeded (e.g. "time budget exceeded (65s > 60s)"), empty if within budget
+  [[nodiscard]] std::string checkTimeExceeded() const;
+
+  // By how much rssMB exceeds the memory budget (e.g. "memory budget exceeded (2100MB > 2048MB)"),
+  // empty if within budget
+  [[nodiscard]] std::string checkMemoryExceeded(size_t rssMB) const;
+
+  // resident set size of the whole process in MB
+  [[nodiscard]] static size_t getCurrentRSSMB();
+};
+
+}  // namespace pta
@@ -88,7 +88,7 @@ class AndersenWave : public SolverBase<LangModel, AndersenWave<LangModel>> {
           changed |= super::processOffset(curNode, *it);
         }
       }
-    } while (changed);
+    } while (changed && !super::checkBudget());
   }
 
   friend super;
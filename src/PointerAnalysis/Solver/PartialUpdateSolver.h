@@ -11,13 +11,18 @@ limitations under the License.
 
 #pragma once
 
-#include <stack>
+#include <llvm/ADT/DenseSet.h>
 
-#include "PointerAnalysis/Graph/ConstraintGraph/SCCIterator.h"
+#include <limits>
+#include <queue>
+
+#include "PointerAnalysis/Graph/ConstraintGraph/CopyGraphOrder.h"
+#include "PointerAnalysis/Graph/ConstraintGraph/PointerEquivalence.h"
 #include "SolverBase.h"
+#include "Util/WorkStealingPool.h"
 
-//#define HASH_EDGE_LIMIT 6700417 // a large enough prime number
-#define HASH_EDGE_LIMIT 1000032953
+extern llvm::cl::opt<unsigned> ConfigPTAJobs;
+extern llvm::cl::opt<bool> ConfigPTAOfflineHVN;
 
 namespace pta {
 // just experimental feature for now.
@@ -42,6 +47,14 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
   using CallGraphTy = typename super::CallGraphTy;  // call graph type
   using ConsGraphTy = typename super::ConsGraphTy;  // constraint graph type
 
+  // the work done by one round of the solver
+  struct RoundStats {
+    size_t nodes;
+    // nodes visited when propagating along copy edges
+    size_t visitedNodes;
+    typename CopyGraphOrder<ctx>::Stats order;
+  };
+
  private:
   class CallBack : public ConsGraphTy::OnNewConstraintCallBack {
     size_t nodeNum;
@@ -105,11 +118,12 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
     }
 
     // we need to handle the copy edge
-    requiredEdge.set(hashEdge(src, dst));
+    requiredEdge.insert(edgeKey(src, dst));
+    copyOrder.recordEdge(src, dst);
   }
 
-  // seems like the scc becomes the bottleneck, need to merge large scc
-  void processCopySCC(const std::vector<CGNodeTy *> &scc) {
+  // merge the pts and the edges of the scc into its front node, return the front node
+  CGNodeTy *collapseCopySCC(const std::vector<CGNodeTy *> &scc) {
     assert(scc.size() > 1);
 
     CGNodeTy *superNode = scc.front();
@@ -123,11 +137,12 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
       super::processCopy(*nit, superNode);
       // clear the points-to set after it is merged into the super node
       PT::clear((*nit)->getNodeID());
+      super::mergePropagated((*nit)->getNodeID(), superNode->getNodeID());
     }
 
     lsWorkList.reset(superNode->getNodeID());
 
-    // changedCopy.set(hashEdge(superNode, superNode));
+    // changedCopy.set(edgeKey(superNode, superNode));
 
     // collapse scc to the front node
     super::getConsGraph()->collapseSCCTo(scc, superNode);
@@ -136,49 +151,344 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
     if (superNode->isFunctionPtr()) {
       this->updateFunPtr(superNode->getNodeID());
     }
+    return superNode;
+  }
+
+  // the super nodes whose pts may have to be pushed along their copy edges in this round:
+  // the sources of new copy edges, the new nodes and the super nodes collapsed in this round
+  std::vector<CGNodeTy *> getCopySeeds() {
+    ConsGraphTy &consGraph = *(super::getConsGraph());
+    std::vector<CGNodeTy *> seeds;
+    for (int id = copyWorkList.find_first_unset(); id >= 0; id = copyWorkList.find_next_unset(id)) {
+      seeds.push_back(consGraph.getNode(id)->getSuperNode());
+    }
+    for (int id = collapsed.find_first(); id >= 0; id = collapsed.find_next(id)) {
+      seeds.push_back(consGraph.getNode(id)->getSuperNode());
+    }
+    return seeds;
+  }
+
+  // propagate pts along copy edges in topological order, only the nodes whose pts changed are visited.
+  // returns the number of visited nodes
+  size_t propagateCopy() {
+    ConsGraphTy &consGraph = *(super::getConsGraph());
+    // (position, node id), the node with the lowest position first
+    using QueueEntry = std::pair<uint32_t, NodeID>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    llvm::BitVector queued(consGraph.getNodeNum());
+    auto const enqueue = [&](CGNodeTy *node) {
+      if (!queued.test(node->getNodeID())) {
+        queued.set(node->getNodeID());
+        queue.emplace(copyOrder.getPosition(node), node->getNodeID());
+      }
+    };
+    for (CGNodeTy *seed : getCopySeeds()) {
+      enqueue(seed);
+    }
+
+    size_t visited = 0;
+    while (!queue.empty()) {
+      CGNodeTy *curNode = consGraph.getNode(queue.top().second);
+      queue.pop();
+      visited++;
+
+      // a super node collapsed in this round pushes its whole pts to all successors
+      bool wholePts = collapsed.test(curNode->getNodeID());
+      // the pts of a node that is not in lsWorkList is unchanged since the last round,
+      // so only newly added copy edges need to be processed
+      bool srcChanged = !lsWorkList.test(curNode->getNodeID());
+      // the objects that are not pushed along the existing copy edges yet
+      const PtsTy diffPts = srcChanged && !wholePts ? super::getDiffPts(curNode->getNodeID()) : PtsTy();
+      for (auto cit = curNode->succ_copy_begin(), cie = curNode->succ_copy_end(); cit != cie; cit++) {
+        // same as propagateCopyInWaves, push to the super node of a collapsed successor
+        CGNodeTy *succ = (*cit)->getSuperNode();
+        if (succ == curNode) {
+          continue;
+        }
+        bool changed = false;
+        if (wholePts || isRequiredCopy(curNode, succ)) {
+          changed = super::processCopy(curNode, succ);
+        } else if (srcChanged) {
+          changed = super::processCopy(curNode, succ, diffPts);
+        }
+        if (changed) {
+          lsWorkList.reset(succ->getNodeID());
+          enqueue(succ);
+        }
+      }
+    }
+    return visited;
+  }
+
+  // handle load/store/special/offset constraints of every node whose pts changed in this round
+  void processComplex() {
+    ConsGraphTy &consGraph = *(super::getConsGraph());
+    int _lastID = lsWorkList.find_first_unset();
+    while (_lastID >= 0) {
+      unsigned int lastID = static_cast<unsigned int>(_lastID);
+
+      CGNodeTy *curNode = consGraph.getNode(lastID);
+      // only the objects added since the node was last visited need to be pushed along load/store/offset edges,
+      // the rest has been handled already (new edges from old nodes are handled as they are added, see CallBack)
+      const PtsTy diffPts = super::getDiffPts(lastID);
+
+      for (auto it = curNode->pred_store_begin(), ie = curNode->pred_store_end(); it != ie; it++) {
+        super::processStore(*it, curNode, diffPts,
+                            [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
+      }
+
+      for (auto it = curNode->succ_load_begin(), ie = curNode->succ_load_end(); it != ie; it++) {
+        super::processLoad(curNode, *it, diffPts, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
+      }
+
+      // to handled special constraints
+      for (auto it = curNode->succ_special_begin(), ie = curNode->succ_special_end(); it != ie; it++) {
+        super::processSpecial(curNode, *it, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
+      }
+
+#ifndef NO_ADDR_OF_FOR_OFFSET
+      for (auto it = curNode->succ_offset_begin(), ie = curNode->succ_offset_end(); it != ie; it++) {
+        super::processOffset(curNode, *it, diffPts, [&](CGNodeTy *fieldObj, CGNodeTy *ptr) {
+          auto addrNode = llvm::cast<ObjNodeTy>(fieldObj)->getAddrTakenNode();
+          recordCopyEdge(addrNode, ptr);
+        });
+      }
+#endif
+      super::markPropagated(lastID, diffPts);
+      _lastID = lsWorkList.find_next_unset(lastID);
+    }
+  }
 
-    for (auto cit = superNode->succ_copy_begin(), cie = superNode->succ_copy_end(); cit != cie; cit++) {
-      if (super::processCopy(superNode, *cit)) {
-        // the copy edge changed the pts of src
-        // changedCopy.set(hashEdge(superNode, *cit));
+  // Parallel version of propagateCopy.
+  // The nodes reachable from the seeds are split into waves by their depth in the (acyclic) copy graph.
+  // Nodes in the same wave do not depend on each other, so each wave is solved in parallel with every node pulling
+  // from its predecessors. Only the worker of a node writes its pts, the shared worklists are updated between waves.
+  // returns the number of visited nodes
+  size_t propagateCopyInWaves() {
+    ConsGraphTy &consGraph = *(super::getConsGraph());
+    constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
 
-        lsWorkList.reset((*cit)->getNodeID());
+    // the buffers indexed by node id are kept between rounds and only grow with the graph
+    if (waveSlot.size() < consGraph.getNodeNum()) {
+      waveSlot.resize(consGraph.getNodeNum(), UNVISITED);
+      waveReached.resize(consGraph.getNodeNum());
+    }
+    auto &slot = waveSlot;
+    auto &reached = waveReached;
+
+    // nodes visited in this round in topological order
+    std::vector<CGNodeTy *> order;
+    std::vector<CGNodeTy *> stack;
+    for (CGNodeTy *seed : getCopySeeds()) {
+      if (!reached.test(seed->getNodeID())) {
+        reached.set(seed->getNodeID());
+        stack.push_back(seed);
       }
     }
+    while (!stack.empty()) {
+      CGNodeTy *curNode = stack.back();
+      stack.pop_back();
+      order.push_back(curNode);
+      for (auto cit = curNode->succ_copy_begin(), cie = curNode->succ_copy_end(); cit != cie; cit++) {
+        CGNodeTy *succ = (*cit)->getSuperNode();
+        if (!reached.test(succ->getNodeID())) {
+          reached.set(succ->getNodeID());
+          stack.push_back(succ);
+        }
+      }
+    }
+    std::sort(order.begin(), order.end(), [&](CGNodeTy *lhs, CGNodeTy *rhs) {
+      return copyOrder.getPosition(lhs) < copyOrder.getPosition(rhs);
+    });
+
+    // slot of every visited node in order, and the depth of the node among the visited nodes
+    std::vector<uint32_t> depth(order.size(), 0);
+    std::vector<std::vector<CGNodeTy *>> waves;
+    for (uint32_t i = 0; i < order.size(); i++) {
+      CGNodeTy *curNode = order[i];
+      slot[curNode->getNodeID()] = i;
+      for (auto pit = curNode->pred_copy_begin(), pie = curNode->pred_copy_end(); pit != pie; pit++) {
+        auto const predSlot = slot[(*pit)->getSuperNode()->getNodeID()];
+        if (predSlot != UNVISITED && predSlot != i) {
+          depth[i] = std::max(depth[i], depth[predSlot] + 1);
+        }
+      }
+      if (depth[i] >= waves.size()) {
+        waves.resize(depth[i] + 1);
+      }
+      waves[depth[i]].push_back(curNode);
+    }
+
+    // what a visited node pushes along its existing copy edges, filled in once its wave is done
+    std::vector<PtsTy> diffPts(order.size());
+    std::vector<bool> srcChanged(order.size(), false);
+    for (const auto &wave : waves) {
+      std::vector<char> changed(wave.size(), false);
+      super::parallelFor(jobs, wave.size(), [&](size_t /* worker */, size_t i) {
+        CGNodeTy *dst = wave[i];
+        for (auto pit = dst->pred_copy_begin(), pie = dst->pred_copy_end(); pit != pie; pit++) {
+          CGNodeTy *src = (*pit)->getSuperNode();
+          auto const srcSlot = slot[src->getNodeID()];
+          if (srcSlot == UNVISITED || src == dst) {
+            // unchanged, and not the source of any new copy edge
+            continue;
+          }
+          if (collapsed.test(src->getNodeID()) || isRequiredCopy(src, dst)) {
+            changed[i] |= PT::unionWith(dst->getNodeID(), src->getNodeID());
+          } else if (srcChanged[srcSlot]) {
+            changed[i] |= PT::unionWithPts(dst->getNodeID(), diffPts[srcSlot]);
+          }
+        }
+      });
+
+      for (size_t i = 0; i < wave.size(); i++) {
+        if (changed[i]) {
+          lsWorkList.reset(wave[i]->getNodeID());
+          if (wave[i]->isFunctionPtr()) {
+            this->updateFunPtr(wave[i]->getNodeID());
+          }
+        }
+      }
+
+      // the pts of every node in the wave is final for this round
+      super::parallelFor(jobs, wave.size(), [&](size_t /* worker */, size_t i) {
+        auto const id = wave[i]->getNodeID();
+        if (!lsWorkList.test(id)) {
+          diffPts[slot[id]] = super::getDiffPts(id);
+        }
+      });
+      for (CGNodeTy *node : wave) {
+        srcChanged[slot[node->getNodeID()]] = !lsWorkList.test(node->getNodeID());
+      }
+    }
+
+    // only the visited nodes were touched, so resetting them is enough for the next round
+    for (CGNodeTy *node : order) {
+      slot[node->getNodeID()] = UNVISITED;
+      reached.reset(node->getNodeID());
+    }
+    return order.size();
+  }
+
+  // Parallel version of processComplex.
+  // Workers only collect the copy edges implied by load/store constraints into per-worker buffers,
+  // the edges are then added to the constraint graph sequentially. Special and offset constraints can create new
+  // nodes, so they are still handled sequentially.
+  void processComplexInParallel() {
+    ConsGraphTy &consGraph = *(super::getConsGraph());
+
+    std::vector<NodeID> pending;
+    for (int id = lsWorkList.find_first_unset(); id >= 0; id = lsWorkList.find_next_unset(id)) {
+      pending.push_back(static_cast<NodeID>(id));
+    }
+
+    std::vector<PtsTy> diffPts(pending.size());
+    std::vector<std::vector<std::pair<CGNodeTy *, CGNodeTy *>>> newEdges(race::resolveJobs(jobs));
+    super::parallelFor(jobs, pending.size(), [&](size_t worker, size_t i) {
+      CGNodeTy *curNode = consGraph.getNode(pending[i]);
+      diffPts[i] = super::getDiffPts(pending[i]);
+      auto &edges = newEdges[worker];
+
+      for (auto obj : diffPts[i]) {
+        CGNodeTy *objNode = consGraph.getObjectNode(obj)->getSuperNode();
+        // src --STORE--> curNode
+        for (auto it = curNode->pred_store_begin(), ie = curNode->pred_store_end(); it != ie; it++) {
+          edges.emplace_back(*it, objNode);
+        }
+        // curNode --LOAD--> dst
+        for (auto it = curNode->succ_load_begin(), ie = curNode->succ_load_end(); it != ie; it++) {
+          edges.emplace_back(objNode, *it);
+        }
+      }
+    });
+
+    // which worker collects an edge depends on scheduling, so the edges are added sorted by node ids to get the same
+    // constraint graph (and the same edge order in it) on every run
+    std::vector<std::pair<CGNodeTy *, CGNodeTy *>> allEdges;
+    for (auto &edges : newEdges) {
+      allEdges.insert(allEdges.end(), edges.begin(), edges.end());
+      edges = {};
+    }
+    std::sort(allEdges.begin(), allEdges.end(), [](const auto &lhs, const auto &rhs) {
+      return edgeKey(lhs.first, lhs.second) < edgeKey(rhs.first, rhs.second);
+    });
+    allEdges.erase(std::unique(allEdges.begin(), allEdges.end()), allEdges.end());
+    for (auto [src, dst] : allEdges) {
+      if (consGraph.addConstraints(src, dst, Constraints::copy)) {
+        recordCopyEdge(src, dst);
+      }
+    }
+
+    for (size_t i = 0; i < pending.size(); i++) {
+      CGNodeTy *curNode = consGraph.getNode(pending[i]);
+      for (auto it = curNode->succ_special_begin(), ie = curNode->succ_special_end(); it != ie; it++) {
+        super::processSpecial(curNode, *it, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
+      }
+
+#ifndef NO_ADDR_OF_FOR_OFFSET
+      for (auto it = curNode->succ_offset_begin(), ie = curNode->succ_offset_end(); it != ie; it++) {
+        super::processOffset(curNode, *it, diffPts[i], [&](CGNodeTy *fieldObj, CGNodeTy *ptr) {
+          auto addrNode = llvm::cast<ObjNodeTy>(fieldObj)->getAddrTakenNode();
+          recordCopyEdge(addrNode, ptr);
+        });
+      }
+#endif
+      super::markPropagated(pending[i], diffPts[i]);
+    }
   }
 
   // copy worklist
   llvm::BitVector copyWorkList;
   // load/store/offset worklist
   llvm::BitVector lsWorkList;
+  // the super nodes collapsed in the current round
+  llvm::BitVector collapsed;
   // the target node id of the newly added copy edge by load/store/offset
   llvm::BitVector targetList;
 
-  // set of the new added copy edge (identified by the hash value of src/dst)
-  llvm::BitVector requiredEdge;
+  // set of the new added copy edge (identified by the node ids of src/dst)
+  // sized by the number of pending edges, so it is cheap to create and to clear after every round
+  llvm::DenseSet<std::pair<NodeID, NodeID>> requiredEdge;
 
   // llvm::BitVector changedCopy;
 
+  // topological order of the copy graph, maintained incrementally instead of running an SCC pass every round
+  CopyGraphOrder<ctx> copyOrder;
+  // the work done by every round, to see how much of the graph is re-traversed
+  std::vector<RoundStats> roundStats;
+  // what the offline pointer equivalence removed before solving
+  typename PointerEquivalence<ctx, PT>::Stats pointerEquivalenceStats;
+
+  // per node buffers of propagateCopyInWaves, all UNVISITED/unset between rounds
+  std::vector<uint32_t> waveSlot;
+  llvm::BitVector waveReached;
+
+  // number of threads used by the solver, 1 solves everything sequentially.
+  // the points-to sets of different nodes are updated concurrently, which not every PTS allows
+  size_t jobs;
+
  public:
-  PartialUpdateSolver() : copyWorkList(), lsWorkList(), targetList(), requiredEdge(HASH_EDGE_LIMIT) {}
+  PartialUpdateSolver()
+      : copyWorkList(),
+        lsWorkList(),
+        collapsed(),
+        targetList(),
+        requiredEdge(),
+        jobs(PT::supportConcurrentUpdate() ? race::resolveJobs(ConfigPTAJobs) : 1) {}
 
  protected:
-  inline size_t hashEdge(CGNodeTy *src, CGNodeTy *dst) {
-    size_t hashed = llvm::hash_value(std::make_pair<void *, void *>(src, dst));
-    return hashed % HASH_EDGE_LIMIT;
+  static inline std::pair<NodeID, NodeID> edgeKey(CGNodeTy *src, CGNodeTy *dst) {
+    return {src->getNodeID(), dst->getNodeID()};
   }
 
-  bool shouldProcessCopy(CGNodeTy *src, CGNodeTy *dst) {
-    if (!lsWorkList.test(src->getNodeID())) {
-      // if the incoming src changed then yes
-      return true;
-    }
+  // whether the copy edge is newly added, so that the whole pts of src needs to be pushed along it
+  bool isRequiredCopy(CGNodeTy *src, CGNodeTy *dst) {
     bool isDstTarget = !targetList.test(dst->getNodeID());
     bool isSrcUnhandled = !copyWorkList.test(src->getNodeID());
 
     if (isDstTarget && isSrcUnhandled) {
       // whether this is the edge
-      return requiredEdge.test(hashEdge(src, dst));
+      return requiredEdge.count(edgeKey(src, dst)) != 0;
     }
 
     return false;
@@ -189,74 +499,28 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
     ConsGraphTy &consGraph = *(super::getConsGraph());
 
     do {
-      std::stack<std::vector<CGNodeTy *>> copySCCStack;
+      // first bring the topological order up to date with the new nodes and copy edges,
+      // collapsing the cycles they close. load/store/offset can create new copy constraint to be handled
+      collapsed.reset();
+      collapsed.resize(consGraph.getNodeNum());
+      auto const orderStats = copyOrder.update(consGraph, [&](const std::vector<CGNodeTy *> &cycle) {
+        collapsed.set(collapseCopySCC(cycle)->getNodeID());
+      });
 
-      // first do SCC detection and topo-sort
-      // load/store/offset can create new copy constraint to be handled
-      auto copy_it = scc_begin<ctx, Constraints::copy, false>(consGraph, copyWorkList);
-      auto copy_ie = scc_end<ctx, Constraints::copy, false>(consGraph, copyWorkList);
-
-      for (; copy_it != copy_ie; ++copy_it) {
-        copySCCStack.push(*copy_it);
-      }
-
-      while (!copySCCStack.empty()) {
-        const std::vector<CGNodeTy *> &scc = copySCCStack.top();
-        // llvm::outs() << scc.front()->getNodeID() << ",";
-
-        if (scc.size() > 1) {
-          processCopySCC(scc);
-        } else {
-          CGNodeTy *curNode = scc.front();
-          for (auto cit = curNode->succ_copy_begin(), cie = curNode->succ_copy_end(); cit != cie; cit++) {
-            if (shouldProcessCopy(curNode, *cit)) {
-              if (super::processCopy(curNode, *cit)) {
-                // changedCopy.set(hashEdge(curNode, *cit));
-                lsWorkList.reset((*cit)->getNodeID());
-              }
-            }
-          }
-        }
-        copySCCStack.pop();
-      }
-
-      assert(copySCCStack.size() == 0);
+      auto const visitedNodes = jobs > 1 ? propagateCopyInWaves() : propagateCopy();
+      roundStats.push_back({consGraph.getNodeNum(), visitedNodes, orderStats});
 
       // set all copy to be already handled
       copyWorkList.set();  // empty the worklist
       targetList.set();
 
-      requiredEdge.reset();
+      requiredEdge.clear();
 
       // const size_t prevNodeNum = consGraph.getNodeNum();
-      int _lastID = lsWorkList.find_first_unset();
-      while (_lastID >= 0) {
-        unsigned int lastID = static_cast<unsigned int>(_lastID);
-
-        CGNodeTy *curNode = consGraph.getNode(lastID);
-
-        for (auto it = curNode->pred_store_begin(), ie = curNode->pred_store_end(); it != ie; it++) {
-          super::processStore(*it, curNode, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
-        }
-
-        for (auto it = curNode->succ_load_begin(), ie = curNode->succ_load_end(); it != ie; it++) {
-          super::processLoad(curNode, *it, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
-        }
-
-        // to handled special constraints
-        for (auto it = curNode->succ_special_begin(), ie = curNode->succ_special_end(); it != ie; it++) {
-          super::processSpecial(curNode, *it, [&](CGNodeTy *src, CGNodeTy *dst) { recordCopyEdge(src, dst); });
-        }
-
-#ifndef NO_ADDR_OF_FOR_OFFSET
-        for (auto it = curNode->succ_offset_begin(), ie = curNode->succ_offset_end(); it != ie; it++) {
-          super::processOffset(curNode, *it, [&](CGNodeTy *fieldObj, CGNodeTy *ptr) {
-            auto addrNode = llvm::cast<ObjNodeTy>(fieldObj)->getAddrTakenNode();
-            recordCopyEdge(addrNode, ptr);
-          });
-        }
-#endif
-        _lastID = lsWorkList.find_next_unset(lastID);
+      if (jobs > 1) {
+        processComplexInParallel();
+      } else {
+        processComplex();
       }
 
 #ifndef NO_ADDR_OF_FOR_OFFSET
@@ -310,16 +574,37 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
       targetList.resize(super::getConsGraph()->getNodeNum(), false);
       copyWorkList.resize(super::getConsGraph()->getNodeNum(), false);
 #endif
-      // The call to count in this log message is evaluated regardless of log
-      // level and are very expensive LOG_TRACE("hash map fill rate, count = {},
-      // size = {}, rate={}", requiredEdge.count(), requiredEdge.size(),
-      //           ((float)requiredEdge.count()) / requiredEdge.size());
 
-      LOG_DEBUG("PTA Iteration No: {} - nodes: {}", numOfPTAIterations++, this->getConsGraph()->getNodeNum());
-    } while (!copyWorkList.all());
+      LOG_DEBUG("PTA Iteration No: {} - nodes: {}, visited: {}, reordered edges: {}, searched: {}, collapsed: {}",
+                numOfPTAIterations++, this->getConsGraph()->getNodeNum(), visitedNodes, orderStats.reorderedEdges,
+                orderStats.searchedNodes, orderStats.collapsedCycles);
+    } while (!copyWorkList.all() && !super::checkBudget());
+  }
+
+ public:
+  [[nodiscard]] const CopyGraphOrder<ctx> &getCopyGraphOrder() const { return copyOrder; }
+  [[nodiscard]] const std::vector<RoundStats> &getRoundStats() const { return roundStats; }
+  [[nodiscard]] const typename PointerEquivalence<ctx, PT>::Stats &getPointerEquivalenceStats() const {
+    return pointerEquivalenceStats;
+  }
+
+ protected:
+  // collapse the pointers that provably end up with the same points-to set before solving
+  void reducePointerEquivalence() {
+    pointerEquivalenceStats = PointerEquivalence<ctx, PT>::run(*super::getConsGraph(), [](CGNodeTy *node) {
+      // arguments and call results get new copy edges when indirect calls are resolved
+      auto const value = llvm::cast<PtrNodeTy>(node)->getPointer()->getValue();
+      return !llvm::isa<llvm::Argument>(value) && !llvm::isa<llvm::CallBase>(value);
+    });
+    LOG_INFO("Offline pointer equivalence merged {} nodes, removed {} edges", pointerEquivalenceStats.mergedNodes,
+             pointerEquivalenceStats.removedEdges);
   }
 
   void solve() {
+    if (ConfigPTAOfflineHVN) {
+      reducePointerEquivalence();
+    }
+
     // initially, all node need to be traversed.
     copyWorkList.resize(super::getConsGraph()->getNodeNum(), false);
     lsWorkList.resize(super::getConsGraph()->getNodeNum(), false);
@@ -334,11 +619,15 @@ class PartialUpdateSolver : public SolverBase<LangModel, PartialUpdateSolver<Lan
     do {
       // after this, the current contraints graph will reach fixed point.
       this->runSolver(*super::getLangModel());
+      if (super::hasStopped()) {
+        // out of budget, the worklists are left unfinished
+        break;
+      }
 
       assert(lsWorkList.all());  // all visited (1)
       assert(targetList.all());
       assert(copyWorkList.all());
-      assert(!requiredEdge.any());  // all zero
+      assert(requiredEdge.empty());
 
       // record every constraints added during indirect call resolve
       size_t prevNodeNum = super::getConsGraph()->getNodeNum();
@@ -0,0 +1,130 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <vector>
+
+#include "PointerAnalysis/Solver/PointsTo/AdaptivePointsToSet.h"
+#include "PointerAnalysis/Solver/PointsTo/PTSTrait.h"
+
+namespace pta {
+
+// Same as BitVectorPTS, but each node stores its pts in an AdaptivePointsToSet,
+// which keeps small sets inline and runs the set operations on SIMD kernels
+class AdaptivePTS {
+ private:
+  using TargetID = NodeID;
+  using PtsTy = AdaptivePointsToSet;
+  using iterator = PtsTy::iterator;
+
+  struct State {
+    std::vector<PtsTy> ptsVec;
+  };
+
+  // the pts of every node, in the state bound to the calling thread
+  static inline std::vector<PtsTy> &ptsVec() { return ThreadBound<State>::get().ptsVec; }
+
+  static inline void onNewNodeCreation(NodeID id) {
+    assert(id == ptsVec().size());
+    ptsVec().emplace_back();
+  }
+
+  static inline void clearAll() { ptsVec().clear(); }
+
+  // every node owns its set, there is nothing to collect
+  static inline void collectGarbage() {}
+
+  [[nodiscard]] static inline const PtsTy &getPointsTo(NodeID id) {
+    assert(id < ptsVec().size());
+    return ptsVec()[id];
+  }
+
+  static inline bool unionWith(NodeID src, NodeID dst) {
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src] |= ptsVec()[dst];
+  }
+
+  static inline bool unionWithPts(NodeID src, const PtsTy &pts) {
+    assert(src < ptsVec().size());
+    return ptsVec()[src] |= pts;
+  }
+
+  [[nodiscard]] static inline bool intersectWith(NodeID src, NodeID dst) {
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src].intersects(ptsVec()[dst]);
+  }
+
+  [[nodiscard]] static inline bool intersectWithNoSpecialNode(NodeID src, NodeID dst) {
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src].intersectsFrom(ptsVec()[dst], NORMAL_OBJ_START_ID);
+  }
+
+  static inline bool insert(NodeID src, TargetID idx) {
+    assert(src < ptsVec().size() && idx < ptsVec().size());
+    return ptsVec()[src].test_and_set(idx);
+  }
+
+  [[nodiscard]] static inline bool has(NodeID src, TargetID idx) {
+    assert(src < ptsVec().size() && idx < ptsVec().size());
+    return ptsVec()[src].test(idx);
+  }
+
+  [[nodiscard]] static inline bool equal(NodeID src, NodeID dst) {
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src] == ptsVec()[dst];
+  }
+
+  [[nodiscard]] static inline bool contains(NodeID src, NodeID dst) {
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src].contains(ptsVec()[dst]);
+  }
+
+  [[nodiscard]] static inline bool isEmpty(NodeID id) {
+    assert(id < ptsVec().size());
+    return ptsVec()[id].empty();
+  }
+
+  [[nodiscard]] static inline iterator begin(NodeID id) {
+    assert(id < ptsVec().size());
+    return ptsVec()[id].begin();
+  }
+
+  [[nodiscard]] static inline iterator end(NodeID id) {
+    assert(id < ptsVec().size());
+    return ptsVec()[id].end();
+  }
+
+  static inline void clear(NodeID id) {
+    assert(id < ptsVec().size());
+    ptsVec()[id].clear();
+  }
+
+  static inline size_t count(NodeID id) {
+    assert(id < ptsVec().size());
+    return ptsVec()[id].count();
+  }
+
+  static inline const PtsTy &getPointedBy(NodeID /*id*/) {
+    llvm_unreachable("not supported by AdaptivePTS, use PointedByPts instead");
+  }
+
+  static inline constexpr bool supportPointedBy() { return false; }
+
+  // the pts of different nodes are independent
+  static inline constexpr bool supportConcurrentUpdate() { return true; }
+
+  friend class PTSTrait<AdaptivePTS>;
+};
+
+}  // namespace pta
+
+DEFINE_PTS_TRAIT(pta::AdaptivePTS)
@@ -0,0 +1,672 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Solver/PointsTo/AdaptivePointsToSet.h"
+
+#include <algorithm>
+
+#include "PointerAnalysis/Solver/PointsTo/SetKernels.h"
+
+using namespace pta;
+
+namespace {
+
+constexpr uint64_t BITS_PER_WORD = 64;
+
+// a dense bitmap is kept while it is at most twice the size of the same set in chunks,
+// and a sparse set turns dense once the bitmap would not be larger than its chunks
+inline bool tooSparseForDense(size_t spanWords, size_t chunks, uint32_t chunkStride) {
+  return spanWords > 2 * chunks * chunkStride;
+}
+
+inline bool denseEnough(size_t spanWords, size_t chunks, uint32_t chunkStride) {
+  return spanWords <= chunks * chunkStride;
+}
+
+}  // namespace
+
+void AdaptivePointsToSet::iterator::advance() {
+  if (set->kind == Kind::Small) {
+    block++;
+    if (block < set->smallSize) {
+      value = set->small[block];
+    }
+    return;
+  }
+
+  while (bits == 0) {
+    word++;
+    if (word == set->blockSize(block)) {
+      block++;
+      word = 0;
+      if (block == set->numBlocks()) {
+        return;
+      }
+    }
+    bits = set->blockWords(block)[word];
+  }
+  auto const bit = static_cast<uint64_t>(__builtin_ctzll(bits));
+  value = static_cast<ElemTy>((set->blockBase(block) + word) * BITS_PER_WORD + bit);
+  bits &= bits - 1;
+}
+
+AdaptivePointsToSet::iterator AdaptivePointsToSet::begin() const {
+  iterator it(this, 0);
+  if (kind == Kind::Small) {
+    if (smallSize > 0) {
+      it.value = small[0];
+    }
+    return it;
+  }
+  if (numBlocks() == 0) return end();
+  // advance() skips the empty words at the start of the first chunk
+  it.bits = blockWords(0)[0];
+  it.advance();
+  return it;
+}
+
+AdaptivePointsToSet::iterator AdaptivePointsToSet::end() const {
+  return iterator(this, kind == Kind::Small ? smallSize : numBlocks());
+}
+
+template <typename Set, typename OnBoth, typename OnlyLhs>
+bool AdaptivePointsToSet::walkWords(Set &lhs, const AdaptivePointsToSet &rhs, OnBoth onBoth, OnlyLhs onlyLhs) {
+  // both sets are lists of blocks sorted by their first word, split the words of lhs into the runs that rhs also
+  // covers and the runs that only lhs covers. The callbacks return false to stop the walk.
+  size_t j = 0;
+  auto const rhsBlocks = rhs.numBlocks();
+  for (size_t i = 0, ie = lhs.numBlocks(); i < ie; i++) {
+    auto const lhsBegin = lhs.blockBase(i);
+    auto const lhsEnd = lhsBegin + lhs.blockSize(i);
+    auto *lhsWords = lhs.blockWords(i);
+    auto pos = lhsBegin;
+    while (pos < lhsEnd) {
+      while (j < rhsBlocks && rhs.blockBase(j) + rhs.blockSize(j) <= pos) {
+        j++;
+      }
+      if (j == rhsBlocks || rhs.blockBase(j) >= lhsEnd) {
+        if (!onlyLhs(lhsWords + (pos - lhsBegin), lhsEnd - pos, pos)) return false;
+        break;
+      }
+      auto const rhsBegin = rhs.blockBase(j);
+      if (rhsBegin > pos) {
+        if (!onlyLhs(lhsWords + (pos - lhsBegin), rhsBegin - pos, pos)) return false;
+        pos = rhsBegin;
+      }
+      auto const end = std::min<uint64_t>(lhsEnd, rhsBegin + rhs.blockSize(j));
+      if (!onBoth(lhsWords + (pos - lhsBegin), rhs.blockWords(j) + (pos - rhsBegin), end - pos, pos)) return false;
+      pos = end;
+    }
+  }
+  return true;
+}
+
+size_t AdaptivePointsToSet::findChunk(uint64_t index) const {
+  size_t lo = 0;
+  size_t hi = numBlocks();
+  while (lo < hi) {
+    auto const mid = lo + (hi - lo) / 2;
+    if (words[mid * CHUNK_STRIDE] < index) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+size_t AdaptivePointsToSet::countDenseChunks() const {
+  assert(kind == Kind::Dense);
+  size_t chunks = 0;
+  uint64_t lastChunk = ~0ull;
+  for (size_t i = 0; i < words.size(); i++) {
+    auto const chunk = (baseWord + i) / CHUNK_WORDS;
+    if (words[i] != 0 && chunk != lastChunk) {
+      chunks++;
+      lastChunk = chunk;
+    }
+  }
+  return chunks;
+}
+
+std::vector<AdaptivePointsToSet::ElemTy> AdaptivePointsToSet::toVector() const {
+  std::vector<ElemTy> elems;
+  elems.reserve(count());
+  for (auto elem : *this) {
+    elems.push_back(elem);
+  }
+  return elems;
+}
+
+void AdaptivePointsToSet::assignSorted(const std::vector<ElemTy> &elems) {
+  words = std::vector<uint64_t>();
+  baseWord = 0;
+  smallSize = 0;
+  if (elems.size() <= SMALL_SIZE) {
+    kind = Kind::Small;
+    std::copy(elems.begin(), elems.end(), small);
+    smallSize = static_cast<uint8_t>(elems.size());
+    return;
+  }
+
+  size_t chunks = 0;
+  uint64_t lastChunk = ~0ull;
+  for (auto elem : elems) {
+    auto const chunk = elem / BITS_PER_WORD / CHUNK_WORDS;
+    if (chunk != lastChunk) {
+      chunks++;
+      lastChunk = chunk;
+    }
+  }
+  auto const firstWord = elems.front() / BITS_PER_WORD;
+  auto const spanWords = elems.back() / BITS_PER_WORD - firstWord + 1;
+
+  if (denseEnough(spanWords, chunks, CHUNK_STRIDE)) {
+    kind = Kind::Dense;
+    baseWord = static_cast<uint32_t>(firstWord);
+    words.assign(spanWords, 0);
+    for (auto elem : elems) {
+      words[elem / BITS_PER_WORD - firstWord] |= 1ull << (elem % BITS_PER_WORD);
+    }
+    return;
+  }
+
+  kind = Kind::Sparse;
+  words.reserve(chunks * CHUNK_STRIDE);
+  lastChunk = ~0ull;
+  for (auto elem : elems) {
+    auto const chunk = elem / BITS_PER_WORD / CHUNK_WORDS;
+    if (chunk != lastChunk) {
+      words.push_back(chunk);
+      words.resize(words.size() + CHUNK_WORDS, 0);
+      lastChunk = chunk;
+    }
+    words[words.size() - CHUNK_WORDS + (elem / BITS_PER_WORD) % CHUNK_WORDS] |= 1ull << (elem % BITS_PER_WORD);
+  }
+}
+
+void AdaptivePointsToSet::toDense() {
+  assert(kind == Kind::Sparse && numBlocks() > 0);
+  auto const firstWord = blockBase(0);
+  auto const spanWords = blockBase(numBlocks() - 1) + CHUNK_WORDS - firstWord;
+  std::vector<uint64_t> dense(spanWords, 0);
+  for (size_t i = 0, ie = numBlocks(); i < ie; i++) {
+    std::copy_n(blockWords(i), CHUNK_WORDS, dense.begin() + (blockBase(i) - firstWord));
+  }
+  kind = Kind::Dense;
+  baseWord = static_cast<uint32_t>(firstWord);
+  words.swap(dense);
+  // chunks can have empty words at both ends
+  normalize();
+}
+
+void AdaptivePointsToSet::toSparse() {
+  assert(kind == Kind::Dense);
+  std::vector<uint64_t> sparse;
+  for (size_t i = 0; i < words.size();) {
+    auto const chunk = (baseWord + i) / CHUNK_WORDS;
+    auto const chunkBegin = chunk * CHUNK_WORDS;
+    uint64_t bits[CHUNK_WORDS] = {};
+    bool nonEmpty = false;
+    for (; i < words.size() && (baseWord + i) / CHUNK_WORDS == chunk; i++) {
+      bits[baseWord + i - chunkBegin] = words[i];
+      nonEmpty |= words[i] != 0;
+    }
+    if (nonEmpty) {
+      sparse.push_back(chunk);
+      sparse.insert(sparse.end(), bits, bits + CHUNK_WORDS);
+    }
+  }
+  kind = Kind::Sparse;
+  baseWord = 0;
+  words.swap(sparse);
+}
+
+void AdaptivePointsToSet::normalize() {
+  if (kind == Kind::Small) return;
+
+  if (kind == Kind::Dense) {
+    auto const first = std::find_if(words.begin(), words.end(), [](uint64_t word) { return word != 0; });
+    auto const leading = static_cast<size_t>(first - words.begin());
+    auto const last = std::find_if(words.rbegin(), words.rend(), [](uint64_t word) { return word != 0; });
+    auto const trailing = static_cast<size_t>(last - words.rbegin());
+    if (leading == words.size()) {
+      clear();
+      return;
+    }
+    words.resize(words.size() - trailing);
+    words.erase(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(leading));
+    baseWord += static_cast<uint32_t>(leading);
+  } else {
+    size_t kept = 0;
+    for (size_t i = 0, ie = numBlocks(); i < ie; i++) {
+      if (simd::isZeroWords(blockWords(i), CHUNK_WORDS)) continue;
+      if (kept != i) {
+        std::copy_n(words.begin() + static_cast<std::ptrdiff_t>(i * CHUNK_STRIDE), CHUNK_STRIDE,
+                    words.begin() + static_cast<std::ptrdiff_t>(kept * CHUNK_STRIDE));
+      }
+      kept++;
+    }
+    if (kept == 0) {
+      clear();
+      return;
+    }
+    words.resize(kept * CHUNK_STRIDE);
+  }
+
+  if (count() <= SMALL_SIZE) {
+    assignSorted(toVector());
+    return;
+  }
+  adjustLayout();
+}
+
+void AdaptivePointsToSet::adjustLayout() {
+  if (kind == Kind::Dense) {
+    if (tooSparseForDense(words.size(), countDenseChunks(), CHUNK_STRIDE)) {
+      toSparse();
+    }
+  } else if (kind == Kind::Sparse) {
+    auto const chunks = numBlocks();
+    auto const spanWords = blockBase(chunks - 1) + CHUNK_WORDS - blockBase(0);
+    if (denseEnough(spanWords, chunks, CHUNK_STRIDE)) {
+      toDense();
+    }
+  }
+}
+
+bool AdaptivePointsToSet::test(ElemTy elem) const {
+  switch (kind) {
+    case Kind::Small:
+      return std::find(small, small + smallSize, elem) != small + smallSize;
+    case Kind::Dense: {
+      auto const word = elem / BITS_PER_WORD;
+      if (word < baseWord || word >= baseWord + words.size()) return false;
+      return (words[word - baseWord] >> (elem % BITS_PER_WORD)) & 1;
+    }
+    case Kind::Sparse: {
+      auto const chunk = elem / BITS_PER_WORD / CHUNK_WORDS;
+      auto const pos = findChunk(chunk);
+      if (pos == numBlocks() || words[pos * CHUNK_STRIDE] != chunk) return false;
+      return (blockWords(pos)[(elem / BITS_PER_WORD) % CHUNK_WORDS] >> (elem % BITS_PER_WORD)) & 1;
+    }
+  }
+  return false;
+}
+
+bool AdaptivePointsToSet::test_and_set(ElemTy elem) {
+  if (test(elem)) return false;
+
+  auto const bit = 1ull << (elem % BITS_PER_WORD);
+  auto const word = elem / BITS_PER_WORD;
+  switch (kind) {
+    case Kind::Small: {
+      auto const pos = std::upper_bound(small, small + smallSize, elem);
+      if (smallSize < SMALL_SIZE) {
+        std::copy_backward(pos, small + smallSize, small + smallSize + 1);
+        *pos = elem;
+        smallSize++;
+      } else {
+        std::vector<ElemTy> elems(small, pos);
+        elems.push_back(elem);
+        elems.insert(elems.end(), pos, small + smallSize);
+        assignSorted(elems);
+      }
+      return true;
+    }
+    case Kind::Dense: {
+      if (word >= baseWord && word < baseWord + words.size()) {
+        words[word - baseWord] |= bit;
+        return true;
+      }
+      auto const begin = std::min<uint64_t>(baseWord, word);
+      auto const end = std::max<uint64_t>(baseWord + words.size(), word + 1);
+      if (tooSparseForDense(end - begin, countDenseChunks() + 1, CHUNK_STRIDE)) {
+        toSparse();
+        return test_and_set(elem);
+      }
+      words.insert(words.begin(), baseWord - begin, 0);
+      words.resize(end - begin, 0);
+      baseWord = static_cast<uint32_t>(begin);
+      words[word - baseWord] |= bit;
+      return true;
+    }
+    case Kind::Sparse: {
+      auto const chunk = word / CHUNK_WORDS;
+      auto const pos = findChunk(chunk);
+      if (pos == numBlocks() || words[pos * CHUNK_STRIDE] != chunk) {
+        auto const at = words.begin() + static_cast<std::ptrdiff_t>(pos * CHUNK_STRIDE);
+        words.insert(words.insert(at, chunk) + 1, CHUNK_WORDS, 0);
+        blockWords(pos)[word % CHUNK_WORDS] |= bit;
+        adjustLayout();
+      } else {
+        blockWords(pos)[word % CHUNK_WORDS] |= bit;
+      }
+      return true;
+    }
+  }
+  return true;
+}
+
+void AdaptivePointsToSet::reset(ElemTy elem) {
+  if (!test(elem)) return;
+
+  if (kind == Kind::Small) {
+    auto const pos = std::find(small, small + smallSize, elem);
+    std::copy(pos + 1, small + smallSize, pos);
+    smallSize--;
+    return;
+  }
+
+  auto const word = elem / BITS_PER_WORD;
+  auto const mask = ~(1ull << (elem % BITS_PER_WORD));
+  if (kind == Kind::Dense) {
+    words[word - baseWord] &= mask;
+  } else {
+    blockWords(findChunk(word / CHUNK_WORDS))[word % CHUNK_WORDS] &= mask;
+  }
+  normalize();
+}
+
+size_t AdaptivePointsToSet::count() const {
+  if (kind == Kind::Small) return smallSize;
+  size_t result = 0;
+  for (size_t i = 0, ie = numBlocks(); i < ie; i++) {
+    result += simd::countWords(blockWords(i), blockSize(i));
+  }
+  return result;
+}
+
+void AdaptivePointsToSet::clear() {
+  kind = Kind::Small;
+  smallSize = 0;
+  baseWord = 0;
+  words = std::vector<uint64_t>();
+}
+
+bool AdaptivePointsToSet::denseUnion(const AdaptivePointsToSet &other) {
+  assert(kind == Kind::Dense && other.kind == Kind::Dense);
+  auto const begin = std::min(baseWord, other.baseWord);
+  auto const end = std::max<uint64_t>(baseWord + words.size(), other.baseWord + other.words.size());
+  if (end - begin > words.size()) {
+    // the union touches at most the chunks of both sets
+    if (tooSparseForDense(end - begin, countDenseChunks() + other.countDenseChunks(), CHUNK_STRIDE)) {
+      toSparse();
+      AdaptivePointsToSet sparse = other;
+      sparse.toSparse();
+      sparseUnion(sparse);
+      adjustLayout();
+      return true;
+    }
+    words.insert(words.begin(), baseWord - begin, 0);
+    words.resize(end - begin, 0);
+    baseWord = begin;
+  }
+  return simd::unionWords(words.data() + (other.baseWord - baseWord), other.words.data(), other.words.size());
+}
+
+bool AdaptivePointsToSet::sparseUnion(const AdaptivePointsToSet &other) {
+  assert(kind == Kind::Sparse && other.kind == Kind::Sparse);
+  auto const lhsChunks = numBlocks();
+  auto const rhsChunks = other.numBlocks();
+
+  // chunks of other that this set does not have yet
+  size_t missing = 0;
+  for (size_t i = 0, j = 0; j < rhsChunks;) {
+    if (i == lhsChunks || words[i * CHUNK_STRIDE] > other.words[j * CHUNK_STRIDE]) {
+      missing++;
+      j++;
+    } else if (words[i * CHUNK_STRIDE] < other.words[j * CHUNK_STRIDE]) {
+      i++;
+    } else {
+      i++;
+      j++;
+    }
+  }
+
+  if (missing == 0) {
+    bool changed = false;
+    for (size_t i = 0, j = 0; j < rhsChunks; i++) {
+      if (words[i * CHUNK_STRIDE] == other.words[j * CHUNK_STRIDE]) {
+        changed |= simd::unionWords(blockWords(i), other.blockWords(j), CHUNK_WORDS);
+        j++;
+      }
+    }
+    return changed;
+  }
+
+  std::vector<uint64_t> merged;
+  merged.reserve((lhsChunks + missing) * CHUNK_STRIDE);
+  size_t i = 0;
+  size_t j = 0;
+  while (i < lhsChunks || j < rhsChunks) {
+    auto const lhsIndex = i < lhsChunks ? words[i * CHUNK_STRIDE] : ~0ull;
+    auto const rhsIndex = j < rhsChunks ? other.words[j * CHUNK_STRIDE] : ~0ull;
+    if (lhsIndex <= rhsIndex) {
+      auto const chunk = words.begin() + static_cast<std::ptrdiff_t>(i * CHUNK_STRIDE);
+      merged.insert(merged.end(), chunk, chunk + CHUNK_STRIDE);
+      if (lhsIndex == rhsIndex) {
+        simd::unionWords(merged.data() + merged.size() - CHUNK_WORDS, other.blockWords(j), CHUNK_WORDS);
+        j++;
+      }
+      i++;
+    } else {
+      auto const chunk = other.words.begin() + static_cast<std::ptrdiff_t>(j * CHUNK_STRIDE);
+      merged.insert(merged.end(), chunk, chunk + CHUNK_STRIDE);
+      j++;
+    }
+  }
+  words.swap(merged);
+  adjustLayout();
+  return true;
+}
+
+bool AdaptivePointsToSet::operator|=(const AdaptivePointsToSet &other) {
+  if (this == &other || other.empty()) return false;
+
+  if (other.kind == Kind::Small) {
+    bool changed = false;
+    for (uint8_t i = 0; i < other.smallSize; i++) {
+      changed |= test_and_set(other.small[i]);
+    }
+    return changed;
+  }
+
+  if (kind == Kind::Small) {
+    // other has more than SMALL_SIZE elements, so the union is always larger than this set
+    AdaptivePointsToSet result = other;
+    for (uint8_t i = 0; i < smallSize; i++) {
+      result.set(small[i]);
+    }
+    *this = std::move(result);
+    return true;
+  }
+
+  if (kind == Kind::Dense && other.kind == Kind::Dense) {
+    return denseUnion(other);
+  }
+
+  // mixed layouts are merged as chunks
+  bool changed;
+  if (kind == Kind::Dense) {
+    toSparse();
+    changed = sparseUnion(other);
+  } else if (other.kind == Kind::Dense) {
+    AdaptivePointsToSet sparse = other;
+    sparse.toSparse();
+    changed = sparseUnion(sparse);
+  } else {
+    return sparseUnion(other);
+  }
+  adjustLayout();
+  return changed;
+}
+
+bool AdaptivePointsToSet::operator&=(const AdaptivePointsToSet &other) {
+  if (this == &other) return false;
+
+  if (kind == Kind::Small) {
+    auto const end = std::remove_if(small, small + smallSize, [&](ElemTy elem) { return !other.test(elem); });
+    auto const size = static_cast<uint8_t>(end - small);
+    bool changed = size != smallSize;
+    smallSize = size;
+    return changed;
+  }
+
+  if (other.kind == Kind::Small) {
+    // other has fewer elements than this set, so the result is always smaller than this set
+    std::vector<ElemTy> kept;
+    for (uint8_t i = 0; i < other.smallSize; i++) {
+      if (test(other.small[i])) {
+        kept.push_back(other.small[i]);
+      }
+    }
+    assignSorted(kept);
+    return true;
+  }
+
+  bool changed = false;
+  walkWords(
+      *this, other,
+      [&](uint64_t *lhs, const uint64_t *rhs, size_t n, uint64_t /* pos */) {
+        changed |= simd::intersectWords(lhs, rhs, n);
+        return true;
+      },
+      [&](uint64_t *lhs, size_t n, uint64_t /* pos */) {
+        if (!simd::isZeroWords(lhs, n)) {
+          std::fill_n(lhs, n, 0);
+          changed = true;
+        }
+        return true;
+      });
+  if (changed) {
+    normalize();
+  }
+  return changed;
+}
+
+bool AdaptivePointsToSet::subtract(const AdaptivePointsToSet &other) {
+  if (empty() || other.empty()) return false;
+
+  if (kind == Kind::Small) {
+    auto const end = std::remove_if(small, small + smallSize, [&](ElemTy elem) { return other.test(elem); });
+    auto const size = static_cast<uint8_t>(end - small);
+    bool changed = size != smallSize;
+    smallSize = size;
+    return changed;
+  }
+
+  bool changed = false;
+  if (other.kind == Kind::Small) {
+    for (uint8_t i = 0; i < other.smallSize; i++) {
+      auto const elem = other.small[i];
+      if (!test(elem)) continue;
+      auto const word = elem / BITS_PER_WORD;
+      auto const mask = ~(1ull << (elem % BITS_PER_WORD));
+      if (kind == Kind::Dense) {
+        words[word - baseWord] &= mask;
+      } else {
+        blockWords(findChunk(word / CHUNK_WORDS))[word % CHUNK_WORDS] &= mask;
+      }
+      changed = true;
+    }
+  } else {
+    walkWords(
+        *this, other,
+        [&](uint64_t *lhs, const uint64_t *rhs, size_t n, uint64_t /* pos */) {
+          changed |= simd::subtractWords(lhs, rhs, n);
+          return true;
+        },
+        [](uint64_t * /* lhs */, size_t /* n */, uint64_t /* pos */) { return true; });
+  }
+  if (changed) {
+    normalize();
+  }
+  return changed;
+}
+
+void AdaptivePointsToSet::intersectWithComplement(const AdaptivePointsToSet &lhs, const AdaptivePointsToSet &rhs) {
+  // rhs may be this set
+  AdaptivePointsToSet result = lhs;
+  result.subtract(rhs);
+  *this = std::move(result);
+}
+
+bool AdaptivePointsToSet::intersects(const AdaptivePointsToSet &other) const { return intersectsFrom(other, 0); }
+
+bool AdaptivePointsToSet::intersectsFrom(const AdaptivePointsToSet &other, ElemTy from) const {
+  if (kind == Kind::Small || other.kind == Kind::Small) {
+    const auto &smallSet = kind == Kind::Small ? *this : other;
+    const auto &otherSet = kind == Kind::Small ? other : *this;
+    for (uint8_t i = 0; i < smallSet.smallSize; i++) {
+      if (smallSet.small[i] >= from && otherSet.test(smallSet.small[i])) return true;
+    }
+    return false;
+  }
+
+  auto const fromWord = from / BITS_PER_WORD;
+  auto const fromMask = ~0ull << (from % BITS_PER_WORD);
+  bool found = false;
+  walkWords(
+      *this, other,
+      [&](const uint64_t *lhs, const uint64_t *rhs, size_t n, uint64_t pos) {
+        size_t skip = 0;
+        if (pos + n <= fromWord) return true;
+        if (pos <= fromWord) {
+          // the word holding from only counts from that bit on
+          skip = fromWord - pos;
+          if ((lhs[skip] & rhs[skip] & fromMask) != 0) {
+            found = true;
+            return false;
+          }
+          skip++;
+        }
+        found = simd::intersectsWords(lhs + skip, rhs + skip, n - skip);
+        return !found;
+      },
+      [](const uint64_t * /* lhs */, size_t /* n */, uint64_t /* pos */) { return true; });
+  return found;
+}
+
+bool AdaptivePointsToSet::contains(const AdaptivePointsToSet &other) const {
+  if (other.kind == Kind::Small) {
+    for (uint8_t i = 0; i < other.smallSize; i++) {
+      if (!test(other.small[i])) return false;
+    }
+    return true;
+  }
+  // other has more elements than a small set can hold
+  if (kind == Kind::Small) return false;
+
+  return walkWords(
+      other, *this,
+      [](const uint64_t *sub, const uint64_t *super, size_t n, uint64_t /* pos */) {
+        return simd::containsWords(super, sub, n);
+      },
+      [](const uint64_t *sub, size_t n, uint64_t /* pos */) { return simd::isZeroWords(sub, n); });
+}
+
+bool AdaptivePointsToSet::operator==(const AdaptivePointsToSet &other) const {
+  if (kind != other.kind) {
+    // a small set never equals a larger one, dense and sparse sets can hold the same elements
+    if (kind == Kind::Small || other.kind == Kind::Small) return false;
+    return count() == other.count() && contains(other);
+  }
+  switch (kind) {
+    case Kind::Small:
+      return smallSize == other.smallSize && std::equal(small, small + smallSize, other.small);
+    case Kind::Dense:
+      return baseWord == other.baseWord && words == other.words;
+    case Kind::Sparse:
+      return words == other.words;
+  }
+  return false;
+}
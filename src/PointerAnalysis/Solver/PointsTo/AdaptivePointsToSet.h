@@ -0,0 +1,175 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace pta {
+
+// Most points-to sets hold a handful of objects, some cover a dense range of ids and a few are huge and spread out.
+// The set switches between three layouts:
+//  - Small:  up to SMALL_SIZE sorted ids stored inline, no allocation at all
+//  - Dense:  one word bitmap covering [baseWord * 64, (baseWord + words.size()) * 64)
+//  - Sparse: sorted chunks of CHUNK_WORDS words, for sets whose ids are too spread out for a single bitmap
+// Bitmap operations run on the SIMD kernels in SetKernels.h.
+// The interface follows llvm::SparseBitVector, so it can be used as the PtsTy of a PTS implementation.
+class AdaptivePointsToSet {
+ public:
+  using ElemTy = uint32_t;
+
+  // sets with at most this many elements are stored inline
+  static constexpr uint32_t SMALL_SIZE = 4;
+  // number of words in a chunk of a sparse set
+  static constexpr uint32_t CHUNK_WORDS = 4;
+
+  enum class Kind : uint8_t { Small, Dense, Sparse };
+
+  // iterate the elements in increasing order
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ElemTy;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const ElemTy *;
+    using reference = const ElemTy &;
+
+    iterator() = default;
+
+    reference operator*() const { return value; }
+
+    iterator &operator++() {
+      advance();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator tmp = *this;
+      advance();
+      return tmp;
+    }
+
+    bool operator==(const iterator &other) const {
+      return set == other.set && block == other.block && word == other.word && bits == other.bits;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+
+   private:
+    friend class AdaptivePointsToSet;
+
+    const AdaptivePointsToSet *set = nullptr;
+    // Small: index of the element, otherwise index of the block
+    size_t block = 0;
+    // index of the current word in the block
+    size_t word = 0;
+    // bits of the current word that are not visited yet
+    uint64_t bits = 0;
+    ElemTy value = 0;
+
+    iterator(const AdaptivePointsToSet *set, size_t block) : set(set), block(block) {}
+
+    // move to the next set bit, starting from the unvisited bits of the current word
+    void advance();
+  };
+
+  AdaptivePointsToSet() = default;
+
+  [[nodiscard]] inline Kind getKind() const { return kind; }
+
+  [[nodiscard]] bool test(ElemTy elem) const;
+  void set(ElemTy elem) { test_and_set(elem); }
+  // set the element, return whether it was not in the set
+  bool test_and_set(ElemTy elem);
+  void reset(ElemTy elem);
+
+  [[nodiscard]] inline bool empty() const { return kind == Kind::Small && smallSize == 0; }
+  [[nodiscard]] size_t count() const;
+  void clear();
+
+  // union, return whether this set changed
+  bool operator|=(const AdaptivePointsToSet &other);
+  // intersection, return whether this set changed
+  bool operator&=(const AdaptivePointsToSet &other);
+  // this = lhs - rhs
+  void intersectWithComplement(const AdaptivePointsToSet &lhs, const AdaptivePointsToSet &rhs);
+
+  [[nodiscard]] bool intersects(const AdaptivePointsToSet &other) const;
+  // whether the two sets share an element that is not smaller than from
+  [[nodiscard]] bool intersectsFrom(const AdaptivePointsToSet &other, ElemTy from) const;
+  // whether this is a superset of other
+  [[nodiscard]] bool contains(const AdaptivePointsToSet &other) const;
+
+  bool operator==(const AdaptivePointsToSet &other) const;
+  bool operator!=(const AdaptivePointsToSet &other) const { return !(*this == other); }
+
+  [[nodiscard]] iterator begin() const;
+  [[nodiscard]] iterator end() const;
+
+ private:
+  Kind kind = Kind::Small;
+  uint8_t smallSize = 0;
+  // Dense: index of the first word
+  uint32_t baseWord = 0;
+  ElemTy small[SMALL_SIZE] = {};
+  // Dense: the bitmap
+  // Sparse: chunks sorted by index, each is one word holding the chunk index followed by CHUNK_WORDS words of bits
+  std::vector<uint64_t> words;
+
+  static constexpr uint32_t CHUNK_STRIDE = CHUNK_WORDS + 1;
+
+  // Dense and Sparse sets are a list of blocks of consecutive words, a dense set has (at most) one block
+  [[nodiscard]] inline size_t numBlocks() const {
+    if (kind == Kind::Dense) return words.empty() ? 0 : 1;
+    return words.size() / CHUNK_STRIDE;
+  }
+  // index of the first word of the block
+  [[nodiscard]] inline uint64_t blockBase(size_t block) const {
+    return kind == Kind::Dense ? baseWord : words[block * CHUNK_STRIDE] * CHUNK_WORDS;
+  }
+  [[nodiscard]] inline size_t blockSize(size_t /* block */) const {
+    return kind == Kind::Dense ? words.size() : CHUNK_WORDS;
+  }
+  [[nodiscard]] inline const uint64_t *blockWords(size_t block) const {
+    return kind == Kind::Dense ? words.data() : words.data() + block * CHUNK_STRIDE + 1;
+  }
+  [[nodiscard]] inline uint64_t *blockWords(size_t block) {
+    return kind == Kind::Dense ? words.data() : words.data() + block * CHUNK_STRIDE + 1;
+  }
+
+  template <typename Set, typename OnBoth, typename OnlyLhs>
+  static bool walkWords(Set &lhs, const AdaptivePointsToSet &rhs, OnBoth onBoth, OnlyLhs onlyLhs);
+
+  // rebuild the set from sorted, unique elements
+  void assignSorted(const std::vector<ElemTy> &elems);
+  [[nodiscard]] std::vector<ElemTy> toVector() const;
+
+  void toDense();
+  void toSparse();
+  // drop empty words/chunks, then pick the layout that fits the elements best
+  void normalize();
+  // pick between dense and sparse after the set grew
+  void adjustLayout();
+
+  // the position of the chunk with the index, or of the first chunk after it
+  [[nodiscard]] size_t findChunk(uint64_t index) const;
+  // number of CHUNK_WORDS aligned chunks a dense set touches
+  [[nodiscard]] size_t countDenseChunks() const;
+
+  bool sparseUnion(const AdaptivePointsToSet &other);
+  bool denseUnion(const AdaptivePointsToSet &other);
+  // this -= other, return whether this set changed
+  bool subtract(const AdaptivePointsToSet &other);
+};
+
+}  // namespace pta
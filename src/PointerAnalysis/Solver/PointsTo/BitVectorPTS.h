@@ -26,108 +26,118 @@ class BitVectorPTS {
   using PtsTy = llvm::SparseBitVector<>;
   using iterator = PtsTy::iterator;
 
-  static std::vector<PtsTy> ptsVec;
-  // ptsVec[20] ==> SparseBitVector ==> "010000..."
+  struct State {
+    std::vector<PtsTy> ptsVec;
+    // ptsVec[20] ==> SparseBitVector ==> "010000..."
+  };
+
+  // the pts of every node, in the state bound to the calling thread
+  static inline std::vector<PtsTy>& ptsVec() { return ThreadBound<State>::get().ptsVec; }
 
   static inline void onNewNodeCreation(NodeID id) {
     // should be the same value
     // int ** ptr = (int **) malloc(sizeof(int *)); // o1
     // *ptr = &o2; // ptr
-    assert(id == ptsVec.size());
-    ptsVec.emplace_back();
-    assert(ptsVec.size() == (id + 1));
+    assert(id == ptsVec().size());
+    ptsVec().emplace_back();
+    assert(ptsVec().size() == (id + 1));
   }
 
-  static inline void clearAll() { ptsVec.clear(); }
+  static inline void clearAll() { ptsVec().clear(); }
+
+  // every node owns its set, there is nothing to collect
+  static inline void collectGarbage() {}
 
   // get the pts of the corresponding node
   [[nodiscard]] static inline const PtsTy& getPointsTo(NodeID id) {
-    assert(id < ptsVec.size());
-    return ptsVec[id];
+    assert(id < ptsVec().size());
+    return ptsVec()[id];
   }
 
   // union the pts of the nodes
   static inline bool unionWith(NodeID src, NodeID dst) {
-    assert(src < ptsVec.size() && dst < ptsVec.size());
+    assert(src < ptsVec().size() && dst < ptsVec().size());
 
-    bool r = ptsVec[src] |= ptsVec[dst];
+    bool r = ptsVec()[src] |= ptsVec()[dst];
     // bz: this has no problem, but compiler won't git up warnings ... so translate equivalently
     // assert(ptsVec[src].find_last() < 0 ? true : ptsVec[src].find_last() < ptsVec.size());
-    int _last = ptsVec[src].find_last();
+    int _last = ptsVec()[src].find_last();
     if (_last >= 0) {
       long unsigned int last = static_cast<long unsigned int>(_last);
-      assert(last < ptsVec.size());
+      assert(last < ptsVec().size());
     }
     return r;
   }
 
+  // union the given set into the pts of the node
+  static inline bool unionWithPts(NodeID src, const PtsTy& pts) {
+    assert(src < ptsVec().size());
+    return ptsVec()[src] |= pts;
+  }
+
   // whether the two pts intersect
   [[nodiscard]] static inline bool intersectWith(NodeID src, NodeID dst) {
-    assert(src < ptsVec.size() && dst < ptsVec.size());
-    return ptsVec[src].intersects(ptsVec[dst]);
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src].intersects(ptsVec()[dst]);
   }
 
   [[nodiscard]] static inline bool intersectWithNoSpecialNode(NodeID src, NodeID dst) {
-    assert(src < ptsVec.size() && dst < ptsVec.size());
-    auto result = ptsVec[src] & ptsVec[dst];
-
-    for (unsigned i = 0; i < NORMAL_OBJ_START_ID; i++) {
-      // remove special node
-      result.reset(i);
-    }
-
-    return !result.empty();
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    if (!ptsVec()[src].intersects(ptsVec()[dst])) return false;
+    // the special nodes have the smallest ids, so it is enough to look at the largest common element
+    auto const result = ptsVec()[src] & ptsVec()[dst];
+    return result.find_last() >= static_cast<int>(NORMAL_OBJ_START_ID);
   }
 
   // insert a node into the pts
   static inline bool insert(NodeID src, TargetID idx) {
-    assert(src < ptsVec.size() && idx < ptsVec.size());
+    assert(src < ptsVec().size() && idx < ptsVec().size());
 
     // JEFF TODO: check if they have the same type?
-    return ptsVec[src].test_and_set(idx);
+    return ptsVec()[src].test_and_set(idx);
   }
 
   // Return true if this has idx as an element
   [[nodiscard]] static inline bool has(NodeID src, TargetID idx) {
-    assert(src < ptsVec.size() && idx < ptsVec.size());
-    return ptsVec[src].test(idx);
+    assert(src < ptsVec().size() && idx < ptsVec().size());
+    return ptsVec()[src].test(idx);
   }
 
   [[nodiscard]] static inline bool equal(NodeID src, NodeID dst) {
-    assert(src < ptsVec.size() && dst < ptsVec.size());
-    return ptsVec[src] == ptsVec[dst];
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src] == ptsVec()[dst];
   }
 
   // Return true if *this is a superset of other
   [[nodiscard]] static inline bool contains(NodeID src, NodeID dst) {
-    assert(src < ptsVec.size() && dst < ptsVec.size());
-    return ptsVec[src].contains(ptsVec[dst]);
+    assert(src < ptsVec().size() && dst < ptsVec().size());
+    return ptsVec()[src].contains(ptsVec()[dst]);
   }
 
   [[nodiscard]] static inline bool isEmpty(NodeID id) {
-    assert(id < ptsVec.size());
-    return ptsVec[id].empty();
+    assert(id < ptsVec().size());
+    return ptsVec()[id].empty();
   }
 
   [[nodiscard]] static inline iterator begin(NodeID id) {
-    assert(id < ptsVec.size());
-    assert(*ptsVec[id].begin() < ptsVec.size());
-    return ptsVec[id].begin();
+    assert(id < ptsVec().size());
+    assert(*ptsVec()[id].begin() < ptsVec().size());
+    return ptsVec()[id].begin();
   }
 
   [[nodiscard]] static inline iterator end(NodeID id) {
-    assert(id < ptsVec.size());
-    return ptsVec[id].end();
+    assert(id < ptsVec().size());
+    return ptsVec()[id].end();
   }
 
   static inline void clear(NodeID id) {
-    assert(id < ptsVec.size());
-    ptsVec[id].clear();
+    assert(id < ptsVec().size());
+    ptsVec()[id].clear();
   }
 
   static inline size_t count(NodeID id) {
-    assert(id < ptsVec.size());
-    return ptsVec[id].count();
+    assert(id < ptsVec().size());
+    return ptsVec()[id].count();
   }
 
   static inline const PtsTy& getPointedBy(NodeID /*id*/) {
@@ -138,6 +148,9 @@ class BitVectorPTS {
   // pointed by information
   static inline constexpr bool supportPointedBy() { return false; }
 
+  // the pts of different nodes are independent
+  static inline constexpr bool supportConcurrentUpdate() { return true; }
+
   friend class PTSTrait<BitVectorPTS>;
 };
 
@@ -12,6 +12,7 @@ limitations under the License.
 #pragma once
 
 #include "PointerAnalysis/Graph/NodeID.def"
+#include "PointerAnalysis/Util/ThreadBound.h"
 
 namespace pta {
 
@@ -23,21 +24,33 @@ struct PTSTrait {
   using PtsTy = typename Pts::UnknownTypeError;
   // iterator type
   using iterator = typename Pts::UnknownTypeError;
+  // the points-to sets of one PTA, the static functions below work on the state bound to the calling thread
+  using State = typename Pts::UnknownTypeError;
+  using Scope = typename ThreadBound<State>::Scope;
+
+  static inline Scope bind(State& state) { return Scope(state); }
 
   static inline void clearAll() { return Pts::unKnownMethodError; }
 
+  // free the memory of sets no node refers to any more, only called between solver rounds
+  static inline void collectGarbage() { return Pts::unKnownMethodError; }
+
   static inline void onNewNodeCreation(NodeID id) { return Pts::unKnownMethodError(id); }
 
   static inline const PtsTy& getPointsTo(NodeID id) { return Pts::unKnownMethodError(id); }
 
   static inline bool unionWith(NodeID src, NodeID dst) { return Pts::unKnownMethodError(src, dst); }
 
+  static inline bool unionWithPts(NodeID src, const PtsTy& pts) { return Pts::unKnownMethodError(src, pts); }
+
   static inline bool intersectWith(NodeID src, NodeID dst) { return Pts::unKnownMethodError(src, dst); }
 
   static inline bool intersectWithNoSpecialNode(NodeID src, NodeID dst) { return Pts::unKnownMethodError(src, dst); }
 
   static inline bool insert(NodeID src, TargetID idx) { return Pts::unKnownMethodError(src, idx); }
 
+  // only for the solver: SparseBitVector::test moves a cached iterator, so this may write to the set.
+  // The other functions that do not update the sets only read them, and can run on many threads at once
   static inline bool has(NodeID src, TargetID idx) { return Pts::unKnownMethodError(src, idx); }
 
   static inline bool contains(NodeID src, NodeID dst) { return Pts::unKnownMethodError(src, dst); }
@@ -55,6 +68,9 @@ struct PTSTrait {
   static inline const PtsTy& getPointedBy(NodeID id) { return Pts::unKnownMethodError(id); }
 
   static inline constexpr bool supportPointedBy() { return Pts::unknownBool; }
+
+  // whether the pts of different nodes can be updated by different threads at the same time
+  static inline constexpr bool supportConcurrentUpdate() { return Pts::unknownBool; }
 };
 
 }  // namespace pta
@@ -66,14 +82,23 @@ struct PTSTrait {
                                                                                                        \
     using PtsTy = typename IMPL::PtsTy;                                                                \
     using iterator = typename IMPL::iterator;                                                          \
+    using State = typename IMPL::State;                                                                \
+    using Scope = typename ThreadBound<State>::Scope;                                                  \
+                                                                                                       \
+    static inline Scope bind(State& state) { return Scope(state); }                                    \
                                                                                                        \
     static inline void clearAll() { return IMPL::clearAll(); }                                         \
+    static inline void collectGarbage() { return IMPL::collectGarbage(); }                             \
     static inline void onNewNodeCreation(NodeID id) { return IMPL::onNewNodeCreation(id); }            \
                                                                                                        \
     static inline const PtsTy& getPointsTo(NodeID id) { return IMPL::getPointsTo(id); }                \
                                                                                                        \
     static inline bool unionWith(NodeID src, NodeID dst) { return IMPL::unionWith(src, dst); }         \
                                                                                                        \
+    static inline bool unionWithPts(NodeID src, const PtsTy& pts) {                                    \
+      return IMPL::unionWithPts(src, pts);                                                             \
+    }                                                                                                  \
+                                                                                                       \
     static inline bool intersectWith(NodeID src, NodeID dst) { return IMPL::intersectWith(src, dst); } \
                                                                                                        \
     static inline bool intersectWithNoSpecialNode(NodeID src, NodeID dst) {                            \
@@ -98,6 +123,8 @@ struct PTSTrait {
                                                                                                        \
     static inline constexpr bool supportPointedBy() { return IMPL::supportPointedBy(); }               \
                                                                                                        \
+    static inline constexpr bool supportConcurrentUpdate() { return IMPL::supportConcurrentUpdate(); } \
+                                                                                                       \
     static inline bool equal(NodeID src, NodeID dst) { return IMPL::equal(src, dst); }                 \
                                                                                                        \
     static inline const PtsTy& getPointedBy(NodeID id) {                                               \
@@ -0,0 +1,274 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// the pts data structure that shares identical points-to sets between nodes
+#pragma once
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/SparseBitVector.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "PointerAnalysis/Solver/PointsTo/PTSTrait.h"
+
+namespace pta {
+
+// Every distinct points-to set is stored once in a pool (hash-consed) and nodes only hold the 32-bit id of their set.
+// Nodes along copy chains or pointing to the same allocation site end up sharing one set, equality is an id
+// comparison, and the result of every union of two sets is memoized.
+// Sets that no node refers to any more are only dropped by collectGarbage, once the pool has doubled since the last
+// collection. So the pool is at most about twice the size of the live sets, for a cost that is linear in the number
+// of sets created.
+class PersistentPTS {
+ private:
+  using TargetID = NodeID;
+  using PtsTy = llvm::SparseBitVector<>;
+  using iterator = PtsTy::iterator;
+  using SetID = uint32_t;
+
+  static constexpr SetID EMPTY_SET = 0;
+  static constexpr SetID INVALID_SET = std::numeric_limits<SetID>::max();
+  // pool size of the first collection, smaller programs never pay for one
+  static constexpr size_t FIRST_COLLECTION = 1 << 16;
+
+  [[nodiscard]] static inline size_t hashSet(const PtsTy& set) {
+    return llvm::hash_combine_range(set.begin(), set.end());
+  }
+
+  struct State {
+    // the set of every node
+    std::vector<SetID> nodeSets;
+    // every distinct set, indexed by SetID (deque, so references to the sets stay valid as the pool grows)
+    std::deque<PtsTy> pool{PtsTy()};
+    // hash of a set -> ids of the sets with that hash
+    std::unordered_map<size_t, llvm::SmallVector<SetID, 1>> setIDs{{hashSet(PtsTy()), {EMPTY_SET}}};
+    // (smaller, larger) SetID -> SetID of their union
+    llvm::DenseMap<std::pair<SetID, SetID>, SetID> unionCache;
+    // pool size that triggers the next collection
+    size_t collectAt = FIRST_COLLECTION;
+  };
+
+  // in the state bound to the calling thread
+  static inline std::vector<SetID>& nodeSets() { return ThreadBound<State>::get().nodeSets; }
+  static inline std::deque<PtsTy>& pool() { return ThreadBound<State>::get().pool; }
+  static inline std::unordered_map<size_t, llvm::SmallVector<SetID, 1>>& setIDs() {
+    return ThreadBound<State>::get().setIDs;
+  }
+  static inline llvm::DenseMap<std::pair<SetID, SetID>, SetID>& unionCache() {
+    return ThreadBound<State>::get().unionCache;
+  }
+
+  // return the id of the set, adding it to the pool if it is new
+  static SetID intern(PtsTy&& set) {
+    auto& candidates = setIDs()[hashSet(set)];
+    for (SetID id : candidates) {
+      if (pool()[id] == set) {
+        return id;
+      }
+    }
+    auto const id = static_cast<SetID>(pool().size());
+    pool().push_back(std::move(set));
+    candidates.push_back(id);
+    return id;
+  }
+
+  static SetID unionSets(SetID lhs, SetID rhs) {
+    if (lhs > rhs) {
+      std::swap(lhs, rhs);
+    }
+    auto it = unionCache().find({lhs, rhs});
+    if (it != unionCache().end()) {
+      return it->second;
+    }
+    PtsTy result = pool()[lhs];
+    result |= pool()[rhs];
+    auto const id = intern(std::move(result));
+    unionCache()[{lhs, rhs}] = id;
+    return id;
+  }
+
+  // replace the set of the node, return whether it changed
+  static inline bool update(NodeID id, SetID set) {
+    if (nodeSets()[id] == set) {
+      return false;
+    }
+    nodeSets()[id] = set;
+    return true;
+  }
+
+  static inline void onNewNodeCreation(NodeID id) {
+    assert(id == nodeSets().size());
+    nodeSets().push_back(EMPTY_SET);
+  }
+
+  static inline void clearAll() {
+    nodeSets().clear();
+    pool().clear();
+    setIDs().clear();
+    unionCache().clear();
+    ThreadBound<State>::get().collectAt = FIRST_COLLECTION;
+    intern(PtsTy());
+  }
+
+  static inline void collectGarbage() {
+    if (pool().size() >= ThreadBound<State>::get().collectAt) {
+      compact();
+    }
+  }
+
+  // get the pts of the corresponding node
+  [[nodiscard]] static inline const PtsTy& getPointsTo(NodeID id) {
+    assert(id < nodeSets().size());
+    return pool()[nodeSets()[id]];
+  }
+
+  // union the pts of the nodes
+  static inline bool unionWith(NodeID src, NodeID dst) {
+    assert(src < nodeSets().size() && dst < nodeSets().size());
+    auto const lhs = nodeSets()[src];
+    auto const rhs = nodeSets()[dst];
+    if (lhs == rhs || rhs == EMPTY_SET) {
+      return false;
+    }
+    return update(src, unionSets(lhs, rhs));
+  }
+
+  // union the given set into the pts of the node
+  static inline bool unionWithPts(NodeID src, const PtsTy& pts) {
+    assert(src < nodeSets().size());
+    const PtsTy& cur = pool()[nodeSets()[src]];
+    if (cur.contains(pts)) {
+      return false;
+    }
+    PtsTy result = cur;
+    result |= pts;
+    return update(src, intern(std::move(result)));
+  }
+
+  // whether the two pts intersect
+  [[nodiscard]] static inline bool intersectWith(NodeID src, NodeID dst) {
+    assert(src < nodeSets().size() && dst < nodeSets().size());
+    return getPointsTo(src).intersects(getPointsTo(dst));
+  }
+
+  [[nodiscard]] static inline bool intersectWithNoSpecialNode(NodeID src, NodeID dst) {
+    assert(src < nodeSets().size() && dst < nodeSets().size());
+    if (!getPointsTo(src).intersects(getPointsTo(dst))) return false;
+    // the special nodes have the smallest ids, so it is enough to look at the largest common element
+    auto const result = getPointsTo(src) & getPointsTo(dst);
+    return result.find_last() >= static_cast<int>(NORMAL_OBJ_START_ID);
+  }
+
+  // insert a node into the pts
+  static inline bool insert(NodeID src, TargetID idx) {
+    assert(src < nodeSets().size());
+    if (getPointsTo(src).test(idx)) {
+      return false;
+    }
+    PtsTy result = getPointsTo(src);
+    result.set(idx);
+    return update(src, intern(std::move(result)));
+  }
+
+  // Return true if this has idx as an element
+  [[nodiscard]] static inline bool has(NodeID src, TargetID idx) {
+    assert(src < nodeSets().size());
+    return getPointsTo(src).test(idx);
+  }
+
+  // identical sets share the same id
+  [[nodiscard]] static inline bool equal(NodeID src, NodeID dst) {
+    assert(src < nodeSets().size() && dst < nodeSets().size());
+    return nodeSets()[src] == nodeSets()[dst];
+  }
+
+  // Return true if *this is a superset of other
+  [[nodiscard]] static inline bool contains(NodeID src, NodeID dst) {
+    assert(src < nodeSets().size() && dst < nodeSets().size());
+    return nodeSets()[src] == nodeSets()[dst] || getPointsTo(src).contains(getPointsTo(dst));
+  }
+
+  [[nodiscard]] static inline bool isEmpty(NodeID id) {
+    assert(id < nodeSets().size());
+    return nodeSets()[id] == EMPTY_SET;
+  }
+
+  [[nodiscard]] static inline iterator begin(NodeID id) { return getPointsTo(id).begin(); }
+
+  [[nodiscard]] static inline iterator end(NodeID id) { return getPointsTo(id).end(); }
+
+  static inline void clear(NodeID id) {
+    assert(id < nodeSets().size());
+    nodeSets()[id] = EMPTY_SET;
+  }
+
+  static inline size_t count(NodeID id) { return getPointsTo(id).count(); }
+
+  static inline const PtsTy& getPointedBy(NodeID /*id*/) {
+    llvm_unreachable("not supported by PersistentPTS, use PointedByPts instead");
+  }
+
+  static inline constexpr bool supportPointedBy() { return false; }
+
+  // nodes share the pool, so two nodes can not be updated concurrently
+  static inline constexpr bool supportConcurrentUpdate() { return false; }
+
+  friend class PTSTrait<PersistentPTS>;
+
+ public:
+  // number of distinct sets in the pool
+  [[nodiscard]] static inline size_t poolSize() { return pool().size(); }
+
+  // drop every set no node refers to and renumber the rest, no set may be referenced while this runs
+  static void compact() {
+    auto& state = ThreadBound<State>::get();
+    std::vector<SetID> newIDs(state.pool.size(), INVALID_SET);
+    std::deque<PtsTy> live{PtsTy()};
+    newIDs[EMPTY_SET] = EMPTY_SET;
+    for (auto& set : state.nodeSets) {
+      if (newIDs[set] == INVALID_SET) {
+        newIDs[set] = static_cast<SetID>(live.size());
+        live.push_back(std::move(state.pool[set]));
+      }
+      set = newIDs[set];
+    }
+    state.pool = std::move(live);
+
+    state.setIDs.clear();
+    for (SetID id = 0; id < state.pool.size(); id++) {
+      state.setIDs[hashSet(state.pool[id])].push_back(id);
+    }
+
+    // keep the memoized unions of sets that are still alive
+    llvm::DenseMap<std::pair<SetID, SetID>, SetID> unionCache;
+    for (auto const& [operands, result] : state.unionCache) {
+      auto const lhs = newIDs[operands.first];
+      auto const rhs = newIDs[operands.second];
+      auto const id = newIDs[result];
+      if (lhs != INVALID_SET && rhs != INVALID_SET && id != INVALID_SET) {
+        unionCache[{std::min(lhs, rhs), std::max(lhs, rhs)}] = id;
+      }
+    }
+    state.unionCache = std::move(unionCache);
+
+    state.collectAt = std::max(FIRST_COLLECTION, 2 * state.pool.size());
+  }
+};
+
+}  // namespace pta
+
+DEFINE_PTS_TRAIT(pta::PersistentPTS)
@@ -0,0 +1,281 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Solver/PointsTo/SetKernels.h"
+
+// SSE2 is only guaranteed on x86-64, 32-bit x86 uses the plain loops
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define PTA_X86_KERNELS
+#endif
+
+using namespace pta;
+
+namespace {
+
+bool unionScalar(uint64_t *dst, const uint64_t *src, size_t n) {
+  uint64_t changed = 0;
+  for (size_t i = 0; i < n; i++) {
+    auto const word = dst[i] | src[i];
+    changed |= word ^ dst[i];
+    dst[i] = word;
+  }
+  return changed != 0;
+}
+
+bool intersectScalar(uint64_t *dst, const uint64_t *src, size_t n) {
+  uint64_t changed = 0;
+  for (size_t i = 0; i < n; i++) {
+    auto const word = dst[i] & src[i];
+    changed |= word ^ dst[i];
+    dst[i] = word;
+  }
+  return changed != 0;
+}
+
+bool subtractScalar(uint64_t *dst, const uint64_t *src, size_t n) {
+  uint64_t changed = 0;
+  for (size_t i = 0; i < n; i++) {
+    auto const word = dst[i] & ~src[i];
+    changed |= word ^ dst[i];
+    dst[i] = word;
+  }
+  return changed != 0;
+}
+
+bool intersectsScalar(const uint64_t *lhs, const uint64_t *rhs, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if ((lhs[i] & rhs[i]) != 0) return true;
+  }
+  return false;
+}
+
+bool containsScalar(const uint64_t *super, const uint64_t *sub, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if ((sub[i] & ~super[i]) != 0) return false;
+  }
+  return true;
+}
+
+bool isZeroScalar(const uint64_t *words, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (words[i] != 0) return false;
+  }
+  return true;
+}
+
+#ifdef PTA_X86_KERNELS
+
+// The vector loops handle whole vectors and leave the remaining (< 4 or < 2) words to the scalar versions.
+
+enum class Op { Union, Intersect, Subtract };
+
+// dst = op(dst, src) over whole __m256i, return whether dst changed
+template <Op op>
+__attribute__((target("avx2"))) bool updateAVX2(uint64_t *dst, const uint64_t *src, size_t &i, size_t n) {
+  __m256i changed = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    auto const lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    auto const rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i word;
+    if constexpr (op == Op::Union) {
+      word = _mm256_or_si256(lhs, rhs);
+    } else if constexpr (op == Op::Intersect) {
+      word = _mm256_and_si256(lhs, rhs);
+    } else {
+      // andnot(a, b) computes ~a & b
+      word = _mm256_andnot_si256(rhs, lhs);
+    }
+    changed = _mm256_or_si256(changed, _mm256_xor_si256(word, lhs));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), word);
+  }
+  return !_mm256_testz_si256(changed, changed);
+}
+
+__attribute__((target("avx2"))) bool unionAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateAVX2<Op::Union>(dst, src, i, n);
+  return unionScalar(dst + i, src + i, n - i) || changed;
+}
+
+__attribute__((target("avx2"))) bool intersectAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateAVX2<Op::Intersect>(dst, src, i, n);
+  return intersectScalar(dst + i, src + i, n - i) || changed;
+}
+
+__attribute__((target("avx2"))) bool subtractAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateAVX2<Op::Subtract>(dst, src, i, n);
+  return subtractScalar(dst + i, src + i, n - i) || changed;
+}
+
+__attribute__((target("avx2"))) bool intersectsAVX2(const uint64_t *lhs, const uint64_t *rhs, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto const a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    auto const b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    if (!_mm256_testz_si256(a, b)) return true;
+  }
+  return intersectsScalar(lhs + i, rhs + i, n - i);
+}
+
+__attribute__((target("avx2"))) bool containsAVX2(const uint64_t *super, const uint64_t *sub, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto const a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(super + i));
+    auto const b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sub + i));
+    // testc(a, b) is true iff (~a & b) == 0
+    if (!_mm256_testc_si256(a, b)) return false;
+  }
+  return containsScalar(super + i, sub + i, n - i);
+}
+
+__attribute__((target("avx2"))) bool isZeroAVX2(const uint64_t *words, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto const a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+    if (!_mm256_testz_si256(a, a)) return false;
+  }
+  return isZeroScalar(words + i, n - i);
+}
+
+// SSE2 has no ptest, compare against zero instead
+inline bool isZeroSSE2(__m128i word) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(word, _mm_setzero_si128())) == 0xFFFF;
+}
+
+template <Op op>
+bool updateSSE2(uint64_t *dst, const uint64_t *src, size_t &i, size_t n) {
+  __m128i changed = _mm_setzero_si128();
+  for (; i + 2 <= n; i += 2) {
+    auto const lhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    auto const rhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i word;
+    if constexpr (op == Op::Union) {
+      word = _mm_or_si128(lhs, rhs);
+    } else if constexpr (op == Op::Intersect) {
+      word = _mm_and_si128(lhs, rhs);
+    } else {
+      word = _mm_andnot_si128(rhs, lhs);
+    }
+    changed = _mm_or_si128(changed, _mm_xor_si128(word, lhs));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), word);
+  }
+  return !isZeroSSE2(changed);
+}
+
+bool unionSSE2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateSSE2<Op::Union>(dst, src, i, n);
+  return unionScalar(dst + i, src + i, n - i) || changed;
+}
+
+bool intersectSSE2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateSSE2<Op::Intersect>(dst, src, i, n);
+  return intersectScalar(dst + i, src + i, n - i) || changed;
+}
+
+bool subtractSSE2(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+  bool changed = updateSSE2<Op::Subtract>(dst, src, i, n);
+  return subtractScalar(dst + i, src + i, n - i) || changed;
+}
+
+bool intersectsSSE2(const uint64_t *lhs, const uint64_t *rhs, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto const a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+    auto const b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+    if (!isZeroSSE2(_mm_and_si128(a, b))) return true;
+  }
+  return intersectsScalar(lhs + i, rhs + i, n - i);
+}
+
+bool containsSSE2(const uint64_t *super, const uint64_t *sub, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto const a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(super + i));
+    auto const b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sub + i));
+    if (!isZeroSSE2(_mm_andnot_si128(a, b))) return false;
+  }
+  return containsScalar(super + i, sub + i, n - i);
+}
+
+bool isZeroSSE2(const uint64_t *words, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    if (!isZeroSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i)))) return false;
+  }
+  return isZeroScalar(words + i, n - i);
+}
+
+#endif
+
+struct Kernels {
+  bool (*unionWords)(uint64_t *, const uint64_t *, size_t);
+  bool (*intersectWords)(uint64_t *, const uint64_t *, size_t);
+  bool (*subtractWords)(uint64_t *, const uint64_t *, size_t);
+  bool (*intersectsWords)(const uint64_t *, const uint64_t *, size_t);
+  bool (*containsWords)(const uint64_t *, const uint64_t *, size_t);
+  bool (*isZeroWords)(const uint64_t *, size_t);
+};
+
+Kernels selectKernels() {
+#ifdef PTA_X86_KERNELS
+  if (__builtin_cpu_supports("avx2")) {
+    return {unionAVX2, intersectAVX2, subtractAVX2, intersectsAVX2, containsAVX2, isZeroAVX2};
+  }
+  // every x86-64 CPU has SSE2
+  return {unionSSE2, intersectSSE2, subtractSSE2, intersectsSSE2, containsSSE2, isZeroSSE2};
+#else
+  return {unionScalar, intersectScalar, subtractScalar, intersectsScalar, containsScalar, isZeroScalar};
+#endif
+}
+
+// Picked on first use rather than during static initialization, so sets built by other static initializers already
+// get the right kernels. The initialization of a function-local static is thread safe.
+const Kernels &getKernels() {
+  static const Kernels kernels = selectKernels();
+  return kernels;
+}
+
+}  // namespace
+
+bool simd::unionWords(uint64_t *dst, const uint64_t *src, size_t n) { return getKernels().unionWords(dst, src, n); }
+
+bool simd::intersectWords(uint64_t *dst, const uint64_t *src, size_t n) {
+  return getKernels().intersectWords(dst, src, n);
+}
+
+bool simd::subtractWords(uint64_t *dst, const uint64_t *src, size_t n) {
+  return getKernels().subtractWords(dst, src, n);
+}
+
+bool simd::intersectsWords(const uint64_t *lhs, const uint64_t *rhs, size_t n) {
+  return getKernels().intersectsWords(lhs, rhs, n);
+}
+
+bool simd::containsWords(const uint64_t *super, const uint64_t *sub, size_t n) {
+  return getKernels().containsWords(super, sub, n);
+}
+
+bool simd::isZeroWords(const uint64_t *words, size_t n) { return getKernels().isZeroWords(words, n); }
+
+// There is no SSE2/AVX2 popcount, so this is the same loop on every CPU
+size_t simd::countWords(const uint64_t *words, size_t n) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += static_cast<size_t>(__builtin_popcountll(words[i]));
+  }
+  return count;
+}
@@ -0,0 +1,43 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pta::simd {
+
+// On x86-64 the kernels use AVX2 or SSE2 depending on the running CPU (picked on first use), elsewhere plain loops.
+// countWords is always a scalar popcount loop. All pointers may be unaligned, and dst may not overlap src.
+
+// dst[i] |= src[i], return whether dst changed
+bool unionWords(uint64_t *dst, const uint64_t *src, size_t n);
+
+// dst[i] &= src[i], return whether dst changed
+bool intersectWords(uint64_t *dst, const uint64_t *src, size_t n);
+
+// dst[i] &= ~src[i], return whether dst changed
+bool subtractWords(uint64_t *dst, const uint64_t *src, size_t n);
+
+// whether (lhs[i] & rhs[i]) != 0 for any i
+[[nodiscard]] bool intersectsWords(const uint64_t *lhs, const uint64_t *rhs, size_t n);
+
+// whether every bit of sub is also set in super
+[[nodiscard]] bool containsWords(const uint64_t *super, const uint64_t *sub, size_t n);
+
+// whether every word is zero
+[[nodiscard]] bool isZeroWords(const uint64_t *words, size_t n);
+
+// number of bits set, not vectorized
+[[nodiscard]] size_t countWords(const uint64_t *words, size_t n);
+
+}  // namespace pta::simd
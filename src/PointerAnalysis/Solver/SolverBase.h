@@ -18,16 +18,28 @@ limitations under the License.
 #include <llvm/IR/Module.h>
 #include <llvm/Pass.h>
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
 //#include "RDUtil.h"
 #include "Logging/Log.h"
 #include "PointerAnalysis/Graph/CallGraph.h"
 #include "PointerAnalysis/Graph/ConstraintGraph/ConstraintGraph.h"
 #include "PointerAnalysis/Models/MemoryModel/MemModelTrait.h"
+#include "PointerAnalysis/Solver/AnalysisBudget.h"
+#include "PointerAnalysis/Program/Object.h"
 #include "PointerAnalysis/Solver/PointsTo/BitVectorPTS.h"
+#include "PointerAnalysis/Util/ThreadBound.h"
+#include "Util/WorkStealingPool.h"
 
 extern llvm::cl::opt<bool> ConfigPrintConstraintGraph;
 extern llvm::cl::opt<bool> ConfigPrintCallGraph;
 extern llvm::cl::opt<bool> ConfigDumpPointsToSet;
+extern llvm::cl::opt<unsigned> ConfigPTATimeBudget;
+extern llvm::cl::opt<unsigned> ConfigPTAMemBudget;
+extern llvm::cl::opt<bool> ConfigPTABudgetStopSolving;
 
 namespace pta {
 
@@ -36,13 +48,6 @@ class CallGraph;
 
 template <typename LangModel, typename SubClass>
 class SolverBase {
- private:
-  struct Noop {
-    template <typename... Args>
-    __attribute__((always_inline)) void operator()(Args &&...) {}
-  };
-  std::unique_ptr<LangModel> langModel;
-
  public:
   using LMT = LangModelTrait<LangModel>;
   using MemModel = typename LMT::MemModelTy;
@@ -53,6 +58,38 @@ class SolverBase {
 
  protected:
   using PT = PTSTrait<typename LMT::PointsToTy>;
+
+ private:
+  struct Noop {
+    template <typename... Args>
+    __attribute__((always_inline)) void operator()(Args &&...) {}
+  };
+
+  // the state the static traits keep for this PTA (points-to sets, contexts, object IDs), see bind().
+  // it is only modified while analyzing. The const queries only use the read-only PTSTrait functions, so they can run
+  // on many threads at once
+  mutable typename PT::State ptsState;
+  mutable typename CT::State ctxState;
+  mutable ObjectIDs objectIDs;
+  // contexts can still be evolved after the analysis, one thread at a time
+  mutable std::mutex contextLock;
+
+  std::unique_ptr<LangModel> langModel;
+
+ public:
+  struct Scope {
+    typename PT::Scope pts;
+    typename CT::Scope contexts;
+    typename ThreadBound<ObjectIDs>::Scope objects;
+  };
+
+  // Make the static traits work on the state of this PTA on the calling thread until the scope ends.
+  // The public functions of the PTA bind it themselves, this is only needed to use the traits directly.
+  [[nodiscard]] Scope bind() const {
+    return Scope{PT::bind(ptsState), CT::bind(ctxState), typename ThreadBound<ObjectIDs>::Scope(objectIDs)};
+  }
+
+ protected:
   using PtsTy = typename PT::PtsTy;
   using CallGraphTy = CallGraph<ctx>;
   using CallNodeTy = typename CallGraphTy::NodeType;
@@ -64,11 +101,148 @@ class SolverBase {
   ConsGraphTy *consGraph;
   llvm::SparseBitVector<> updatedFunPtrs;
 
-  // TODO: the intersection on pts should be done through PtsTrait for better extensibility
-  llvm::DenseMap<PtrNodeTy *, PtsTy> handledGEPMap;
+  // the part of every node's pts that has already been pushed along the node's outgoing edges (indexed by node id).
+  // solvers that use difference propagation only need to push pts(n) - propagatedPts[n] the next time n is visited.
+  // freed once solving is done
+  // TODO: the difference on pts should be done through PtsTrait for better extensibility
+  std::vector<PtsTy> propagatedPts;
+
+  // the objects added to the pts of the node since it was last marked as propagated
+  [[nodiscard]] PtsTy getDiffPts(NodeID id) {
+    if (id >= propagatedPts.size()) {
+      return PT::getPointsTo(id);
+    }
+    PtsTy diff;
+    diff.intersectWithComplement(PT::getPointsTo(id), propagatedPts[id]);
+    return diff;
+  }
+
+  inline void markPropagated(NodeID id, const PtsTy &diff) {
+    if (id >= propagatedPts.size()) {
+      propagatedPts.resize(id + 1);
+    }
+    propagatedPts[id] |= diff;
+  }
+
+  // the node is merged into superNode, which now owns its edges.
+  // only objects that were pushed along the edges of both nodes can be skipped afterwards
+  inline void mergePropagated(NodeID node, NodeID superNode) {
+    auto const size = std::max(node, superNode) + 1;
+    if (size > propagatedPts.size()) {
+      propagatedPts.resize(size);
+    }
+    propagatedPts[superNode] &= propagatedPts[node];
+    propagatedPts[node].clear();
+  }
+
+  // Every step gives up more precision to keep the analysis within its budget.
+  // Steps that do not apply to the context or memory model in use are skipped.
+  enum class Degradation : uint8_t {
+    None,
+    FreezeContexts,           // evolving a context keeps the previous one instead of creating a new context
+    FieldInsensitiveObjects,  // new objects are allocated as one field-insensitive object
+    CapAnonObjects,           // anonymous objects are created recursively as if ANON_REC_LIMIT=1
+    StopSolving,              // solving stops before reaching a fixed point, the points-to sets may be incomplete
+  };
+
+  // Memory does not shrink right after a step, and may never shrink (the step only slows down the growth), so a
+  // step taken because of memory is only followed by another once the step had this many rounds to act and memory
+  // still kept growing
+  static constexpr unsigned MEMORY_GRACE_ROUNDS = 3;
+
+  AnalysisBudget budget{0, 0};
+  Degradation degradation = Degradation::None;
+  // the steps taken so far and why, for the report
+  std::vector<std::string> degradations;
+  unsigned roundsSinceStep = 0;
+  size_t rssAtStep = 0;
+
+  // stopping early gives up soundness, so it is only done when asked for
+  [[nodiscard]] static Degradation getLastDegradation() {
+    return ConfigPTABudgetStopSolving ? Degradation::StopSolving : Degradation::CapAnonObjects;
+  }
+
+  void degrade(const std::string &reason) {
+    while (degradation < getLastDegradation()) {
+      degradation = static_cast<Degradation>(static_cast<uint8_t>(degradation) + 1);
+
+      std::string step;
+      switch (degradation) {
+        case Degradation::FreezeContexts:
+          if (CT::freeze()) {
+            step = "stopped creating new contexts";
+          }
+          break;
+        case Degradation::FieldInsensitiveObjects:
+          if (MMT::useFieldInsensitiveObjects(LMT::getMemModel(langModel.get()))) {
+            step = "allocated new objects field-insensitively";
+          }
+          break;
+        case Degradation::CapAnonObjects:
+          if (MMT::capAnonObjects(LMT::getMemModel(langModel.get()))) {
+            step = "capped recursively created anonymous objects (ANON_REC_LIMIT=1)";
+          }
+          break;
+        case Degradation::StopSolving:
+          step = "stopped solving before reaching a fixed point, points-to sets may be incomplete";
+          break;
+        default:
+          break;
+      }
+
+      if (!step.empty()) {
+        LOG_WARN("PTA {}, {}", reason, step);
+        degradations.push_back(reason + ": " + step);
+        return;
+      }
+    }
+  }
+
+  // Called by the solvers between rounds. Every call that finds the analysis over its time budget takes the next
+  // degradation step, so each step gets one round to take effect. Over the memory budget, see MEMORY_GRACE_ROUNDS.
+  // Returns true once the solver should stop.
+  bool checkBudget() {
+    // no points-to set is in use between rounds
+    PT::collectGarbage();
+    if (hasStopped()) {
+      return true;
+    }
+    if (!budget.isLimited()) {
+      return false;
+    }
+    roundsSinceStep++;
+
+    auto exceeded = budget.checkTimeExceeded();
+    if (exceeded.empty() && budget.isMemoryLimited()) {
+      auto const rss = AnalysisBudget::getCurrentRSSMB();
+      auto const stillGrowing =
+          degradation == Degradation::None || (roundsSinceStep >= MEMORY_GRACE_ROUNDS && rss > rssAtStep);
+      if (stillGrowing) {
+        exceeded = budget.checkMemoryExceeded(rss);
+      }
+    }
+
+    if (!exceeded.empty()) {
+      degrade(exceeded);
+      roundsSinceStep = 0;
+      rssAtStep = AnalysisBudget::getCurrentRSSMB();
+    }
+    return hasStopped();
+  }
+
+  [[nodiscard]] inline bool hasStopped() const { return degradation == Degradation::StopSolving; }
 
   inline void updateFunPtr(NodeID indirectNode) { updatedFunPtrs.set(indirectNode); }
 
+  // race::parallelForWorkStealing with this PTA bound to every worker
+  template <typename Body>
+  void parallelFor(size_t jobs, size_t numTasks, Body body) const {
+    race::parallelForWorkStealing(jobs, numTasks, [&](size_t worker, size_t i) {
+      auto const scope = bind();
+      body(worker, i);
+    });
+  }
+
   inline bool resolveFunPtrs() {
     if (updatedFunPtrs.empty()) {
       return false;
@@ -83,10 +257,17 @@ class SolverBase {
   // some helper function that might be needed by subclasses
   constexpr inline bool processAddrOf(CGNodeTy *src, CGNodeTy *dst) const;
   inline bool processCopy(CGNodeTy *src, CGNodeTy *dst);
+  // pts(dst) |= objs, where objs is a subset of pts(src)
+  inline bool processCopy(CGNodeTy *src, CGNodeTy *dst, const PtsTy &objs);
 
-  // TODO: only process diff pts
   template <typename CallBack = Noop>
   inline bool processOffset(CGNodeTy *src, CGNodeTy *dst, CallBack callBack = Noop{}) {
+    return processOffset(src, dst, PT::getPointsTo(src->getNodeID()), callBack);
+  }
+
+  // index the field of every object in objs (a subset of pts(src)) into dst
+  template <typename CallBack = Noop>
+  inline bool processOffset(CGNodeTy *src, CGNodeTy *dst, const PtsTy &objs, CallBack callBack = Noop{}) {
     assert(!src->hasSuperNode() && !dst->hasSuperNode());
 
     // TODO: use llvm::cast in debugging build
@@ -98,30 +279,15 @@ class SolverBase {
     auto idx = llvm::cast<const llvm::Instruction>(ptrNode->getPointer()->getValue());
     // assert(gep);
 
-    // TODO: the intersection on pts should be done through PtsTrait for better
-    // extensibility
-    PtsTy &handled = handledGEPMap.try_emplace(ptrNode).first->second;
-    const PtsTy &curPts = PT::getPointsTo(src->getNodeID());
-
-    PtsTy newGEPs;
-    newGEPs.intersectWithComplement(curPts, handled);
-
-    assert(!handled.intersects(newGEPs));
-    assert(curPts.contains(newGEPs));
-    handled |= newGEPs;  // update handled gep
-
     bool changed = false;
     std::vector<ObjNodeTy *> nodeVec;
-    size_t ptsSize = newGEPs.count();
-    if (ptsSize == 0) {
+    if (objs.empty()) {
       return false;
     }
 
-    // there is new obj in src's pts
-    nodeVec.reserve(ptsSize);
     // We need to cache all the node here because the PT might be modified and
-    // the iterator might be invalid
-    for (auto it = newGEPs.begin(), ie = newGEPs.end(); it != ie; ++it) {
+    // the iterator (or objs itself, if it is the pts of src) might be invalid
+    for (auto it = objs.begin(), ie = objs.end(); it != ie; ++it) {
       // TODO: use llvm::cast in debugging build
       auto objNode = static_cast<ObjNodeTy *>(consGraph->getObjectNode(*it));
       nodeVec.push_back(objNode);
@@ -156,10 +322,16 @@ class SolverBase {
   //     node --COPY--> dst
   template <typename CallBack = Noop>
   bool processLoad(CGNodeTy *src, CGNodeTy *dst, CallBack callBack = Noop{}) {
+    return processLoad(src, dst, PT::getPointsTo(src->getNodeID()), callBack);
+  }
+
+  // same as above, but only for the nodes in objs (a subset of pts(src))
+  template <typename CallBack = Noop>
+  bool processLoad(CGNodeTy *src, CGNodeTy *dst, const PtsTy &objs, CallBack callBack = Noop{}) {
     assert(!src->hasSuperNode() && !dst->hasSuperNode());
 
     bool changed = false;
-    for (auto it = PT::begin(src->getNodeID()), ie = PT::end(src->getNodeID()); it != ie; it++) {
+    for (auto it = objs.begin(), ie = objs.end(); it != ie; it++) {
       auto node = consGraph->getObjectNode(*it);
       node = node->getSuperNode();
       if (consGraph->addConstraints(node, dst, Constraints::copy)) {
@@ -199,16 +371,21 @@ class SolverBase {
     return changed;
   }
 
-  // TODO: only process diff pts
   // src --STORE-->dst
   // for every node in pts(dst):
   //      src --COPY--> node
   template <typename CallBack = Noop>
   bool processStore(CGNodeTy *src, CGNodeTy *dst, CallBack callBack = Noop{}) {
+    return processStore(src, dst, PT::getPointsTo(dst->getNodeID()), callBack);
+  }
+
+  // same as above, but only for the nodes in objs (a subset of pts(dst))
+  template <typename CallBack = Noop>
+  bool processStore(CGNodeTy *src, CGNodeTy *dst, const PtsTy &objs, CallBack callBack = Noop{}) {
     assert(!src->hasSuperNode() && !dst->hasSuperNode());
 
     bool changed = false;
-    for (auto it = PT::begin(dst->getNodeID()), ie = PT::end(dst->getNodeID()); it != ie; it++) {
+    for (auto it = objs.begin(), ie = objs.end(); it != ie; it++) {
       // auto tmp = llvm::dyn_cast<ObjNodeTy>(consGraph->getCGNode(*it));
       auto node = consGraph->getObjectNode(*it);
       node = node->getSuperNode();
@@ -227,6 +404,9 @@ class SolverBase {
     // from here
     do {
       static_cast<SubClass *>(this)->runSolver(*langModel);
+      if (checkBudget()) {
+        break;
+      }
       // resolve indirect calls in language model
       reanalyze = resolveFunPtrs();
     } while (reanalyze);
@@ -280,29 +460,43 @@ class SolverBase {
 
  public:
   // analyze the give module with specified entry function
-  bool analyze(llvm::Module *module, llvm::StringRef entry) {
+  // modelArgs are passed on to the constructor of the language model (e.g. the context policy of RaceModel)
+  template <typename... ModelArgs>
+  bool analyze(llvm::Module *module, llvm::StringRef entry, ModelArgs &&...modelArgs) {
     assert(langModel == nullptr && "can not run pointer analysis twice");
-    // ensure the points to set are cleaned.
-    // TODO: support different point-to set instance for different PTA instance
-    // new they all share a global vector to store it.
-    PT::clearAll();
+    auto const scope = bind();
+    budget = AnalysisBudget(ConfigPTATimeBudget, ConfigPTAMemBudget);
 
     // using language model to construct language model
-    langModel.reset(LMT::buildInitModel(module, entry));
+    langModel.reset(LMT::buildInitModel(module, entry, std::forward<ModelArgs>(modelArgs)...));
     LMT::constructConsGraph(langModel.get());
 
     consGraph = LMT::getConsGraph(langModel.get());
+    // building the constraint graph might already use up the budget
+    checkBudget();
 
     LOG_INFO("Pointer Analysis Starting to Solve");
 
     // subclass might override solve() directly for more aggressive overriding
     static_cast<SubClass *>(this)->solve();
+    // the propagated part of every pts is only needed while solving, and as large as the pts themselves
+    propagatedPts = {};
 
     LOG_INFO("Pointer Analysis Finished Solving");
 
     LOG_DEBUG("PTA constraint graph node number {}, callgraph node number {}", this->getConsGraph()->getNodeNum(),
               this->getCallGraph()->getNodeNum());
 
+    auto const superNodeStats = this->getConsGraph()->getSuperNodeStats();
+    LOG_DEBUG("PTA merged {} nodes into super nodes, average chain length {:.2f} without path compression, "
+              "{:.2f} over {} lookups with path compression",
+              superNodeStats.mergedNodes, superNodeStats.avgChainLengthWithoutCompression(),
+              superNodeStats.avgChainLengthWithCompression(), superNodeStats.lookups);
+
+    if (!degradations.empty()) {
+      LOG_WARN("PTA degraded {} times to stay within its budget", degradations.size());
+    }
+
     if (ConfigPrintConstraintGraph) {
       WriteGraphToFile("ConstraintGraph_Final", *this->getConsGraph());
     }
@@ -319,6 +513,34 @@ class SolverBase {
     return false;
   }
 
+  // the precision given up to stay within the time and memory budget, in the order it was given up
+  [[nodiscard]] inline const std::vector<std::string> &getDegradations() const { return degradations; }
+
+  [[nodiscard]] size_t getNumContexts() const {
+    auto const scope = bind();
+    return CT::getNumCtx();
+  }
+
+  // number of constraints between the nodes that are not merged into a super node
+  [[nodiscard]] size_t getNumConstraints() const {
+    size_t constraints = 0;
+    for (auto node : *this->getConsGraph()) {
+      if (node->hasSuperNode()) continue;
+      for (auto it = node->succ_edge_begin(), ie = node->succ_edge_end(); it != ie; it++) {
+        constraints++;
+      }
+    }
+    return constraints;
+  }
+
+  // the context that context evolves into at the call site I, as when the PTA visited the call.
+  // unlike the static CT::contextEvolve, this is safe to call from many threads
+  [[nodiscard]] const ctx *evolveContext(const ctx *context, const llvm::Instruction *I) const {
+    std::lock_guard<std::mutex> guard(contextLock);
+    auto const scope = bind();
+    return CT::contextEvolve(context, I);
+  }
+
   inline CGNodeTy *getCGNode(const ctx *context, const llvm::Value *V) const {
     NodeID id = LMT::getSuperNodeIDForValue(langModel.get(), context, V);
     return (*consGraph)[id];
@@ -331,6 +553,7 @@ class SolverBase {
   std::map<std::string, ObjNodeTy *> lockStrObjects;
   void getPointsToForSpecialLockPtr(const ctx *context, const llvm::Instruction *I, std::string lockStr,
                                     const llvm::Value *lockPtr, std::vector<const ObjTy *> &result) {
+    auto const scope = bind();
     // create annonymous object if it does not exist
     if (lockStrObjects.find(lockStr) == lockStrObjects.end()) {
       auto objNode = LMT::allocSpecialAnonObj(langModel.get(), I, lockPtr);
@@ -340,6 +563,7 @@ class SolverBase {
   }
 
   void getPointsTo(const ctx *context, const llvm::Value *V, std::multiset<const ObjTy *> &result) const {
+    auto const scope = bind();
     assert(V->getType()->isPointerTy());
 
     // get the node value
@@ -359,6 +583,7 @@ class SolverBase {
   }
 
   void getFSPointsTo(const ctx *context, const llvm::Value *V, std::vector<const ObjTy *> &result) const {
+    auto const scope = bind();
     assert(V->getType()->isPointerTy());
 
     // get the node value
@@ -402,6 +627,7 @@ class SolverBase {
   }
 
   [[nodiscard]] bool alias(const ctx *c1, const llvm::Value *v1, const ctx *c2, const llvm::Value *v2) const {
+    auto const scope = bind();
     assert(v1->getType()->isPointerTy() && v2->getType()->isPointerTy());
 
     NodeID n1 = LMT::getSuperNodeIDForValue(langModel.get(), c1, v1);
@@ -412,6 +638,7 @@ class SolverBase {
   }
 
   [[nodiscard]] bool aliasIfExsit(const ctx *c1, const llvm::Value *v1, const ctx *c2, const llvm::Value *v2) const {
+    auto const scope = bind();
     assert(v1->getType()->isPointerTy() && v2->getType()->isPointerTy());
 
     NodeID n1 = LMT::getSuperNodeIDForValue(langModel.get(), c1, v1);
@@ -424,6 +651,7 @@ class SolverBase {
   }
 
   [[nodiscard]] bool hasIdenticalPTS(const ctx *c1, const llvm::Value *v1, const ctx *c2, const llvm::Value *v2) const {
+    auto const scope = bind();
     assert(v1->getType()->isPointerTy() && v2->getType()->isPointerTy());
 
     NodeID n1 = LMT::getSuperNodeIDForValue(langModel.get(), c1, v1);
@@ -434,6 +662,7 @@ class SolverBase {
   }
 
   [[nodiscard]] bool containsPTS(const ctx *c1, const llvm::Value *v1, const ctx *c2, const llvm::Value *v2) const {
+    auto const scope = bind();
     assert(v1->getType()->isPointerTy() && v2->getType()->isPointerTy());
 
     NodeID n1 = LMT::getSuperNodeIDForValue(langModel.get(), c1, v1);
@@ -486,6 +715,19 @@ bool SolverBase<LangModel, SubClass>::processCopy(CGNodeTy *src, CGNodeTy *dst)
   return false;
 }
 
+template <typename LangModel, typename SubClass>
+bool SolverBase<LangModel, SubClass>::processCopy(CGNodeTy *src, CGNodeTy *dst, const PtsTy &objs) {
+  assert(PT::getPointsTo(src->getNodeID()).contains(objs));
+  if (PT::unionWithPts(dst->getNodeID(), objs)) {
+    if (dst->isFunctionPtr()) {
+      // node used for indirect call
+      this->updateFunPtr(dst->getNodeID());
+    }
+    return true;
+  }
+  return false;
+}
+
 }  // namespace pta
 
 #undef DEBUG_TYPE
@@ -0,0 +1,59 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <cassert>
+#include <utility>
+
+namespace pta {
+
+// The state behind a static trait API (the points-to sets of a PTSTrait, the contexts of a CtxTrait, ...).
+//
+// Each PTA instance owns its own State and binds it to the calling thread with a Scope. The static functions of the
+// trait work on the State bound to the calling thread, so PTA instances on different threads do not share anything,
+// and several threads can bind one State at once as long as none of them modifies it.
+template <typename State>
+class ThreadBound {
+  static thread_local State *bound;
+
+ public:
+  // binds the state to the current thread until the scope ends, scopes nest
+  class Scope {
+    State *previous;
+    bool active = true;
+
+   public:
+    explicit Scope(State &state) : previous(bound) { bound = &state; }
+    Scope(Scope &&other) noexcept : previous(other.previous), active(std::exchange(other.active, false)) {}
+    ~Scope() {
+      if (active) {
+        bound = previous;
+      }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    Scope &operator=(Scope &&) = delete;
+  };
+
+  [[nodiscard]] static inline State &get() {
+    assert(bound != nullptr && "no state is bound to the calling thread");
+    return *bound;
+  }
+
+  [[nodiscard]] static inline bool isBound() { return bound != nullptr; }
+};
+
+template <typename State>
+thread_local State *ThreadBound<State>::bound = nullptr;
+
+}  // namespace pta
@@ -22,6 +22,9 @@ limitations under the License.
 #include <llvm/IR/Type.h>
 #include <llvm/Transforms/Utils/Local.h>
 
+#include <memory>
+#include <mutex>
+
 #include "Demangler/Demangler.h"
 #include "Logging/Log.h"
 #include "PointerAnalysis/Util/Util.h"
@@ -33,9 +36,10 @@ using namespace std;
 // anonymous namespace
 namespace {
 
+// The struct type metadata of one module. Lookups cache their results, so callers hold lock while looking up
 class DICompositeTypeCollector {
  private:
-  const Module *M = nullptr;
+  const Module *M;
   std::vector<const DICompositeType *> typeDIVec;
   DenseMap<const llvm::Type *, const DICompositeType *> typeDIMap;
 
@@ -214,16 +218,10 @@ class DICompositeTypeCollector {
     return false;
   }
 
-  void collectMDIfNeeded(const Module *module) {
-    if (this->M == module) {
-      return;
-    }
-    // update the module
-    this->M = module;
+  std::mutex lock;
 
-    // now collect all MD Nodes in the llvm::Module
-    processModule();
-  }
+  // collects all MD Nodes in the llvm::Module
+  explicit DICompositeTypeCollector(const Module *module) : M(module) { processModule(); }
 
   inline const DataLayout &getDataLayout() { return this->M->getDataLayout(); }
 
@@ -271,14 +269,14 @@ class DICompositeTypeCollector {
         }
         // 2nd if failed, try to traverse all the metadata and find the right
         // one
-        return getTypeMetaData(ST);
+        return lookUpMDForType(ST);
       }
 
       case AllocKind::Globals: {
         // checkout dbg metadata along with the global variable
 
         // 2nd if failed
-        return getTypeMetaData(ST);
+        return lookUpMDForType(ST);
       }
       case AllocKind::Heap: {
         // TODO:
@@ -315,10 +313,10 @@ class DICompositeTypeCollector {
           }
         }
         // 3rd, if failed
-        return getTypeMetaData(ST);
+        return lookUpMDForType(ST);
       }
       case AllocKind::Anonymous:
-        return getTypeMetaData(ST);
+        return lookUpMDForType(ST);
       case AllocKind::Null:
       case AllocKind::Universal:
       case AllocKind::Functions:
@@ -346,7 +344,34 @@ class DICompositeTypeCollector {
   }
 };
 
-static DICompositeTypeCollector collector;
+// The collector of every module analyzed so far. Each analysis rebuilds the collector of its module when it starts
+// (see TypeMDinit), so a module allocated where a destroyed one was never sees stale metadata.
+// Collectors are shared so an analysis can keep using one while another analysis of the same module replaces it.
+class CollectorRegistry {
+  std::mutex lock;
+  DenseMap<const Module *, std::shared_ptr<DICompositeTypeCollector>> collectors;
+
+ public:
+  static CollectorRegistry &getInstance() {
+    static CollectorRegistry registry;
+    return registry;
+  }
+
+  void rebuild(const Module *M) {
+    auto collector = std::make_shared<DICompositeTypeCollector>(M);
+    std::lock_guard<std::mutex> guard(lock);
+    collectors[M] = std::move(collector);
+  }
+
+  std::shared_ptr<DICompositeTypeCollector> get(const Module *M) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &collector = collectors[M];
+    if (!collector) {
+      collector = std::make_shared<DICompositeTypeCollector>(M);
+    }
+    return collector;
+  }
+};
 
 }  // namespace
 
@@ -379,19 +404,20 @@ DIType *stripArrayAndTypeDefDI(DIType *DI) {
   return DI;
 }
 
-void TypeMDinit(const llvm::Module *M) { collector.collectMDIfNeeded(M); }
+void TypeMDinit(const llvm::Module *M) { CollectorRegistry::getInstance().rebuild(M); }
 
 // FIXME: is there any way that I can quickly get the type metadata with 100%
 // accuracy???
-const DICompositeType *getTypeMetaData(const StructType *T) { return collector.lookUpMDForType(T); }
-
 const DICompositeType *getTypeMetaData(const Module *M, const StructType *T) {
-  collector.collectMDIfNeeded(M);
-  return collector.lookUpMDForType(T);
+  auto const collector = CollectorRegistry::getInstance().get(M);
+  std::lock_guard<std::mutex> guard(collector->lock);
+  return collector->lookUpMDForType(T);
 }
 
-const DICompositeType *getTypeMetaData(const Value *allocSite, AllocKind T, const Type *allocType) {
-  return collector.resolveTypeMetaData(allocSite, T, allocType);
+const DICompositeType *getTypeMetaData(const Module *M, const Value *allocSite, AllocKind T, const Type *allocType) {
+  auto const collector = CollectorRegistry::getInstance().get(M);
+  std::lock_guard<std::mutex> guard(collector->lock);
+  return collector->resolveTypeMetaData(allocSite, T, allocType);
 }
 
 SmallVector<DIDerivedType *, 8> getNonStaticDataMember(const DICompositeType *DI) {
@@ -30,15 +30,17 @@ llvm::DIType *stripTypeDefDI(llvm::DIType *DI);
 llvm::DIType *stripArrayDI(llvm::DIType *DI);
 llvm::DIType *stripArrayAndTypeDefDI(llvm::DIType *DI);
 
+// (re)collects the type metadata of M, called when the analysis of M starts
+// the metadata is kept per module, so modules from different analyses (or LLVMContexts) do not mix
 void TypeMDinit(const llvm::Module *M);
 
 // only support looking up composite type, scalar type like int, float or
 // pointer are not supported
-const llvm::DICompositeType *getTypeMetaData(const llvm::StructType *T);
 const llvm::DICompositeType *getTypeMetaData(const llvm::Module *M, const llvm::StructType *T);
 
-// look up the type metadata of the object allocated
-const llvm::DICompositeType *getTypeMetaData(const llvm::Value *allocSite, AllocKind T, const llvm::Type *allocType);
+// look up the type metadata of the object allocated in M
+const llvm::DICompositeType *getTypeMetaData(const llvm::Module *M, const llvm::Value *allocSite, AllocKind T,
+                                             const llvm::Type *allocType);
 
 llvm::SmallVector<llvm::DIDerivedType *, 8> getNonStaticDataMember(const llvm::DICompositeType *DI);
 
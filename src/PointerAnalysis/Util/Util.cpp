@@ -227,13 +227,9 @@ std::string pta::getDemangledName(StringRef mangledName) {
 }
 
 // i8* is the void* in LLVM
+// checked structurally, types belong to an LLVMContext and the modules analyzed may be in different ones
 static bool isVoidPointer(const Type *T) {
-  static Type *VoidStarTy = nullptr;
-  if (VoidStarTy == nullptr) {
-    VoidStarTy = PointerType::getUnqual(IntegerType::get(T->getContext(), 8));
-  }
-
-  return VoidStarTy == T;
+  return T->isPointerTy() && T->getPointerAddressSpace() == 0 && T->getPointerElementType()->isIntegerTy(8);
 }
 
 static bool isCompatibleType(const Type *T1, const Type *T2) {
@@ -343,24 +339,6 @@ static bool isCompatibleFunctionType(const FunctionType *FT1, const FunctionType
   return true;
 }
 
-static std::map<std::string, size_t> NodeDistribution;
-void pta::recordCGNode(const llvm::Value *val) {
-  auto dir = getSourceDir(val);
-  if (NodeDistribution.find(dir) == NodeDistribution.end()) {
-    NodeDistribution.insert(std::make_pair(dir, 1));
-  } else {
-    NodeDistribution[dir]++;
-  }
-}
-
-void pta::dumpCGNodeDistribution() {
-  llvm::outs() << "*************************************\n";
-  for (auto &it : NodeDistribution) {
-    llvm::outs() << it.first << ": " << it.second << "\n";
-  }
-  llvm::outs() << "*************************************\n";
-}
-
 std::string pta::getSourceDir(const Value *val) {
   assert(val != nullptr);
 
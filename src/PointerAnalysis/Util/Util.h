@@ -119,10 +119,6 @@ inline llvm::Type *getUnboundedArrayTy(llvm::Type *elemType) {
   return getBoundedArrayTy(elemType, std::numeric_limits<uint32_t>::max());
 }
 
-// for debugging purpose
-void recordCGNode(const llvm::Value *val);
-void dumpCGNodeDistribution();
-
 std::string getSourceDir(const llvm::Value *val);
 
 void prettyFunctionPrinter(const llvm::Function *func, llvm::raw_ostream &os);
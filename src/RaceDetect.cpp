@@ -11,6 +11,9 @@ limitations under the License.
 
 #include "RaceDetect.h"
 
+#include <fstream>
+#include <mutex>
+
 #include "Analysis/HappensBeforeGraph.h"
 #include "Analysis/LockSet.h"
 #include "Analysis/OpenMPAnalysis.h"
@@ -19,52 +22,64 @@ limitations under the License.
 #include "Analysis/ThreadLocalAnalysis.h"
 #include "LanguageModel/RaceModel.h"
 #include "Statistics/Coverage.h"
+#include "Statistics/Metrics.h"
 #include "Trace/ProgramTrace.h"
+#include "Util/WorkStealingPool.h"
 
 using namespace race;
 
-Report race::detectRaces(llvm::Module *module, DetectRaceConfig config) {
-  race::ProgramTrace program(module);
+namespace {
 
-  if (config.dumpPreprocessedIR.has_value()) {
-    std::error_code err;
-    llvm::raw_fd_ostream outfile(config.dumpPreprocessedIR.value(), err);
-    if (err) {
-      llvm::errs() << "Error dumping preprocessed IR!\n";
-    } else {
-      program.getModule().print(outfile, nullptr);
-      outfile.close();
-    }
-  }
+// Build an analysis while measuring it as phase
+template <typename Analysis, typename... Args>
+Analysis buildMeasured(Metrics &metrics, llvm::StringRef phase, Args &&...args) {
+  auto const measured = metrics.start(phase);
+  return Analysis(std::forward<Args>(args)...);
+}
 
-  if (config.printTrace) {
-    llvm::outs() << program << "\n";
-  }
+// Everything needed to check a race pair.
+// The analyses are built once and shared: HappensBeforeGraph is immutable once built, and each worker gets its own
+// share() of LockSet and OpenMPAnalysis, which reuses their indexes but fills its own lazy caches.
+// Workers never share mutable state.
+class RaceChecker {
+  const HappensBeforeGraph &happensbefore;
+  LockSet lockset;
+  SimpleAlias simpleAlias;
+  OpenMPAnalysis ompAnalysis;
+  ThreadLocalAnalysis threadlocal;
 
-  llvm::outs() << timestamp() << " Start Analysis\n";
-  race::SharedMemory sharedmem(program);
-  race::HappensBeforeGraph happensbefore(program);
-  race::LockSet lockset(program);
-  race::SimpleAlias simpleAlias;
-  race::OpenMPAnalysis ompAnalysis(program);
-  race::ThreadLocalAnalysis threadlocal;
+  // ScalarEvolution (used by the omp array index analysis) creates constants in the shared LLVMContext,
+  // which is not thread safe. Workers must hold this lock while running it. Null when running on one thread.
+  std::mutex *llvmContextLock;
 
-  llvm::outs() << timestamp() << " Start Race Detection\n";
+  bool isNonOverlappingLoopAccess(const WriteEvent *write, const MemAccessEvent *other) {
+    if (llvmContextLock == nullptr) {
+      return ompAnalysis.isNonOverlappingLoopAccess(write, other);
+    }
+    std::lock_guard<std::mutex> guard(*llvmContextLock);
+    return ompAnalysis.isNonOverlappingLoopAccess(write, other);
+  }
 
-  race::Reporter reporter;
+  // Returns true if write and other can race
+  bool isRace(const WriteEvent *write, const MemAccessEvent *other) {
+    if (!happensbefore.areParallel(write, other)) {
+      ++pruned.happensBefore;
+      return false;
+    }
 
-  // Adds to report if race is detected between write and other
-  auto checkRace = [&](const race::WriteEvent *write, const race::MemAccessEvent *other) {
-    if (!happensbefore.areParallel(write, other) || lockset.sharesLock(write, other)) {
-      return;
+    if (lockset.sharesLock(write, other)) {
+      ++pruned.lockSet;
+      return false;
     }
 
     if (threadlocal.isThreadLocalAccess(write, other)) {
-      return;
+      ++pruned.threadLocal;
+      return false;
     }
 
     if (simpleAlias.mustNotAlias(write, other)) {
-      return;
+      ++pruned.simpleAlias;
+      return false;
     }
 
     if (ompAnalysis.fromSameParallelRegion(write, other)) {
@@ -73,59 +88,184 @@ Report race::detectRaces(llvm::Module *module, DetectRaceConfig config) {
       //  #pragma omp parallel for shared(A)
       //  for (int i = 0; i < N: i++) { A[i] = i; }
       // even though A is shared, each index is unique so there is no race
-      if (ompAnalysis.isNonOverlappingLoopAccess(write, other)) {
-        return;
+      if (isNonOverlappingLoopAccess(write, other)) {
+        ++pruned.ompLoopIndex;
+        return false;
       }
 
       // Certain omp blocks cannot race with themselves or those of the same type within the same scope/team
       if (ompAnalysis.inSameSingleBlock(write, other) || ompAnalysis.inSameReduce(write, other) ||
-          race::OpenMPAnalysis::insideCompatibleSections(write, other)) {
-        return;
+          ompAnalysis.insideCompatibleSections(write, other)) {
+        ++pruned.ompBlock;
+        return false;
       }
 
       // No race if guaranteed to be executed by same thread
-      if (ompAnalysis.guardedBySameTID(write, other)) return;
+      if (ompAnalysis.guardedBySameTID(write, other)) {
+        ++pruned.ompSameThread;
+        return false;
+      }
 
       // Lastprivate code will only be executed by one thread
       // Model lastprivate by assuming lastprivate code cannot race with other last private code
       // This may miss races according to OpenMP specification,
       //  but will not miss races according to how Clang generates OpenMP code (as of clang 10.0.1)
-      if (ompAnalysis.isInLastprivate(write) && ompAnalysis.isInLastprivate(other)) return;
+      if (ompAnalysis.isInLastprivate(write) && ompAnalysis.isInLastprivate(other)) {
+        ++pruned.ompLastprivate;
+        return false;
+      }
     }
 
-    // Race detected
-    reporter.collect(write, other);
-  };
-
-  for (auto const sharedObj : sharedmem.getSharedObjects()) {
-    auto threadedWrites = sharedmem.getThreadedWrites(sharedObj);
-    auto threadedReads = sharedmem.getThreadedReads(sharedObj);
-
-    for (auto it = threadedWrites.begin(), end = threadedWrites.end(); it != end; ++it) {
-      auto const wtid = it->first;
-      auto const writes = it->second;
-      // check Read/Write race
-      for (auto const &[rtid, reads] : threadedReads) {
-        if (wtid == rtid) continue;
-        for (auto write : writes) {
-          for (auto read : reads) {
-            checkRace(write, read);
-          }
-        }
-      }
+    return true;
+  }
 
-      // Check write/write
-      for (auto wit = std::next(it, 1); wit != end; ++wit) {
-        auto otherWrites = wit->second;
-        for (auto write : writes) {
-          for (auto otherWrite : otherWrites) {
-            checkRace(write, otherWrite);
-          }
-        }
-      }
+ public:
+  Reporter reporter;
+
+  // Number of pairs skipped because they are checked under another shared object / number of pairs checked
+  size_t skippedPairs = 0;
+  size_t checkedPairs = 0;
+
+  // Number of checked pairs ruled out by each filter of isRace
+  struct {
+    size_t happensBefore = 0;
+    size_t lockSet = 0;
+    size_t threadLocal = 0;
+    size_t simpleAlias = 0;
+    size_t ompLoopIndex = 0;
+    size_t ompBlock = 0;
+    size_t ompSameThread = 0;
+    size_t ompLastprivate = 0;
+  } pruned;
+
+  RaceChecker(const HappensBeforeGraph &happensbefore, const LockSet &lockset, const OpenMPAnalysis &ompAnalysis,
+              std::mutex *llvmContextLock, RaceStream *stream)
+      : happensbefore(happensbefore),
+        lockset(lockset.share()),
+        ompAnalysis(ompAnalysis.share()),
+        llvmContextLock(llvmContextLock),
+        reporter(stream) {}
+
+  // Adds to report if race is detected between write and other, both accessing obj
+  // A pair is filed under every shared object both events may access, but its verdict only depends on the two
+  // events, so it is only checked under the first of them. Every worker agrees on that object without sharing state.
+  void checkRace(const pta::ObjTy *obj, const WriteEvent *write, const MemAccessEvent *other) {
+    if (!SharedMemory::isFirstCommonObject(obj, write, other)) {
+      // Checked under another shared object
+      ++skippedPairs;
+      return;
+    }
+    ++checkedPairs;
+
+    if (isRace(write, other)) {
+      reporter.collect(write, other);
     }
   }
 
+  // Check every write/read and write/write pair from different threads on one shared object
+  void checkSharedObject(const SharedMemory &sharedmem, const pta::ObjTy *sharedObj) {
+    sharedmem.forEachPair(sharedObj, [&](const WriteEvent *write, const MemAccessEvent *other) {
+      checkRace(sharedObj, write, other);
+      return true;
+    });
+  }
+};
+
+}  // namespace
+
+Report race::detectRaces(llvm::Module *module, DetectRaceConfig config) {
+  // fail before spending any time on the analysis if the races can not be streamed
+  std::ofstream streamOutput;
+  if (config.streamRaces.has_value()) {
+    streamOutput.open(config.streamRaces.value(), std::ofstream::out);
+    if (!streamOutput) {
+      Report failed({});
+      failed.error = "could not open " + config.streamRaces.value() + " to stream races";
+      return failed;
+    }
+  }
+
+  Metrics metrics;
+  race::ProgramTrace program(module, "main", &metrics, config.context);
+
+  if (config.dumpPreprocessedIR.has_value()) {
+    std::error_code err;
+    llvm::raw_fd_ostream outfile(config.dumpPreprocessedIR.value(), err);
+    if (err) {
+      llvm::errs() << "Error dumping preprocessed IR!\n";
+    } else {
+      program.getModule().print(outfile, nullptr);
+      outfile.close();
+    }
+  }
+
+  if (config.printTrace) {
+    llvm::outs() << program << "\n";
+  }
+
+  llvm::outs() << timestamp() << " Start Analysis\n";
+  race::SharedMemory sharedmem = buildMeasured<SharedMemory>(metrics, "sharedMemory", program);
+  race::HappensBeforeGraph happensbefore =
+      buildMeasured<HappensBeforeGraph>(metrics, "happensBefore", program, config.hbEngine);
+
+  auto const sharedObjects = sharedmem.getSharedObjects();
+  metrics.count("sharedMemory", "sharedObjects", sharedObjects.size());
+  auto const numWorkers = std::max<size_t>(1, std::min(resolveJobs(config.jobs), sharedObjects.size()));
+
+  std::unique_ptr<RaceStream> stream;
+  if (streamOutput.is_open()) {
+    stream = std::make_unique<RaceStream>(streamOutput);
+  }
+
+  race::LockSet const lockset = buildMeasured<LockSet>(metrics, "lockset", program);
+  race::OpenMPAnalysis const ompAnalysis = buildMeasured<OpenMPAnalysis>(metrics, "openmp", program);
+
+  std::mutex llvmContextLock;
+  std::vector<std::unique_ptr<RaceChecker>> checkers;
+  checkers.reserve(numWorkers);
+  for (size_t i = 0; i < numWorkers; ++i) {
+    checkers.push_back(std::make_unique<RaceChecker>(happensbefore, lockset, ompAnalysis,
+                                                     numWorkers > 1 ? &llvmContextLock : nullptr, stream.get()));
+  }
+
+  llvm::outs() << timestamp() << " Start Race Detection\n";
+
+  {
+    auto const phase = metrics.start("raceCheck");
+    // Each shared object is an independent unit of work
+    parallelForWorkStealing(numWorkers, sharedObjects.size(), [&](size_t worker, size_t objIdx) {
+      checkers[worker]->checkSharedObject(sharedmem, sharedObjects[objIdx]);
+    });
+  }
+
+  race::Reporter reporter;
+  size_t skippedPairs = 0;
+  size_t checkedPairs = 0;
+  for (auto &checker : checkers) {
+    reporter.merge(std::move(checker->reporter));
+    skippedPairs += checker->skippedPairs;
+    checkedPairs += checker->checkedPairs;
+
+    auto const &pruned = checker->pruned;
+    metrics.count("raceCheck", "prunedByHappensBefore", pruned.happensBefore);
+    metrics.count("raceCheck", "prunedByLockSet", pruned.lockSet);
+    metrics.count("raceCheck", "prunedByThreadLocal", pruned.threadLocal);
+    metrics.count("raceCheck", "prunedBySimpleAlias", pruned.simpleAlias);
+    metrics.count("raceCheck", "prunedByOpenMPLoopIndex", pruned.ompLoopIndex);
+    metrics.count("raceCheck", "prunedByOpenMPBlock", pruned.ompBlock);
+    metrics.count("raceCheck", "prunedByOpenMPSameThread", pruned.ompSameThread);
+    metrics.count("raceCheck", "prunedByOpenMPLastprivate", pruned.ompLastprivate);
+  }
+  metrics.count("raceCheck", "workers", numWorkers);
+  metrics.count("raceCheck", "checkedPairs", checkedPairs);
+  metrics.count("raceCheck", "skippedPairs", skippedPairs);
+  llvm::outs() << timestamp() << " Checked " << checkedPairs << " race pairs (" << skippedPairs
+               << " pairs skipped, checked under another shared object)\n";
+  if (stream) {
+    llvm::outs() << timestamp() << " Streamed " << stream->size() << " races to " << config.streamRaces.value()
+                 << "\n";
+  }
+
   if (DEBUG_PTA) {
     happensbefore.debugDump(llvm::outs());
   }
@@ -140,5 +280,16 @@ Report race::detectRaces(llvm::Module *module, DetectRaceConfig config) {
   }
 
   llvm::outs() << timestamp() << " Start Report\n";
-  return reporter.getReport();
+  auto report = [&]() {
+    auto const phase = metrics.start("report");
+    return reporter.getReport();
+  }();
+  report.degradations = program.pta.getDegradations();
+  metrics.count("report", "races", report.size());
+  metrics.setDegradations(report.degradations);
+
+  if (config.dumpMetrics.has_value()) {
+    metrics.dump(config.dumpMetrics.value());
+  }
+  return report;
 }
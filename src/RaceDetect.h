@@ -11,6 +11,8 @@ limitations under the License.
 
 #pragma once
 
+#include "Analysis/HappensBeforeGraph.h"
+#include "LanguageModel/ContextPolicy.h"
 #include "Reporter/Reporter.h"
 
 namespace race {
@@ -24,6 +26,23 @@ struct DetectRaceConfig {
 
   // Compute and print the coverage (= analyzed source code/all source code)
   bool doCoverage = false;
+
+  // Number of threads used to check race pairs (0 means one per core)
+  // The report is the same no matter how many threads are used
+  size_t jobs = 1;
+
+  // How happens-before queries between sync events are answered
+  HappensBeforeGraph::Engine hbEngine = HappensBeforeGraph::Engine::VectorClock;
+
+  // Context sensitivity of the pointer analysis
+  pta::ContextPolicy context = pta::ContextPolicy::Origin3;
+
+  // writes each race to the file as one JSON object per line (NDJSON) as soon as it is found, instead of keeping the
+  // races in the report. If the file can not be opened, nothing is analyzed and the report has an error
+  std::optional<std::string> streamRaces;
+
+  // writes the time, memory and key counts of each phase to the file as JSON
+  std::optional<std::string> dumpMetrics;
 };
 
 Report detectRaces(llvm::Module *module, DetectRaceConfig config = DetectRaceConfig());
@@ -11,10 +11,12 @@ limitations under the License.
 
 #include "Reporter.h"
 
-#include <filesystem>
+#include <algorithm>
 #include <fstream>
-namespace fs = std::filesystem;
+#include <tuple>
+#include <utility>
 
+#include "Reporter/SourceCache.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 
 using namespace race;
@@ -66,46 +68,22 @@ llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const CallSignature &
   return os;
 }
 
-namespace {
-std::vector<CallSignature> computeCallstack(const Event *targetEvent) {
-  std::vector<CallSignature> callstack;
-
-  auto const &thread = targetEvent->getThread();
-  auto const &events = thread.getEvents();
-
-  // Compute parent thread callstack and add it to the final callstack
-  auto const spawnSite = targetEvent->getThread().spawnSite;
-  if (spawnSite) {
-    callstack = computeCallstack(spawnSite.value());
-  }
-
-  for (auto const &event : events) {
-    // quit when past the target event
-    // if the targetEvent is a call it will also be added to the callstack
-    if (event->getID() > targetEvent->getID()) break;
-
-    if (auto const callEvent = llvm::dyn_cast<EnterCallEvent>(event.get())) {
-      auto call = llvm::cast<llvm::CallBase>(callEvent->getInst());
-      callstack.emplace_back(call);
-    } else if (event->type == Event::Type::CallEnd) {
-      callstack.pop_back();
-    }
-  }
+RaceAccess::RaceAccess(const MemAccessEvent *event)
+    : location(getSourceLoc(event)),
+      type(event->type),
+      inst(event->getInst()),
+      callPath(event->getCallPath()),
+      callPaths(event->getThread().program.callPaths.get()) {
+  updateMisleadingDebugLoc();
+}
 
-  // Check if targetEvent is a fork, if so add it to the call stack
-  if (auto fork = llvm::dyn_cast<ForkEvent>(targetEvent)) {
-    auto call = llvm::cast<llvm::CallBase>(fork->getInst());
-    callstack.emplace_back(call);
+std::vector<CallSignature> RaceAccess::getCallstack() const {
+  std::vector<CallSignature> callstack;
+  for (auto const site : callPaths->getCallSites(callPath)) {
+    callstack.emplace_back(site);
   }
-
   return callstack;
 }
-}  // namespace
-
-RaceAccess::RaceAccess(const MemAccessEvent *event)
-    : location(getSourceLoc(event)), type(event->type), inst(event->getInst()), callstack(computeCallstack(event)) {
-  updateMisleadingDebugLoc();
-}
 
 void race::to_json(json &j, const RaceAccess &access) {
   if (access.location.has_value()) {
@@ -169,6 +147,7 @@ Report::Report(const std::vector<std::pair<const WriteEvent *, const MemAccessEv
     }
 
     races.insert(race);
+    if (!callPaths) callPaths = racepair.first->getThread().program.callPaths;
   }
   if (skipped > 0) {
     llvm::errs() << "skipped " << skipped << " races with unknown location\n";
@@ -182,57 +161,89 @@ void Report::dumpReport(const std::string &path) const {
   output.close();
 }
 
-void Reporter::collect(const WriteEvent *e1, const MemAccessEvent *e2) {
-  racepairs.emplace_back(std::make_pair(e1, e2));
-}
+namespace {
 
-Report Reporter::getReport() const { return Report(racepairs); }
+// Events are uniquely identified by their (thread, event) IDs
+auto racePairKey(const std::pair<const WriteEvent *, const MemAccessEvent *> &racepair) {
+  return std::make_tuple(racepair.first->getThread().id, racepair.first->getID(), racepair.second->getThread().id,
+                         racepair.second->getID());
+}
 
-namespace {
-std::optional<std::string> tryReadSourceLine(const std::optional<SourceLoc> &loc) {
-  if (!loc) return std::nullopt;
+// Race pairs between the same two instructions are reported as the same race
+std::pair<const llvm::Instruction *, const llvm::Instruction *> getInstPair(const Event *e1, const Event *e2) {
+  auto first = e1->getInst();
+  auto second = e2->getInst();
+  if (second < first) std::swap(first, second);
+  return {first, second};
+}
 
-  auto const dir = loc.value().directory.str();
-  auto const filename = loc.value().filename.str();
-  auto const line = loc.value().line;
+}  // namespace
 
-  auto const sourcePath = fs::path(dir) / fs::path(filename);
-  std::ifstream sourceFile(sourcePath, std::ios::binary);
-  if (!sourceFile) {
-    return std::nullopt;
+void RaceStream::write(const WriteEvent *e1, const MemAccessEvent *e2) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!seen.insert(getInstPair(e1, e2)).second) return;
   }
 
-  std::string sourceLine;
+  // computing the callstacks does not need the lock, other workers keep writing meanwhile
+  Race race(e1, e2);
+  if (race.missingLocation()) return;
+  auto const line = json(race).dump();
 
-  // read file up to the target line
-  int count = 0;
-  while (count < line - 1) {
-    std::getline(sourceFile, sourceLine);
-    count++;
-  }
+  std::lock_guard<std::mutex> guard(lock);
+  output << line << "\n";
+  // consumers should see the race now rather than when the buffer fills up
+  output.flush();
+  numRaces++;
+}
 
-  // read target line
-  std::getline(sourceFile, sourceLine);
-  sourceFile.close();
+size_t RaceStream::size() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return numRaces;
+}
 
-  return sourceLine;
+void Reporter::keep(const RacePair &racepair) {
+  auto const [it, inserted] = racepairs.try_emplace(getInstPair(racepair.first, racepair.second), racepair);
+  if (!inserted && racePairKey(racepair) < racePairKey(it->second)) {
+    it->second = racepair;
+  }
 }
-}  // namespace
 
-llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const Race &race) {
-  std::string firstLine = "(-)";
-  if (auto const source = tryReadSourceLine(race.first.location)) {
-    firstLine = source.value();
+void Reporter::collect(const WriteEvent *e1, const MemAccessEvent *e2) {
+  // the stream filters out the repeated races itself, nothing needs to be kept here
+  if (stream != nullptr) {
+    stream->write(e1, e2);
+    return;
   }
+  keep({e1, e2});
+}
 
-  std::string secondLine = "(-)";
-  if (auto const source = tryReadSourceLine(race.second.location)) {
-    secondLine = source.value();
+void Reporter::merge(Reporter &&other) {
+  for (auto const &entry : other.racepairs) {
+    keep(entry.second);
   }
+  other.racepairs.clear();
+}
 
-  // os << race.first.location << " " << race.second.location << "\n\t" << *race.first.inst << "\n\t\t" << firstLine
-  //    << "\n\t" << *race.second.inst << "\n\t\t" << secondLine;
+Report Reporter::getReport() const {
+  std::vector<RacePair> sorted;
+  sorted.reserve(racepairs.size());
+  for (auto const &entry : racepairs) {
+    sorted.push_back(entry.second);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](auto const &lhs, auto const &rhs) { return racePairKey(lhs) < racePairKey(rhs); });
+  return Report(sorted);
+}
 
+namespace {
+std::optional<llvm::StringRef> tryReadSourceLine(const std::optional<SourceLoc> &loc) {
+  if (!loc) return std::nullopt;
+  return SourceCache::getShared().getLine(loc->directory, loc->filename, loc->line);
+}
+}  // namespace
+
+llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const Race &race) {
   // Print Location of race
   os << race.first.location << " " << race.second.location;
 
@@ -253,11 +264,11 @@ llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const Race &race) {
   os << "\n\t" << *race.second.inst;
 
   os << "\n\t---Callstacks---";
-  for (auto const &call : race.first.callstack) {
+  for (auto const &call : race.first.getCallstack()) {
     os << "\n\t> " << call;
   }
   os << "\n\t====";
-  for (auto const &call : race.second.callstack) {
+  for (auto const &call : race.second.getCallstack()) {
     os << "\n\t> " << call;
   }
   return os;
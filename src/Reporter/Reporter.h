@@ -11,9 +11,16 @@ limitations under the License.
 
 #pragma once
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <optional>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "Trace/ProgramTrace.h"
 
@@ -67,10 +74,15 @@ struct RaceAccess {
   std::optional<SourceLoc> location;
   Event::Type type;
   const llvm::Instruction *inst;
-  std::vector<CallSignature> callstack;
+  // the callstack is only materialized when it is printed, accesses with the same callstack share the same path
+  // the table is kept alive by the Report the access belongs to
+  CallPathID callPath;
+  const CallPathTable *callPaths;
 
   RaceAccess(const MemAccessEvent *event);
 
+  [[nodiscard]] std::vector<CallSignature> getCallstack() const;
+
   bool sameLocation(const RaceAccess &other) const { return location == other.location; }
 
   bool operator==(const RaceAccess &other) const;
@@ -108,7 +120,14 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const Race &race);
 
 class Report {
  public:
+  // empty if the races were streamed
   std::set<Race> races;
+  // precision the pointer analysis gave up to stay within its budget, the races may be incomplete if non-empty
+  std::vector<std::string> degradations;
+  // the call paths of the races, so they can still be printed after the trace they were found in is destroyed
+  std::shared_ptr<const CallPathTable> callPaths;
+  // why detection could not run, the report has no races if set
+  std::optional<std::string> error;
 
   Report(const std::vector<std::pair<const WriteEvent *, const MemAccessEvent *>> &rawRaces);
 
@@ -118,12 +137,50 @@ class Report {
   void dumpReport(const std::string &path = "races.json") const;
 };
 
+// Writes every race as one JSON object per line (NDJSON) as soon as it is found, so the results can be consumed
+// while detection is still running. Each line has the same format as an entry of "races" in the JSON report.
+// Shared by all race checking workers, each race is written once no matter how many workers find it. The races are
+// not kept anywhere else, only the instructions of the races written so far.
+class RaceStream {
+  std::ostream &output;
+  mutable std::mutex lock;
+  // instructions of the races already seen, ordered by address
+  llvm::DenseSet<std::pair<const llvm::Instruction *, const llvm::Instruction *>> seen;
+  size_t numRaces = 0;
+
+ public:
+  explicit RaceStream(std::ostream &output) : output(output) {}
+
+  // Write the race unless one between the same two instructions was already written
+  // Races with no source location are not written, same as in the report
+  void write(const WriteEvent *e1, const MemAccessEvent *e2);
+
+  // Number of races written so far
+  [[nodiscard]] size_t size() const;
+};
+
 class Reporter {
-  std::vector<std::pair<const WriteEvent *, const MemAccessEvent *>> racepairs;
+  using RacePair = std::pair<const WriteEvent *, const MemAccessEvent *>;
+  using InstPair = std::pair<const llvm::Instruction *, const llvm::Instruction *>;
+
+  // Race pairs between the same two instructions are the same race in the report, so only one race pair is kept
+  // per pair of instructions: the first one in the canonical order, so the report does not depend on the order
+  // (or number of workers) they were collected in
+  llvm::DenseMap<InstPair, RacePair> racepairs;
+  RaceStream *stream;
+
+  // keeps racepair if it is the first one between its two instructions or comes before the kept one
+  void keep(const RacePair &racepair);
 
  public:
+  // with a stream, races are written to it instead of being kept for the report
+  explicit Reporter(RaceStream *stream = nullptr) : stream(stream) {}
+
   void collect(const WriteEvent *e1, const MemAccessEvent *e2);
 
+  // Move all race pairs collected by other into this reporter (e.g. from a race checking worker)
+  void merge(Reporter &&other);
+
   [[nodiscard]] Report getReport() const;
 };
 
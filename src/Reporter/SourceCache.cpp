@@ -0,0 +1,59 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "Reporter/SourceCache.h"
+
+#include <filesystem>
+
+using namespace race;
+
+SourceCache::File::File(std::unique_ptr<llvm::MemoryBuffer> buffer) : buffer(std::move(buffer)) {
+  auto const text = this->buffer->getBuffer();
+  lineStarts.push_back(0);
+  for (size_t pos = text.find('\n'); pos != llvm::StringRef::npos; pos = text.find('\n', pos + 1)) {
+    lineStarts.push_back(pos + 1);
+  }
+  // the last line ends with the file, not with a line break
+  if (lineStarts.back() != text.size()) {
+    lineStarts.push_back(text.size());
+  }
+}
+
+const SourceCache::File *SourceCache::getFile(llvm::StringRef path) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto [it, inserted] = files.try_emplace(path, nullptr);
+  if (inserted) {
+    if (auto buffer = llvm::MemoryBuffer::getFile(path)) {
+      it->second = std::make_unique<File>(std::move(buffer.get()));
+    }
+  }
+  return it->second.get();
+}
+
+std::optional<llvm::StringRef> SourceCache::getLine(llvm::StringRef directory, llvm::StringRef filename,
+                                                    unsigned int line) {
+  auto const path = std::filesystem::path(directory.str()) / std::filesystem::path(filename.str());
+  auto const file = getFile(path.string());
+  // lineStarts has one more entry than there are lines
+  if (file == nullptr || line == 0 || line >= file->lineStarts.size()) {
+    return std::nullopt;
+  }
+
+  auto const begin = file->lineStarts[line - 1];
+  auto const end = file->lineStarts[line];
+  auto const text = file->buffer->getBuffer().slice(begin, end);
+  return text.rtrim("\r\n");
+}
+
+SourceCache &SourceCache::getShared() {
+  static SourceCache cache;
+  return cache;
+}
@@ -0,0 +1,53 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace race {
+
+// Source lines of the files referenced by the debug info, for printing code snippets.
+// Each file is read once (memory mapped unless it is small) and indexed by the offset of each line,
+// so any line is found in constant time. Files are never evicted, the returned lines live as long as the cache.
+class SourceCache {
+  struct File {
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    // offset of the first character of each line, followed by the size of the buffer
+    std::vector<size_t> lineStarts;
+
+    explicit File(std::unique_ptr<llvm::MemoryBuffer> buffer);
+  };
+
+  std::mutex lock;
+  // keyed by path, null if the file could not be read
+  llvm::StringMap<std::unique_ptr<File>> files;
+
+  const File *getFile(llvm::StringRef path);
+
+ public:
+  // The line (starting from 1) of the file without its line break,
+  // if the file can be read and has that line. filename is relative to directory unless it is absolute
+  [[nodiscard]] std::optional<llvm::StringRef> getLine(llvm::StringRef directory, llvm::StringRef filename,
+                                                       unsigned int line);
+
+  // The cache shared by everything that prints source lines
+  [[nodiscard]] static SourceCache &getShared();
+};
+
+}  // namespace race
@@ -0,0 +1,105 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "Statistics/Metrics.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using namespace race;
+
+namespace {
+
+double getCPUSeconds(const struct rusage &usage) {
+  auto const seconds = [](const timeval &time) { return time.tv_sec + time.tv_usec / 1e6; };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+uint64_t getPeakRSSKB(const struct rusage &usage) {
+  // in KB on Linux, in bytes on macOS
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+struct rusage getUsage() {
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage;
+}
+
+}  // namespace
+
+Metrics::Phase::Phase(Metrics &metrics, llvm::StringRef name)
+    : metrics(&metrics), index(metrics.getPhaseIndex(name)), wallStart(std::chrono::steady_clock::now()) {
+  auto const usage = getUsage();
+  cpuStart = getCPUSeconds(usage);
+  peakRSSStart = getPeakRSSKB(usage);
+}
+
+Metrics::Phase::Phase(Phase &&other) noexcept
+    : metrics(std::exchange(other.metrics, nullptr)),
+      index(other.index),
+      wallStart(other.wallStart),
+      cpuStart(other.cpuStart),
+      peakRSSStart(other.peakRSSStart) {}
+
+Metrics::Phase::~Phase() {
+  if (metrics == nullptr) return;
+
+  auto const usage = getUsage();
+  auto &phase = metrics->phases[index];
+  phase.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  phase.cpuSeconds += getCPUSeconds(usage) - cpuStart;
+  phase.peakRSSDeltaKB += getPeakRSSKB(usage) - peakRSSStart;
+}
+
+size_t Metrics::getPhaseIndex(llvm::StringRef name) {
+  auto it = std::find_if(phases.begin(), phases.end(), [&name](const PhaseData &phase) { return phase.name == name; });
+  if (it != phases.end()) return it - phases.begin();
+
+  phases.emplace_back();
+  phases.back().name = name.str();
+  return phases.size() - 1;
+}
+
+void Metrics::count(llvm::StringRef phase, llvm::StringRef name, uint64_t value) {
+  auto &counts = phases[getPhaseIndex(phase)].counts;
+  auto it = std::find_if(counts.begin(), counts.end(), [&name](const auto &count) { return count.first == name; });
+  if (it != counts.end()) {
+    it->second += value;
+  } else {
+    counts.emplace_back(name.str(), value);
+  }
+}
+
+void Metrics::dump(const std::string &path) const {
+  auto phasesJSON = nlohmann::json::array();
+  for (auto const &phase : phases) {
+    auto counts = nlohmann::json::object();
+    for (auto const &[name, value] : phase.counts) {
+      counts[name] = value;
+    }
+    phasesJSON.push_back({{"name", phase.name},
+                          {"wallSeconds", phase.wallSeconds},
+                          {"cpuSeconds", phase.cpuSeconds},
+                          {"peakRSSDeltaKB", phase.peakRSSDeltaKB},
+                          {"counts", counts}});
+  }
+
+  std::ofstream output(path, std::ofstream::out);
+  output << nlohmann::json{{"phases", phasesJSON}, {"degradations", degradations}}.dump(2) << "\n";
+}
@@ -0,0 +1,79 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/StringRef.h>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace race {
+
+// Wall time, CPU time, peak memory and key counts of each phase of the race detection,
+// written as JSON (--metrics) to track performance across releases.
+// Phases are listed in the order they first started. A phase that runs more than once (e.g. once per worker) adds up.
+// The JSON also lists the precision the pointer analysis gave up to stay within its budget ("degradations").
+class Metrics {
+ public:
+  struct PhaseData {
+    std::string name;
+    double wallSeconds = 0;
+    // user + system time of every thread of the process
+    double cpuSeconds = 0;
+    // how much the peak resident set size of the process grew during the phase
+    uint64_t peakRSSDeltaKB = 0;
+    // in the order they were first recorded
+    std::vector<std::pair<std::string, uint64_t>> counts;
+  };
+
+  // Measures a phase from construction until it goes out of scope
+  class Phase {
+    Metrics *metrics;
+    size_t index;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart;
+    uint64_t peakRSSStart;
+
+   public:
+    Phase(Metrics &metrics, llvm::StringRef name);
+    Phase(Phase &&other) noexcept;
+    ~Phase();
+
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+    Phase &operator=(Phase &&) = delete;
+  };
+
+  [[nodiscard]] Phase start(llvm::StringRef name) { return Phase(*this, name); }
+
+  // Add value to the count called name of phase
+  void count(llvm::StringRef phase, llvm::StringRef name, uint64_t value);
+
+  [[nodiscard]] const std::vector<PhaseData> &getPhases() const { return phases; }
+
+  // The budget degradation steps of the pointer analysis, in the order they were taken
+  void setDegradations(std::vector<std::string> steps) { degradations = std::move(steps); }
+  [[nodiscard]] const std::vector<std::string> &getDegradations() const { return degradations; }
+
+  void dump(const std::string &path) const;
+
+ private:
+  std::vector<PhaseData> phases;
+  std::vector<std::string> degradations;
+
+  // index of the phase called name, added if it is new
+  size_t getPhaseIndex(llvm::StringRef name);
+};
+
+}  // namespace race
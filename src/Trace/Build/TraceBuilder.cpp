@@ -64,7 +64,7 @@ void race::buildTrace(const pta::CallGraphNodeTy *node, ThreadBuildState &state)
   state.callstack.push(func);
 
   // Update  einfo
-  state.einfo = std::make_shared<EventInfo>(state.thread, node->getContext());
+  state.einfo = std::make_shared<EventInfo>(state.thread, node->getContext(), state.callPath);
 
   auto const &summary = *state.programState.builder.getFunctionSummary(func);
   for (auto const &ir : summary) {
@@ -92,10 +92,15 @@ void race::buildTrace(const pta::CallGraphNodeTy *node, ThreadBuildState &state)
 
     if (auto readIR = llvm::dyn_cast<ReadIR>(ir.get())) {
       std::shared_ptr<const ReadIR> read(ir, readIR);
-      state.events.push_back(std::make_unique<const ReadEventImpl>(read, state.einfo, state.events.size()));
+      auto const ptsTo = state.programState.objects.resolve(state.programState.pta, state.einfo->context,
+                                                            readIR->getAccessedValue());
+      state.events.push_back(std::make_unique<const ReadEventImpl>(read, state.einfo, state.events.size(), ptsTo));
     } else if (auto writeIR = llvm::dyn_cast<WriteIR>(ir.get())) {
       std::shared_ptr<const WriteIR> write(ir, writeIR);
-      state.events.push_back(std::make_unique<const WriteEventImpl>(write, state.einfo, state.events.size()));
+      auto const ptsTo = state.programState.objects.resolve(state.programState.pta, state.einfo->context,
+                                                            writeIR->getAccessedValue());
+      state.events.push_back(
+          std::make_unique<const WriteEventImpl>(write, state.einfo, state.events.size(), ptsTo));
     } else if (auto forkIR = llvm::dyn_cast<ForkIR>(ir.get())) {
       std::shared_ptr<const ForkIR> fork(ir, forkIR);
       auto forkEventImpl = std::make_unique<const ForkEventImpl>(fork, state.einfo, state.events.size());
@@ -151,7 +156,7 @@ void race::buildTrace(const pta::CallGraphNodeTy *node, ThreadBuildState &state)
         continue;
       }
 
-      auto const directContext = pta::CT::contextEvolve(node->getContext(), ir->getInst());
+      auto const directContext = state.programState.pta.evolveContext(node->getContext(), ir->getInst());
       auto const callee = CallIR::resolveTargetFunction(call->getInst());
       if (callee == nullptr || callee->isIntrinsic() || callee->isDebugInfoForProfiling()) {
         continue;
@@ -170,7 +175,13 @@ void race::buildTrace(const pta::CallGraphNodeTy *node, ThreadBuildState &state)
       }
 
       state.events.push_back(std::make_unique<const EnterCallEventImpl>(call, state.einfo, state.events.size()));
+      // the events of the callee are reached through this call, the events after it are back in this function
+      auto const callerInfo = state.einfo;
+      auto const callerPath = state.callPath;
+      state.callPath = state.programState.callPaths.getChild(callerPath, call->getInst());
       buildTrace(directNode, state);
+      state.callPath = callerPath;
+      state.einfo = callerInfo;
       state.events.push_back(std::make_unique<const LeaveCallEventImpl>(call, state.einfo, state.events.size()));
 
     } else {
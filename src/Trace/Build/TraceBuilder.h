@@ -19,8 +19,10 @@ limitations under the License.
 #include "LanguageModel/RaceModel.h"
 #include "Trace/Build/CallStack.h"
 #include "Trace/Build/RuntimeModel.h"
+#include "Trace/CallPathTable.h"
 #include "Trace/Event.h"
 #include "Trace/EventImpl.h"
+#include "Trace/ObjectTable.h"
 #include "Trace/ThreadTrace.h"
 
 namespace race {
@@ -39,10 +41,17 @@ struct ProgramBuildState {
   // Pointer Analysis
   const pta::PTA &pta;
 
+  // Points-to sets of memory accesses are resolved into this table as events are built
+  ObjectTable &objects;
+
+  // Call paths of the events are interned into this table as events are built
+  CallPathTable &callPaths;
+
   std::vector<std::unique_ptr<Runtime>> runtimeModels;
 
   // Constructor
-  ProgramBuildState(const pta::PTA &pta) : pta(pta) {}
+  ProgramBuildState(const pta::PTA &pta, ObjectTable &objects, CallPathTable &callPaths)
+      : pta(pta), objects(objects), callPaths(callPaths) {}
 };
 
 // Thread (local) state needed to build a single ThreadTrace
@@ -67,6 +76,9 @@ struct ThreadBuildState {
   // Callstack used to prevent recursion
   CallStack callstack;
 
+  // Call path of the function being traversed
+  CallPathID callPath = CallPathTable::ROOT;
+
   // Constructor
   ThreadBuildState() = delete;
   ThreadBuildState(ProgramBuildState &programState, ThreadTrace &thread,
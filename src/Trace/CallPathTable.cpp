@@ -0,0 +1,33 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "Trace/CallPathTable.h"
+
+#include <algorithm>
+
+using namespace race;
+
+CallPathID CallPathTable::getChild(CallPathID parent, const llvm::CallBase *site) {
+  auto [it, inserted] = children.try_emplace({parent, site}, nodes.size());
+  if (inserted) {
+    nodes.push_back({parent, site});
+  }
+  return it->second;
+}
+
+std::vector<const llvm::CallBase *> CallPathTable::getCallSites(CallPathID id) const {
+  std::vector<const llvm::CallBase *> sites;
+  for (; id != ROOT; id = nodes[id].parent) {
+    sites.push_back(nodes[id].site);
+  }
+  std::reverse(sites.begin(), sites.end());
+  return sites;
+}
@@ -0,0 +1,57 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/InstrTypes.h>
+
+#include <vector>
+
+namespace race {
+
+// Dense id for a call path in the trace
+using CallPathID = uint32_t;
+
+// Interns the call paths events are reached through, as a trie of the call and fork sites on the way from the entry
+// of the main thread to each event. The trie is built once while the trace is built and events only store the id of
+// their node, a callstack is materialized by walking the parents of the node.
+class CallPathTable {
+  struct Node {
+    CallPathID parent;
+    // the call or fork site that extends the parent path, null for the root
+    const llvm::CallBase *site;
+  };
+
+  // indexed by CallPathID
+  std::vector<Node> nodes;
+  llvm::DenseMap<std::pair<CallPathID, const llvm::CallBase *>, CallPathID> children;
+
+ public:
+  // The empty path of the main thread
+  static constexpr CallPathID ROOT = 0;
+
+  CallPathTable() : nodes{{ROOT, nullptr}} {}
+
+  // The path extending parent with site, created the first time it is asked for
+  [[nodiscard]] CallPathID getChild(CallPathID parent, const llvm::CallBase *site);
+
+  [[nodiscard]] CallPathID getParent(CallPathID id) const { return nodes[id].parent; }
+  [[nodiscard]] const llvm::CallBase *getSite(CallPathID id) const { return nodes[id].site; }
+
+  // The call and fork sites on the path, outermost first
+  [[nodiscard]] std::vector<const llvm::CallBase *> getCallSites(CallPathID id) const;
+
+  // Number of distinct paths, CallPathIDs are in [0, size())
+  [[nodiscard]] size_t size() const { return nodes.size(); }
+};
+
+}  // namespace race
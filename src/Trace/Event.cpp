@@ -11,6 +11,7 @@ limitations under the License.
 
 #include "Trace/Event.h"
 
+#include "Trace/ProgramTrace.h"
 #include "Trace/ThreadTrace.h"
 
 using namespace race;
@@ -19,15 +20,16 @@ llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const Event &event) {
   os << event.getThread().id << ":" << event.getID() << " " << event.type << "\t" << *event.getInst();
   if (auto const memAccess = llvm::dyn_cast<MemAccessEvent>(&event)) {
     os << "   {";
+    auto const &objects = event.getThread().program.objects;
     auto const mem = memAccess->getAccessedMemory();
     auto it = mem.begin();
     auto const end = mem.end();
     if (it != end) {
-      os << (*it)->getObjectID();
+      os << objects.getObject(*it)->getObjectID();
     }
 
     for (; it != end; ++it) {
-      os << ", " << (*it)->getObjectID();
+      os << ", " << objects.getObject(*it)->getObjectID();
     }
 
     os << "}";
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "IR/IR.h"
 #include "LanguageModel/RaceModel.h"
+#include "Trace/CallPathTable.h"
+#include "Trace/ObjectTable.h"
 
 namespace race {
 
@@ -38,6 +40,8 @@ class Event {
   [[nodiscard]] virtual EventID getID() const = 0;
   [[nodiscard]] virtual const pta::ctx *getContext() const = 0;
   [[nodiscard]] virtual const ThreadTrace &getThread() const = 0;
+  // The call and fork sites the event is reached through, see ProgramTrace::callPaths
+  [[nodiscard]] virtual CallPathID getCallPath() const = 0;
   [[nodiscard]] virtual const race::IR *getIRInst() const = 0;
   [[nodiscard]] virtual const llvm::Instruction *getInst() const { return getIRInst()->getInst(); }
   [[nodiscard]] const llvm::Function *getFunction() const { return getInst()->getFunction(); }
@@ -56,7 +60,8 @@ class MemAccessEvent : public Event {
 
  public:
   [[nodiscard]] const race::MemAccessIR *getIRInst() const override = 0;
-  [[nodiscard]] virtual const std::multiset<const pta::ObjTy *> getAccessedMemory() const = 0;
+  // Sorted ids of the objects this event may access, see ProgramTrace::objects
+  [[nodiscard]] virtual llvm::ArrayRef<ObjID> getAccessedMemory() const = 0;
 
   // Used for llvm style RTTI (isa, dyn_cast, etc.)
   [[nodiscard]] static inline bool classof(const Event *e) { return e->type == Type::Read || e->type == Type::Write; }
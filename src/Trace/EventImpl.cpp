@@ -13,22 +13,18 @@ limitations under the License.
 
 using namespace race;
 
-const std::multiset<const pta::ObjTy *> ReadEventImpl::getAccessedMemory() const {
-  std::multiset<const pta::ObjTy *> ptsTo;
-  this->info->thread->program.pta.getPointsTo(this->info->context, this->read->getAccessedValue(), ptsTo);
-  return ptsTo;
+llvm::ArrayRef<ObjID> ReadEventImpl::getAccessedMemory() const {
+  return this->info->thread->program.objects.get(ptsTo);
 }
 
-const std::multiset<const pta::ObjTy *> WriteEventImpl::getAccessedMemory() const {
-  std::multiset<const pta::ObjTy *> ptsTo;
-  this->info->thread->program.pta.getPointsTo(this->info->context, this->write->getAccessedValue(), ptsTo);
-  return ptsTo;
+llvm::ArrayRef<ObjID> WriteEventImpl::getAccessedMemory() const {
+  return this->info->thread->program.objects.get(ptsTo);
 }
 
 const pta::CallGraphNodeTy *ForkEventImpl::getThreadEntry() const {
   auto entryVal = fork->getThreadEntry();
   if (auto entryFunc = llvm::dyn_cast<llvm::Function>(entryVal)) {
-    auto const newContext = pta::CT::contextEvolve(info->context, fork->getInst());
+    auto const newContext = info->thread->program.pta.evolveContext(info->context, fork->getInst());
     auto const entryNode = info->thread->program.pta.getDirectNodeOrNull(newContext, entryFunc);
     return entryNode;
   }
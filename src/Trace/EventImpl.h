@@ -26,9 +26,11 @@ namespace race {
 struct EventInfo {
   const ThreadTrace *const thread;
   const pta::ctx *context;
+  const CallPathID callPath;
 
   EventInfo() = delete;
-  EventInfo(const ThreadTrace &thread, const pta::ctx *context) : thread(&thread), context(context) {}
+  EventInfo(const ThreadTrace &thread, const pta::ctx *context, CallPathID callPath)
+      : thread(&thread), context(context), callPath(callPath) {}
   EventInfo(const EventInfo &) = default;
   EventInfo(EventInfo &&) = default;
   EventInfo &operator=(const EventInfo &) = delete;
@@ -37,38 +39,46 @@ struct EventInfo {
 
 class ReadEventImpl : public ReadEvent {
   std::shared_ptr<EventInfo> info;
+  // resolved once when the trace is built
+  ObjectTable::PtsSlice ptsTo;
 
  public:
   const std::shared_ptr<const ReadIR> read;
   const EventID id;
 
-  ReadEventImpl(std::shared_ptr<const ReadIR> read, std::shared_ptr<EventInfo> info, EventID id)
-      : info(std::move(info)), read(std::move(read)), id(id) {}
+  ReadEventImpl(std::shared_ptr<const ReadIR> read, std::shared_ptr<EventInfo> info, EventID id,
+                 ObjectTable::PtsSlice ptsTo)
+      : info(std::move(info)), ptsTo(ptsTo), read(std::move(read)), id(id) {}
 
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::ReadIR *getIRInst() const override { return read.get(); }
 
-  [[nodiscard]] const std::multiset<const pta::ObjTy *> getAccessedMemory() const override;
+  [[nodiscard]] llvm::ArrayRef<ObjID> getAccessedMemory() const override;
 };
 
 class WriteEventImpl : public WriteEvent {
   std::shared_ptr<EventInfo> info;
+  // resolved once when the trace is built
+  ObjectTable::PtsSlice ptsTo;
 
  public:
   const std::shared_ptr<const WriteIR> write;
   const EventID id;
 
-  WriteEventImpl(std::shared_ptr<const WriteIR> write, std::shared_ptr<EventInfo> info, EventID id)
-      : info(std::move(info)), write(std::move(write)), id(id) {}
+  WriteEventImpl(std::shared_ptr<const WriteIR> write, std::shared_ptr<EventInfo> info, EventID id,
+                 ObjectTable::PtsSlice ptsTo)
+      : info(std::move(info)), ptsTo(ptsTo), write(std::move(write)), id(id) {}
 
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::WriteIR *getIRInst() const override { return write.get(); }
 
-  [[nodiscard]] const std::multiset<const pta::ObjTy *> getAccessedMemory() const override;
+  [[nodiscard]] llvm::ArrayRef<ObjID> getAccessedMemory() const override;
 };
 
 class ForkEventImpl : public ForkEvent {
@@ -84,6 +94,7 @@ class ForkEventImpl : public ForkEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::ForkIR *getIRInst() const override { return fork.get(); }
 
   [[nodiscard]] std::vector<const pta::ObjTy *> getThreadHandle() const override {
@@ -113,6 +124,7 @@ class JoinEventImpl : public JoinEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::JoinIR *getIRInst() const override { return join.get(); }
 
   [[nodiscard]] std::optional<const ForkEvent *> getForkEvent() const override { return forkEvent; }
@@ -135,6 +147,7 @@ class LockEventImpl : public LockEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::LockIR *getIRInst() const override { return lock.get(); }
 
   [[nodiscard]] std::vector<const pta::ObjTy *> getLockObj() const override {
@@ -156,6 +169,7 @@ class UnlockEventImpl : public UnlockEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::UnlockIR *getIRInst() const override { return unlock.get(); }
 
   [[nodiscard]] std::vector<const pta::ObjTy *> getLockObj() const override {
@@ -177,6 +191,7 @@ class BarrierEventImpl : public BarrierEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::BarrierIR *getIRInst() const override { return barrier.get(); }
 };
 
@@ -193,6 +208,7 @@ class EnterCallEventImpl : public EnterCallEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::CallIR *getIRInst() const override { return call.get(); }
 
   [[nodiscard]] const llvm::Function *getCalledFunction() const override { return call->getCalledFunction(); }
@@ -211,6 +227,7 @@ class LeaveCallEventImpl : public LeaveCallEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::CallIR *getIRInst() const override { return call.get(); }
 
   [[nodiscard]] const llvm::Function *getCalledFunction() const override { return call->getCalledFunction(); }
@@ -229,6 +246,7 @@ class ExternCallEventImpl : public ExternCallEvent {
   [[nodiscard]] inline EventID getID() const override { return id; }
   [[nodiscard]] inline const pta::ctx *getContext() const override { return info->context; }
   [[nodiscard]] inline const ThreadTrace &getThread() const override { return *info->thread; }
+  [[nodiscard]] inline CallPathID getCallPath() const override { return info->callPath; }
   [[nodiscard]] inline const race::CallIR *getIRInst() const override { return call.get(); }
 
   [[nodiscard]] const llvm::Function *getCalledFunction() const override {
@@ -0,0 +1,44 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "Trace/ObjectTable.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace race;
+
+ObjectTable::PtsSlice ObjectTable::resolve(const pta::PTA &pta, const pta::ctx *context, const llvm::Value *value) {
+  std::multiset<const pta::ObjTy *> ptsTo;
+  pta.getPointsTo(context, value, ptsTo);
+
+  PtsSlice slice;
+  slice.begin = ptsPool.size();
+  for (auto obj : ptsTo) {
+    auto [it, inserted] = ids.try_emplace(obj, objects.size());
+    if (inserted) {
+      objects.push_back(obj);
+    }
+    ptsPool.push_back(it->second);
+  }
+
+  auto const begin = ptsPool.begin() + slice.begin;
+  std::sort(begin, ptsPool.end());
+  ptsPool.erase(std::unique(begin, ptsPool.end()), ptsPool.end());
+  slice.size = ptsPool.size() - slice.begin;
+  return slice;
+}
+
+std::optional<ObjID> ObjectTable::getID(const pta::ObjTy *obj) const {
+  auto it = ids.find(obj);
+  if (it == ids.end()) return std::nullopt;
+  return it->second;
+}
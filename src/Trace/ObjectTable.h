@@ -0,0 +1,58 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include <optional>
+#include <vector>
+
+#include "LanguageModel/RaceModel.h"
+
+namespace race {
+
+// Dense id for an object accessed somewhere in the trace
+using ObjID = uint32_t;
+
+// Interns every object that may be accessed by a memory access event in the trace.
+// The points-to set of each access is resolved once, while the trace is built, and stored as a sorted slice of
+// dense object ids in one array shared by every event.
+class ObjectTable {
+  llvm::DenseMap<const pta::ObjTy *, ObjID> ids;
+  // indexed by ObjID, in the order objects were first seen
+  std::vector<const pta::ObjTy *> objects;
+  // the points-to sets of every access, back to back
+  std::vector<ObjID> ptsPool;
+
+ public:
+  // Location of one points-to set in the shared pool
+  struct PtsSlice {
+    uint32_t begin = 0;
+    uint32_t size = 0;
+  };
+
+  // Resolve the objects value may point to under context and store them as a new sorted slice
+  [[nodiscard]] PtsSlice resolve(const pta::PTA &pta, const pta::ctx *context, const llvm::Value *value);
+
+  [[nodiscard]] llvm::ArrayRef<ObjID> get(PtsSlice slice) const {
+    return llvm::makeArrayRef(ptsPool).slice(slice.begin, slice.size);
+  }
+
+  [[nodiscard]] const pta::ObjTy *getObject(ObjID id) const { return objects[id]; }
+  [[nodiscard]] std::optional<ObjID> getID(const pta::ObjTy *obj) const;
+
+  // Number of distinct objects, ObjIDs are in [0, size())
+  [[nodiscard]] size_t size() const { return objects.size(); }
+};
+
+}  // namespace race
@@ -15,17 +15,33 @@ limitations under the License.
 #include "Trace/Event.h"
 using namespace race;
 
-ProgramTrace::ProgramTrace(llvm::Module *module, llvm::StringRef entryName) : module(module) {
+ProgramTrace::ProgramTrace(llvm::Module *module, llvm::StringRef entryName, Metrics *metrics,
+                           pta::ContextPolicy contextPolicy)
+    : module(module) {
+  Metrics unused;
+  auto &recorded = metrics ? *metrics : unused;
+
   llvm::outs() << timestamp() << " Start Preproc\n";
-  // Run preprocessing on module
-  preprocess(*module);
+  {
+    auto const phase = recorded.start("preprocess");
+    // Run preprocessing on module
+    preprocess(*module);
+  }
+  recorded.count("preprocess", "functions", module->size());
 
   llvm::outs() << timestamp() << " Start PTA\n";
-
-  // Run pointer analysis
-  pta.analyze(module, entryName);
+  {
+    auto const phase = recorded.start("pta");
+    // Run pointer analysis
+    pta.analyze(module, entryName, contextPolicy);
+  }
+  recorded.count("pta", "nodes", pta.getConsGraph()->getNodeNum());
+  recorded.count("pta", "constraints", pta.getNumConstraints());
+  recorded.count("pta", "contexts", pta.getNumContexts());
+  recorded.count("pta", "callGraphNodes", pta.getCallGraph()->getNodeNum());
 
   llvm::outs() << timestamp() << " Start Build Trace\n";
+  auto phase = recorded.start("trace");
   // build all threads starting from this main func
   auto const mainEntry = pta::GT::getEntryNode(pta.getCallGraph());
   // Program trace needs to hold a unique ptr to the entry thread
@@ -46,6 +62,15 @@ ProgramTrace::ProgramTrace(llvm::Module *module, llvm::StringRef entryName) : mo
       worklist.push_back(it->get());
     }
   }
+
+  size_t events = 0;
+  for (auto const thread : threads) {
+    events += thread->getEvents().size();
+  }
+  recorded.count("trace", "threads", threads.size());
+  recorded.count("trace", "events", events);
+  recorded.count("trace", "objects", objects.size());
+  recorded.count("trace", "callPaths", callPaths->size());
 }
 
 llvm::raw_ostream &race::operator<<(llvm::raw_ostream &os, const ProgramTrace &trace) {
@@ -13,10 +13,14 @@ limitations under the License.
 
 #include <IR/Builder.h>
 
+#include <memory>
 #include <vector>
 
+#include "CallPathTable.h"
 #include "IR/IRImpls.h"
 #include "LanguageModel/RaceModel.h"
+#include "ObjectTable.h"
+#include "Statistics/Metrics.h"
 #include "ThreadTrace.h"
 #include "Trace/Event.h"
 
@@ -32,6 +36,13 @@ class ProgramTrace {
  public:
   pta::PTA pta;
 
+  // Every object accessed in the trace, and the points-to set of each memory access event
+  ObjectTable objects;
+
+  // The call path of every event, see Event::getCallPath
+  // Shared with the reports of races found in this trace, which print callstacks after the trace is gone
+  std::shared_ptr<CallPathTable> callPaths = std::make_shared<CallPathTable>();
+
   [[nodiscard]] inline const std::vector<const ThreadTrace *> &getThreads() const { return threads; }
 
   [[nodiscard]] const Event *getEvent(ThreadID tid, EventID eid) { return threads.at(tid)->getEvent(eid); }
@@ -39,7 +50,9 @@ class ProgramTrace {
   // Get the module after preprocessing has been run
   [[nodiscard]] const Module &getModule() const { return *module; }
 
-  explicit ProgramTrace(llvm::Module *module, llvm::StringRef entryName = "main");
+  // the time and counts of preprocessing, pointer analysis and building the trace are recorded in metrics if set
+  explicit ProgramTrace(llvm::Module *module, llvm::StringRef entryName = "main", Metrics *metrics = nullptr,
+                        pta::ContextPolicy contextPolicy = pta::ContextPolicy::Origin3);
   ~ProgramTrace() = default;
   ProgramTrace(const ProgramTrace &) = delete;
   ProgramTrace(ProgramTrace &&) = delete;  // Need to update threads because
@@ -20,7 +20,7 @@ using namespace race;
 ThreadTrace::ThreadTrace(ProgramTrace &program, const pta::CallGraphNodeTy *entry)
     : id(0), program(program), spawnSite(std::nullopt) {
   // Construct the ProgramState used to build the entire program trace
-  ProgramBuildState programState(program.pta);
+  ProgramBuildState programState(program.pta, program.objects, *program.callPaths);
   // TODO: hard coding this for now
   //  but we should have system for customizing which models are added if we have more in the future
   programState.runtimeModels.push_back(std::make_unique<OpenMPRuntime>());
@@ -38,6 +38,9 @@ ThreadTrace::ThreadTrace(const ForkEvent *spawningEvent, ProgramBuildState &prog
 
   // Build the thread trace
   ThreadBuildState state(programState, *this, events, childThreads);
+  // the thread is reached through the call path of its spawn site and the spawn site itself
+  state.callPath = programState.callPaths.getChild(spawningEvent->getCallPath(),
+                                                   llvm::cast<llvm::CallBase>(spawningEvent->getInst()));
   buildTrace(entry, state);
 }
 
@@ -0,0 +1,126 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace race {
+
+// Return the number of workers to use when the user asked for `jobs` workers.
+// 0 means "use every core on this machine"
+inline size_t resolveJobs(size_t jobs) {
+  if (jobs != 0) return jobs;
+  auto const hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : hw;
+}
+
+// Runs body(workerID, index) for every index in [0, numTasks) using `jobs` worker threads.
+//
+// The index space is split into one contiguous range per worker. Each worker consumes its own range
+// from the front. Once a worker runs dry it steals the back half of the largest range left on another
+// worker, so a few expensive tasks at the start of the list cannot serialize the whole run.
+//
+// Every index is owned by exactly one range at any time, so each index is visited exactly once.
+// body must be safe to call concurrently for different workerIDs; workerID is in [0, number of workers).
+template <typename Body>
+void parallelForWorkStealing(size_t jobs, size_t numTasks, Body body) {
+  auto const numWorkers = std::min(resolveJobs(jobs), numTasks);
+  if (numWorkers <= 1) {
+    for (size_t i = 0; i < numTasks; ++i) {
+      body(0, i);
+    }
+    return;
+  }
+
+  struct TaskRange {
+    std::mutex lock;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+  std::vector<TaskRange> ranges(numWorkers);
+  auto const chunk = numTasks / numWorkers;
+  auto const extra = numTasks % numWorkers;
+  size_t next = 0;
+  for (size_t w = 0; w < numWorkers; ++w) {
+    ranges[w].begin = next;
+    next += chunk + (w < extra ? 1 : 0);
+    ranges[w].end = next;
+  }
+
+  // pop the next task from the front of the worker's own range
+  auto const popOwn = [&ranges](size_t worker, size_t &task) {
+    auto &own = ranges[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.begin == own.end) return false;
+    task = own.begin++;
+    return true;
+  };
+
+  // move the back half of the largest other range into this worker's (empty) range
+  auto const steal = [&ranges, numWorkers](size_t worker) {
+    size_t victim = worker;
+    size_t victimSize = 0;
+    for (size_t offset = 1; offset < numWorkers; ++offset) {
+      auto const candidate = (worker + offset) % numWorkers;
+      std::lock_guard<std::mutex> guard(ranges[candidate].lock);
+      auto const size = ranges[candidate].end - ranges[candidate].begin;
+      if (size > victimSize) {
+        victim = candidate;
+        victimSize = size;
+      }
+    }
+    if (victim == worker) return false;
+
+    // lock in index order so two thieves can never deadlock on each other
+    auto &lhs = ranges[std::min(worker, victim)];
+    auto &rhs = ranges[std::max(worker, victim)];
+    std::scoped_lock guard(lhs.lock, rhs.lock);
+
+    auto &from = ranges[victim];
+    auto const remaining = from.end - from.begin;
+    // the victim made progress while we were looking, try again
+    if (remaining == 0) return true;
+
+    auto const mid = from.begin + remaining / 2;
+    auto &own = ranges[worker];
+    own.begin = mid;
+    own.end = from.end;
+    from.end = mid;
+    return true;
+  };
+
+  auto const work = [&](size_t worker) {
+    size_t task = 0;
+    while (true) {
+      if (popOwn(worker, task)) {
+        body(worker, task);
+      } else if (!steal(worker)) {
+        return;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numWorkers - 1);
+  for (size_t w = 1; w < numWorkers; ++w) {
+    threads.emplace_back(work, w);
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace race
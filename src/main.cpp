@@ -27,11 +27,39 @@ static llvm::cl::opt<std::string> DumpPreproccessedIR("dump-ir", cl::desc("Dump
 static llvm::cl::opt<std::string> DumpJSON("json", cl::desc("Dump JSON race report"),
                                            cl::value_desc("destination file"));
 
+static llvm::cl::opt<std::string> StreamJSON(
+    "stream-json", cl::desc("Write each race as one JSON object per line as soon as it is found"),
+    cl::value_desc("destination file"));
+
+static llvm::cl::opt<std::string> DumpMetrics("metrics",
+                                              cl::desc("Dump the time, memory and key counts of each phase as JSON"),
+                                              cl::value_desc("destination file"));
+
 static llvm::cl::opt<bool> PrintTrace("print-trace", cl::desc("print the program trace to stdout"), cl::init(true));
 
 static llvm::cl::opt<bool> DoCoverage(
     "do-cvg", cl::desc("Compute and print the coverage (= analyzed source code/all source code)"), cl::init(true));
 
+static llvm::cl::opt<unsigned> Jobs("jobs", cl::desc("Number of threads used to check for races (0 = one per core)"),
+                                    cl::value_desc("N"), cl::init(1));
+
+static llvm::cl::opt<race::HappensBeforeGraph::Engine> HBEngine(
+    "hb", cl::desc("Happens-before engine"),
+    cl::values(clEnumValN(race::HappensBeforeGraph::Engine::VectorClock, "vc",
+                          "vector clocks over per-thread sync chains (default)"),
+               clEnumValN(race::HappensBeforeGraph::Engine::Reachability, "reach",
+                          "precomputed reachable set of every sync event")),
+    cl::init(race::HappensBeforeGraph::Engine::VectorClock));
+
+static llvm::cl::opt<pta::ContextPolicy> Context(
+    "context", cl::desc("Context sensitivity of the pointer analysis"),
+    cl::values(clEnumValN(pta::ContextPolicy::Insensitive, "none", "context insensitive"),
+               clEnumValN(pta::ContextPolicy::Origin1, "origin1", "the last thread/task creation site"),
+               clEnumValN(pta::ContextPolicy::Origin3, "origin3",
+                          "the last three thread/task creation sites (default)"),
+               clEnumValN(pta::ContextPolicy::CallSite1, "callsite1", "the last call site")),
+    cl::init(pta::ContextPolicy::Origin3));
+
 int main(int argc, char** argv) {
   llvm::InitLLVM X(argc, argv);
   llvm::cl::ParseCommandLineOptions(argc, argv);
@@ -58,8 +86,40 @@ int main(int argc, char** argv) {
   }
   config.printTrace = PrintTrace;
   config.doCoverage = DoCoverage;
+  config.jobs = Jobs;
+  config.hbEngine = HBEngine;
+  config.context = Context;
+  if (!StreamJSON.empty()) {
+    // streamed races are not kept, so there is nothing left to build the JSON report from
+    if (!DumpJSON.empty()) {
+      llvm::errs() << argv[0] << ": error: -json can not be combined with -stream-json\n";
+      return 1;
+    }
+    config.streamRaces = StreamJSON;
+  }
+  if (!DumpMetrics.empty()) {
+    config.dumpMetrics = DumpMetrics;
+  }
 
   auto report = race::detectRaces(module.get(), config);
+  if (report.error.has_value()) {
+    llvm::errs() << argv[0] << ": error: " << report.error.value() << "\n";
+    return 1;
+  }
+  // kept out of the races (and the JSON report) so existing consumers of the output are not affected,
+  // the -metrics JSON has them in "degradations"
+  if (!report.degradations.empty()) {
+    llvm::errs() << "==== Pointer analysis ran out of budget ====\n";
+    for (auto const& degradation : report.degradations) {
+      llvm::errs() << degradation << "\n";
+    }
+  }
+
+  // the races were already written to the stream, and counted by detectRaces
+  if (config.streamRaces.has_value()) {
+    return 0;
+  }
+
   if (report.empty()) {
     llvm::outs() << "No races detected.\n";
     return 0;
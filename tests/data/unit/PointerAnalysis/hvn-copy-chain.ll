@@ -0,0 +1,52 @@
+; Copies that offline pointer equivalence can merge before solving
+; bitcasts and single incoming PHIs are collapsed when the graph is built, so the copy chains are built from selects
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define dso_local i32 @main() {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = alloca i32, align 4
+  %slot = alloca i32*, align 8
+  %cond = load i32, i32* %c, align 4
+  %flag = icmp ne i32 %cond, 0
+  store i32* %c, i32** %slot, align 8
+  br i1 %flag, label %left, label %right
+
+left:
+  br label %join
+
+right:
+  br label %join
+
+join:
+  ; the same incoming pointers in a different order share a label
+  %p = phi i32* [ %a, %left ], [ %b, %right ]
+  %q = phi i32* [ %b, %right ], [ %a, %left ]
+  ; a pointer loaded from memory gets a label of its own
+  %l = load i32*, i32** %slot, align 8
+  br label %chain
+
+chain:
+  ; copy chains inherit the label of their source
+  %r = select i1 %flag, i32* %p, i32* %p
+  %m = select i1 %flag, i32* %l, i32* %l
+  %s = select i1 %flag, i32* %r, i32* %q
+  %p8 = bitcast i32* %p to i8*
+  %q8 = bitcast i32* %q to i8*
+  %s8 = bitcast i32* %s to i8*
+  %l8 = bitcast i32* %l to i8*
+  %m8 = bitcast i32* %m to i8*
+  %c8 = bitcast i32* %c to i8*
+  call void @__cr_alias__(i8* %p8, i8* %q8)
+  call void @__cr_alias__(i8* %p8, i8* %s8)
+  call void @__cr_alias__(i8* %l8, i8* %m8)
+  call void @__cr_alias__(i8* %m8, i8* %c8)
+  call void @__cr_no_alias__(i8* %s8, i8* %m8)
+  ret i32 0
+}
+
+declare dso_local void @__cr_alias__(i8*, i8*)
+
+declare dso_local void @__cr_no_alias__(i8*, i8*)
@@ -9,8 +9,20 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+
 #include <catch2/catch.hpp>
 
+#include "RaceDetect.h"
 #include "helpers/ReportChecking.h"
 
 #define TEST_LL(name, file, ...) \
@@ -412,3 +424,95 @@ TEST_LL("DRB169", "DRB169-missingsyncwrite-orig-yes.ll",
 TEST_LL("DRB170", "DRB170-nestedloops-orig-no.ll", NORACE)
 TEST_LL("DRB171", "DRB171-threadprivate3-orig-no.ll", NORACE)
 TEST_LL("DRB172", "DRB172-critical2-orig-no.ll", NORACE)
+
+// The report must not depend on how many threads were used to check race pairs
+TEST_CASE("Parallel race checking is deterministic", "[integration][dataracebench][omp]") {
+  auto const file = GENERATE(as<std::string>(), "DRB005-indirectaccess1-orig-yes.ll",
+                             "DRB169-missingsyncwrite-orig-yes.ll", "DRB172-critical2-orig-no.ll");
+  llvm::StringRef const llPath = "integration/dataracebench/";
+
+  // detectRaces preprocesses the module in place, so each run gets a fresh copy
+  auto const detect = [&](size_t jobs) {
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic err;
+    auto module = llvm::parseIRFile(llPath.str() + file, err, context);
+    REQUIRE(module.get() != nullptr);
+    auto report = race::detectRaces(module.get(), race::DetectRaceConfig{.printTrace = false, .jobs = jobs});
+    return TestRace::fromRaces(report.races, llPath);
+  };
+
+  CHECK(detect(1) == detect(4));
+}
+
+// Every race of the report is streamed exactly once, however many workers find it, and not kept in the report
+TEST_CASE("Streamed races match the report", "[integration][dataracebench][omp]") {
+  auto const file = GENERATE(as<std::string>(), "DRB005-indirectaccess1-orig-yes.ll",
+                             "DRB169-missingsyncwrite-orig-yes.ll", "DRB172-critical2-orig-no.ll");
+  auto const jobs = GENERATE(1u, 4u);
+  llvm::StringRef const llPath = "integration/dataracebench/";
+  // a new file for every run, so concurrent test runs do not write to the same file
+  llvm::SmallString<128> tempPath;
+  REQUIRE_FALSE(llvm::sys::fs::createTemporaryFile("streamed-races", "ndjson", tempPath));
+  auto const streamPath = tempPath.str().str();
+
+  // detection transforms the module, so each run gets its own
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic err;
+  auto module = llvm::parseIRFile(llPath.str() + file, err, context);
+  REQUIRE(module.get() != nullptr);
+  auto const report = race::detectRaces(module.get(), race::DetectRaceConfig{.printTrace = false, .jobs = jobs});
+
+  auto streamedModule = llvm::parseIRFile(llPath.str() + file, err, context);
+  REQUIRE(streamedModule.get() != nullptr);
+  auto const streamedReport = race::detectRaces(
+      streamedModule.get(), race::DetectRaceConfig{.printTrace = false, .jobs = jobs, .streamRaces = streamPath});
+  REQUIRE_FALSE(streamedReport.error.has_value());
+  CHECK(streamedReport.races.empty());
+
+  std::multiset<std::string> streamed;
+  std::ifstream stream(streamPath);
+  for (std::string line; std::getline(stream, line);) {
+    streamed.insert(race::json::parse(line).dump());
+  }
+  std::filesystem::remove(streamPath);
+
+  std::multiset<std::string> reported;
+  for (auto const &race : report.races) {
+    reported.insert(race::json(race).dump());
+  }
+  CHECK(streamed == reported);
+}
+
+TEST_CASE("Detection fails if races can not be streamed", "[integration][dataracebench][omp]") {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic err;
+  auto module = llvm::parseIRFile("integration/dataracebench/DRB001-antidep1-orig-yes.ll", err, context);
+  REQUIRE(module.get() != nullptr);
+
+  auto const missingDir = std::filesystem::temp_directory_path() / "no-such-directory" / "races.ndjson";
+  auto report = race::detectRaces(module.get(),
+                                  race::DetectRaceConfig{.printTrace = false, .streamRaces = missingDir.string()});
+  REQUIRE(report.error.has_value());
+  CHECK(report.error->find(missingDir.string()) != std::string::npos);
+  CHECK(report.empty());
+}
+
+TEST_CASE("Reported races can be printed after detection returns", "[integration][dataracebench][omp]") {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic err;
+  auto module = llvm::parseIRFile("integration/dataracebench/DRB001-antidep1-orig-yes.ll", err, context);
+  REQUIRE(module.get() != nullptr);
+
+  // the trace the races were found in is destroyed by now, the callstacks are printed from the report
+  auto report = race::detectRaces(module.get(), race::DetectRaceConfig{.printTrace = false});
+  REQUIRE_FALSE(report.empty());
+  for (auto const &race : report.races) {
+    // the race is in the outlined parallel region, reached through the fork in main
+    CHECK_FALSE(race.first.getCallstack().empty());
+
+    std::string printed;
+    llvm::raw_string_ostream os(printed);
+    os << race;
+    CHECK_THAT(os.str(), Catch::Contains("---Callstacks---\n\t> "));
+  }
+}
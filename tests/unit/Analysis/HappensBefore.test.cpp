@@ -48,7 +48,9 @@ declare i32 @pthread_join(i64, i8**)
 
   race::ProgramTrace program(module.get(), "foo");
 
-  race::HappensBeforeGraph happensbefore(program);
+  auto const engine = GENERATE(race::HappensBeforeGraph::Engine::Reachability,
+                               race::HappensBeforeGraph::Engine::VectorClock);
+  race::HappensBeforeGraph happensbefore(program, engine);
 
   auto const &threads = program.getThreads();
   REQUIRE(threads.size() == 2);
@@ -107,7 +109,9 @@ declare void @__kmpc_fork_call(%struct.ident_t*, i32, void (i32*, i32*, ...)*, .
   }
 
   race::ProgramTrace program(module.get());
-  race::HappensBeforeGraph happensbefore(program);
+  auto const engine = GENERATE(race::HappensBeforeGraph::Engine::Reachability,
+                               race::HappensBeforeGraph::Engine::VectorClock);
+  race::HappensBeforeGraph happensbefore(program, engine);
 
   REQUIRE(program.getThreads().size() == 3);
 
@@ -120,4 +124,57 @@ declare void @__kmpc_fork_call(%struct.ident_t*, i32, void (i32*, i32*, ...)*, .
 
   CHECK_FALSE(happensbefore.areParallel(thread1->getEvent(2), thread2->getEvent(0)));
   CHECK_FALSE(happensbefore.areParallel(thread1->getEvent(0), thread2->getEvent(2)));
+}
+
+TEST_CASE("HappensBefore engines agree", "[unit][happensbefore]") {
+  const char *ModuleString = R"(
+%struct.ident_t = type { i32, i32, i32, i32, i8* }
+
+@.str = private unnamed_addr constant [23 x i8] c";unknown;unknown;0;0;;\00", align 1
+@0 = private unnamed_addr constant %struct.ident_t { i32 0, i32 2, i32 0, i32 0, i8* getelementptr inbounds ([23 x i8], [23 x i8]* @.str, i32 0, i32 0) }, align 8
+
+define i32 @main() {
+  %x = alloca i32
+  call void (%struct.ident_t*, i32, void (i32*, i32*, ...)*, ...) @__kmpc_fork_call(%struct.ident_t* @0, i32 1, void (i32*, i32*, ...)* bitcast (void (i32*, i32*, i32*)* @.omp_outlined. to void (i32*, i32*, ...)*), i32* %x)
+  %1 = load i32, i32* %x
+  ret i32 0
+}
+
+define internal void @.omp_outlined.(i32* noalias %.global_tid., i32* noalias %.bound_tid., i32* %x) {
+  store i32 1, i32* %x
+  call void @__kmpc_barrier(%struct.ident_t* @0, i32 0)
+  %1 = load i32, i32* %x
+  call void @__kmpc_barrier(%struct.ident_t* @0, i32 0)
+  store i32 2, i32* %x
+  ret void
+}
+
+declare void @__kmpc_fork_call(%struct.ident_t*, i32, void (i32*, i32*, ...)*, ...)
+declare void @__kmpc_barrier(%struct.ident_t*, i32)
+)";
+
+  llvm::LLVMContext Ctx;
+  llvm::SMDiagnostic Err;
+  auto module = llvm::parseAssemblyString(ModuleString, Err, Ctx);
+  if (!module) {
+    Err.print("error", llvm::errs());
+  }
+
+  race::ProgramTrace program(module.get());
+  race::HappensBeforeGraph reachability(program, race::HappensBeforeGraph::Engine::Reachability);
+  race::HappensBeforeGraph vectorClock(program, race::HappensBeforeGraph::Engine::VectorClock);
+
+  std::vector<const race::Event *> events;
+  for (auto const &thread : program.getThreads()) {
+    for (auto const &event : thread->getEvents()) {
+      events.push_back(event.get());
+    }
+  }
+  REQUIRE(events.size() > 2);
+
+  for (auto const src : events) {
+    for (auto const dst : events) {
+      CHECK(reachability.canReach(src, dst) == vectorClock.canReach(src, dst));
+    }
+  }
 }
\ No newline at end of file
@@ -102,4 +102,11 @@ declare i32 @pthread_create(i64*, %union.pthread_attr_t*, i8* (i8*)*, i8*)
       CHECK(!lockset.sharesLock(holdsLock, noLock));
     }
   }
+
+  // a shared LockSet answers from the same index with its own cache
+  auto shared = lockset.share();
+  auto const first = llvm::cast<race::MemAccessEvent>(events.at(sharedIdxs.front()).get());
+  auto const last = llvm::cast<race::MemAccessEvent>(events.at(sharedIdxs.back()).get());
+  CHECK(shared.sharesLock(first, last));
+  CHECK(!shared.sharesLock(first, llvm::cast<race::MemAccessEvent>(events.at(emptyIdxs.front()).get())));
 }
\ No newline at end of file
@@ -50,3 +50,127 @@ declare i32 @pthread_join(i64, i8**)
   race::ProgramTrace program(module.get(), "foo");
   race::SharedMemory sharedmem(program);
 }
+
+TEST_CASE("SharedMemory groups accesses by thread", "[unit][sharedmemory]") {
+  const char *ModuleString = R"(
+%union.pthread_attr_t = type { i64, [48 x i8] }
+
+@x = global i32 0
+
+define i8* @entry(i8*) {
+    %val = load i32, i32* @x
+    %add = add nsw i32 %val, 1
+    store i32 %add, i32* @x
+    store i32 %val, i32* @x
+    ret i8* null
+}
+
+define void @foo() {
+  %p_thread = alloca i64
+  store i32 1, i32* @x
+  %1 = call i32 @pthread_create(i64* %p_thread, %union.pthread_attr_t* null, i8* (i8*)* @entry, i8* null)
+  %thread = load i64, i64* %p_thread
+  %2 = call i32 @pthread_join(i64 %thread, i8** null)
+  ret void
+}
+
+declare i32 @pthread_create(i64*, %union.pthread_attr_t*, i8* (i8*)*, i8*)
+declare i32 @pthread_join(i64, i8**)
+)";
+
+  llvm::LLVMContext Ctx;
+  llvm::SMDiagnostic Err;
+  auto module = llvm::parseAssemblyString(ModuleString, Err, Ctx);
+  if (!module) {
+    Err.print("error", llvm::errs());
+  }
+
+  race::ProgramTrace program(module.get(), "foo");
+  race::SharedMemory sharedmem(program);
+
+  auto const sharedObjects = sharedmem.getSharedObjects();
+  REQUIRE(sharedObjects.size() == 1);
+
+  auto const threadedWrites = sharedmem.getThreadedWrites(sharedObjects.front());
+  auto const threadedReads = sharedmem.getThreadedReads(sharedObjects.front());
+
+  // one write from the main thread, two from the child, sorted by thread id
+  REQUIRE(threadedWrites.size() == 2);
+  CHECK(threadedWrites[0].tid < threadedWrites[1].tid);
+  CHECK(threadedWrites[0].events.size() == 1);
+  CHECK(threadedWrites[1].events.size() == 2);
+
+  REQUIRE(threadedReads.size() == 1);
+  CHECK(threadedReads[0].tid == threadedWrites[1].tid);
+  CHECK(threadedReads[0].events.size() == 1);
+
+  // every event is filed under the thread it belongs to, in program order
+  for (auto const &[tid, writes] : threadedWrites) {
+    for (auto write : writes) {
+      CHECK(write->getThread().id == tid);
+    }
+  }
+  CHECK(threadedWrites[1].events[0]->getID() < threadedWrites[1].events[1]->getID());
+
+  // the write of main with the read and with both writes of the child
+  size_t pairs = 0;
+  sharedmem.forEachPair(sharedObjects.front(), [&](const race::WriteEvent *write, const race::MemAccessEvent *other) {
+    CHECK(write->getThread().id != other->getThread().id);
+    pairs++;
+    return true;
+  });
+  CHECK(pairs == 3);
+}
+
+TEST_CASE("SharedMemory visits each pair once per common object", "[unit][sharedmemory]") {
+  const char *ModuleString = R"(
+%union.pthread_attr_t = type { i64, [48 x i8] }
+
+@x = global i32 0
+@y = global i32 0
+
+define i8* @entry(i8* %arg) {
+  %flag = icmp eq i8* %arg, null
+  %p = select i1 %flag, i32* @x, i32* @y
+  store i32 1, i32* %p
+  ret i8* null
+}
+
+define void @foo() {
+  %p_thread1 = alloca i64
+  %p_thread2 = alloca i64
+  %1 = call i32 @pthread_create(i64* %p_thread1, %union.pthread_attr_t* null, i8* (i8*)* @entry, i8* null)
+  %2 = call i32 @pthread_create(i64* %p_thread2, %union.pthread_attr_t* null, i8* (i8*)* @entry, i8* null)
+  ret void
+}
+
+declare i32 @pthread_create(i64*, %union.pthread_attr_t*, i8* (i8*)*, i8*)
+)";
+
+  llvm::LLVMContext Ctx;
+  llvm::SMDiagnostic Err;
+  auto module = llvm::parseAssemblyString(ModuleString, Err, Ctx);
+  if (!module) {
+    Err.print("error", llvm::errs());
+  }
+
+  race::ProgramTrace program(module.get(), "foo");
+  race::SharedMemory sharedmem(program);
+
+  // both threads may write either global, so their writes are a pair under both of them
+  auto const sharedObjects = sharedmem.getSharedObjects();
+  REQUIRE(sharedObjects.size() == 2);
+
+  size_t visited = 0;
+  size_t owned = 0;
+  for (auto const obj : sharedObjects) {
+    sharedmem.forEachPair(obj, [&](const race::WriteEvent *write, const race::MemAccessEvent *other) {
+      CHECK(write->getThread().id != other->getThread().id);
+      visited++;
+      if (race::SharedMemory::isFirstCommonObject(obj, write, other)) owned++;
+      return true;
+    });
+  }
+  CHECK(visited == 2);
+  CHECK(owned == 1);
+}
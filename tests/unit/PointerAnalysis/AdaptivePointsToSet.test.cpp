@@ -0,0 +1,136 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Solver/PointsTo/AdaptivePointsToSet.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace pta;
+using Set = AdaptivePointsToSet;
+using Ref = std::set<Set::ElemTy>;
+
+namespace {
+
+// build a set and its reference with up to size elements drawn from [0, range)
+std::pair<Set, Ref> randomSet(std::mt19937 &rng, size_t size, Set::ElemTy range) {
+  std::uniform_int_distribution<Set::ElemTy> dist(0, range - 1);
+  Set set;
+  Ref ref;
+  for (size_t i = 0; i < size; i++) {
+    auto const elem = dist(rng);
+    CHECK(set.test_and_set(elem) == ref.insert(elem).second);
+  }
+  return {set, ref};
+}
+
+void checkSame(const Set &set, const Ref &ref) {
+  REQUIRE(set.count() == ref.size());
+  REQUIRE(set.empty() == ref.empty());
+  REQUIRE(std::vector<Set::ElemTy>(set.begin(), set.end()) == std::vector<Set::ElemTy>(ref.begin(), ref.end()));
+  if (set.count() <= Set::SMALL_SIZE) {
+    CHECK(set.getKind() == Set::Kind::Small);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("AdaptivePointsToSet switches layouts", "[unit][PointerAnalysis]") {
+  Set set;
+  CHECK(set.empty());
+  CHECK(set.begin() == set.end());
+
+  for (Set::ElemTy i = 10; i < 14; i++) {
+    CHECK(set.test_and_set(i));
+  }
+  CHECK_FALSE(set.test_and_set(10));
+  CHECK(set.getKind() == Set::Kind::Small);
+
+  // a fifth element close to the others makes a bitmap
+  set.set(100);
+  CHECK(set.getKind() == Set::Kind::Dense);
+
+  // far away elements are stored as chunks
+  set.set(1000000);
+  set.set(2000000);
+  CHECK(set.getKind() == Set::Kind::Sparse);
+  CHECK(set.test(2000000));
+  CHECK_FALSE(set.test(2000001));
+
+  set.reset(1000000);
+  set.reset(2000000);
+  CHECK(set.getKind() == Set::Kind::Dense);
+  set.reset(100);
+  CHECK(set.getKind() == Set::Kind::Small);
+  checkSame(set, {10, 11, 12, 13});
+
+  set.clear();
+  CHECK(set.empty());
+}
+
+TEST_CASE("AdaptivePointsToSet matches std::set", "[unit][PointerAnalysis]") {
+  std::mt19937 rng(42);
+  // small sets, dense sets and sparse sets, and a mix of them
+  std::vector<std::pair<size_t, Set::ElemTy>> shapes = {{3, 64},     {4, 1000000}, {40, 256},
+                                                         {300, 2048}, {50, 5000000}, {500, 200000}};
+
+  for (int round = 0; round < 30; round++) {
+    for (auto const &[lhsSize, lhsRange] : shapes) {
+      for (auto const &[rhsSize, rhsRange] : shapes) {
+        auto [lhs, lhsRef] = randomSet(rng, lhsSize, lhsRange);
+        auto [rhs, rhsRef] = randomSet(rng, rhsSize, rhsRange);
+        checkSame(lhs, lhsRef);
+        checkSame(rhs, rhsRef);
+
+        Ref both;
+        std::set_intersection(lhsRef.begin(), lhsRef.end(), rhsRef.begin(), rhsRef.end(),
+                              std::inserter(both, both.end()));
+        CHECK(lhs.intersects(rhs) == !both.empty());
+        CHECK(lhs.intersectsFrom(rhs, 100) == (both.lower_bound(100) != both.end()));
+        CHECK(lhs.contains(rhs) == std::includes(lhsRef.begin(), lhsRef.end(), rhsRef.begin(), rhsRef.end()));
+        CHECK((lhs == rhs) == (lhsRef == rhsRef));
+
+        Ref unionRef = lhsRef;
+        unionRef.insert(rhsRef.begin(), rhsRef.end());
+        Set unionSet = lhs;
+        CHECK((unionSet |= rhs) == (unionRef != lhsRef));
+        checkSame(unionSet, unionRef);
+        CHECK(unionSet.contains(lhs));
+        CHECK(unionSet.contains(rhs));
+        CHECK_FALSE((unionSet |= rhs));
+
+        Set intersectSet = lhs;
+        CHECK((intersectSet &= rhs) == (both != lhsRef));
+        checkSame(intersectSet, both);
+
+        Ref diffRef;
+        std::set_difference(lhsRef.begin(), lhsRef.end(), rhsRef.begin(), rhsRef.end(),
+                            std::inserter(diffRef, diffRef.end()));
+        Set diff;
+        diff.intersectWithComplement(lhs, rhs);
+        checkSame(diff, diffRef);
+        // the union minus rhs is what lhs adds
+        Set added = unionSet;
+        added.intersectWithComplement(added, rhs);
+        CHECK(added == diff);
+
+        for (auto elem : rhsRef) {
+          lhs.reset(elem);
+          lhsRef.erase(elem);
+        }
+        checkSame(lhs, lhsRef);
+        CHECK(lhs == diff);
+      }
+    }
+  }
+}
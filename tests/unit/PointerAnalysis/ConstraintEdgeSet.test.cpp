@@ -0,0 +1,82 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Graph/ConstraintGraph/ConstraintEdgeSet.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace pta;
+
+namespace {
+
+void checkSame(const ConstraintEdgeSet &set, const std::set<NodeID> &ref) {
+  REQUIRE(set.empty() == ref.empty());
+  REQUIRE(std::vector<NodeID>(set.begin(), set.end()) == std::vector<NodeID>(ref.begin(), ref.end()));
+}
+
+}  // namespace
+
+TEST_CASE("ConstraintEdgeSet upgrades past the inline capacity", "[unit][PointerAnalysis]") {
+  ConstraintEdgeSet set;
+  CHECK(set.empty());
+  CHECK(set.begin() == set.end());
+
+  CHECK(set.test_and_set(30));
+  CHECK(set.test_and_set(10));
+  CHECK(set.test_and_set(20));
+  CHECK_FALSE(set.test_and_set(10));
+  checkSame(set, {10, 20, 30});
+
+  // iterating a small set stays valid while the set is upgraded to a bit vector
+  auto it = set.begin();
+  auto const ie = set.end();
+  CHECK(set.test_and_set(5));
+  std::vector<NodeID> seen(it, ie);
+  CHECK(seen == std::vector<NodeID>{10, 20, 30});
+  checkSame(set, {5, 10, 20, 30});
+  CHECK(set.test(5));
+  CHECK_FALSE(set.test(6));
+
+  for (NodeID id : {5, 10, 20, 30}) {
+    set.reset(id);
+  }
+  CHECK(set.empty());
+  CHECK(set.begin() == set.end());
+}
+
+TEST_CASE("ConstraintEdgeSet matches std::set", "[unit][PointerAnalysis]") {
+  std::mt19937 rng(42);
+  auto const range = GENERATE(as<NodeID>{}, 8, 1000);
+  std::uniform_int_distribution<NodeID> dist(0, range - 1);
+
+  ConstraintEdgeSet set;
+  std::set<NodeID> ref;
+  for (int round = 0; round < 2000; round++) {
+    auto const id = dist(rng);
+    if (rng() % 3 == 0) {
+      set.reset(id);
+      ref.erase(id);
+    } else {
+      CHECK(set.test_and_set(id) == ref.insert(id).second);
+    }
+    if (round % 50 == 0) {
+      checkSame(set, ref);
+    }
+  }
+  checkSame(set, ref);
+
+  set.clear();
+  CHECK(set.empty());
+  CHECK(set.begin() == set.end());
+}
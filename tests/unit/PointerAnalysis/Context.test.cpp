@@ -0,0 +1,189 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <thread>
+
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <catch2/catch.hpp>
+
+#include "PointerAnalysis/Context/KCallSite.h"
+#include "PointerAnalysis/Context/KOrigin.h"
+
+using namespace pta;
+
+namespace {
+
+const char *ModuleString = R"(
+declare void @callee()
+
+define void @main() {
+  call void @callee()
+  call void @callee()
+  call void @callee()
+  ret void
+}
+)";
+
+// The three calls of ModuleString, in their own LLVMContext
+class CallsFixture {
+ protected:
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module;
+  std::vector<const llvm::Instruction *> calls;
+
+ public:
+  CallsFixture() {
+    llvm::SMDiagnostic err;
+    module = llvm::parseAssemblyString(ModuleString, err, context);
+    REQUIRE(module);
+    for (auto const &inst : module->getFunction("main")->getEntryBlock()) {
+      if (llvm::isa<llvm::CallBase>(inst)) calls.push_back(&inst);
+    }
+    REQUIRE(calls.size() == 3);
+  }
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(CallsFixture, "KCallSite contexts are interned", "[unit][PointerAnalysis]") {
+  using Ctx = KCallSite<2>;
+  using CT = CtxTrait<Ctx>;
+  CT::State state;
+  auto const scope = CT::bind(state);
+
+  auto const init = CT::getInitialCtx();
+  auto const c0 = CT::contextEvolve(init, calls[0]);
+  auto const c01 = CT::contextEvolve(c0, calls[1]);
+  CHECK(CT::contextEvolve(init, calls[0]) == c0);
+  CHECK(CT::contextEvolve(c0, calls[1]) == c01);
+  CHECK(CT::getNumCtx() == 2);
+
+  // IDs are dense and distinct from the initial and global context
+  CHECK(init->getID() == ContextArena<Ctx>::INITIAL_CTX_ID);
+  CHECK(CT::getGlobalCtx()->getID() == ContextArena<Ctx>::GLOBAL_CTX_ID);
+  CHECK(c0->getID() == ContextArena<Ctx>::FIRST_ID);
+  CHECK(c01->getID() == ContextArena<Ctx>::FIRST_ID + 1);
+
+  // <0, 1> pushed with 2 drops 0, and <1> pushed with 2 gives the same context
+  auto const c012 = CT::contextEvolve(c01, calls[2]);
+  auto const c1 = CT::contextEvolve(init, calls[1]);
+  CHECK(CT::contextEvolve(c1, calls[2]) == c012);
+  CHECK(c012->getHash() == std::hash<Ctx>()(*c012));
+  CHECK(CT::getNumCtx() == 4);
+
+  CT::release();
+  CHECK(CT::getNumCtx() == 0);
+}
+
+TEST_CASE_METHOD(CallsFixture, "KOrigin asks the origin rules once per call site", "[unit][PointerAnalysis]") {
+  using Ctx = KOrigin<1>;
+  using CT = CtxTrait<Ctx>;
+  CT::State state;
+  auto const scope = CT::bind(state);
+
+  int queries = 0;
+  Ctx::setOriginRules([&](const Ctx *, const llvm::Instruction *I) {
+    queries++;
+    return I == calls[0];
+  });
+
+  auto const init = CT::getInitialCtx();
+  auto const origin = CT::contextEvolve(init, calls[0]);
+  CHECK(origin != init);
+  CHECK(CT::contextEvolve(init, calls[1]) == init);
+  CHECK(CT::contextEvolve(init, calls[0]) == origin);
+  CHECK(CT::contextEvolve(init, calls[1]) == init);
+  CHECK(queries == 2);
+  CHECK(CT::getNumCtx() == 1);
+
+  // new rules must not reuse the decisions of the old ones
+  Ctx::setOriginRules([](const Ctx *, const llvm::Instruction *) { return false; });
+  CHECK(CT::contextEvolve(init, calls[0]) == init);
+}
+
+TEST_CASE_METHOD(CallsFixture, "KOrigin only remembers the configured number of origins", "[unit][PointerAnalysis]") {
+  using Ctx = KOrigin<3>;
+  using CT = CtxTrait<Ctx>;
+  CT::State state;
+  auto const scope = CT::bind(state);
+
+  auto const always = [](const Ctx *, const llvm::Instruction *) { return true; };
+  auto const init = CT::getInitialCtx();
+
+  Ctx::setOriginRules(always, 1);
+  auto const c1 = CT::contextEvolve(init, calls[1]);
+  CHECK(CT::contextEvolve(CT::contextEvolve(init, calls[0]), calls[1]) == c1);
+  CHECK(c1->getLast() == calls[1]);
+
+  Ctx::setOriginRules(always, 3);
+  CHECK(CT::contextEvolve(CT::contextEvolve(init, calls[0]), calls[1]) != c1);
+}
+
+TEST_CASE_METHOD(CallsFixture, "Frozen contexts only evolve into existing contexts", "[unit][PointerAnalysis]") {
+  using Ctx = KCallSite<2>;
+  using CT = CtxTrait<Ctx>;
+  CT::State state;
+  auto const scope = CT::bind(state);
+
+  auto const init = CT::getInitialCtx();
+  auto const c0 = CT::contextEvolve(init, calls[0]);
+
+  CHECK(CT::freeze());
+  CHECK_FALSE(CT::freeze());
+  CHECK(CT::contextEvolve(init, calls[0]) == c0);
+  CHECK(CT::contextEvolve(init, calls[1]) == init);
+  CHECK(CT::contextEvolve(c0, calls[1]) == c0);
+  CHECK(CT::getNumCtx() == 1);
+
+  // evolutions decided while frozen are not reused
+  CT::thaw();
+  auto const c1 = CT::contextEvolve(init, calls[1]);
+  CHECK(c1 != init);
+  CHECK(CT::getNumCtx() == 2);
+}
+
+TEST_CASE_METHOD(CallsFixture, "Context states are independent", "[unit][PointerAnalysis]") {
+  using Ctx = KOrigin<1>;
+  using CT = CtxTrait<Ctx>;
+  CT::State first;
+  CT::State second;
+
+  const Ctx *origin = nullptr;
+  {
+    auto const scope = CT::bind(first);
+    Ctx::setOriginRules([&](const Ctx *, const llvm::Instruction *I) { return I == calls[0]; });
+    origin = CT::contextEvolve(CT::getInitialCtx(), calls[0]);
+    CHECK(origin != CT::getInitialCtx());
+    CHECK(CT::getNumCtx() == 1);
+  }
+
+  {
+    // the rules and contexts of the first state are not visible here
+    auto const scope = CT::bind(second);
+    CHECK(CT::getNumCtx() == 0);
+    CHECK(CT::contextEvolve(CT::getInitialCtx(), calls[0]) == CT::getInitialCtx());
+  }
+
+  // a state can be bound on another thread and sees the same contexts
+  const Ctx *evolved = nullptr;
+  std::thread([&]() {
+    auto const scope = CT::bind(first);
+    evolved = CT::contextEvolve(CT::getInitialCtx(), calls[0]);
+  }).join();
+  CHECK(evolved == origin);
+
+  auto const scope = CT::bind(first);
+  CHECK(CT::getNumCtx() == 1);
+}
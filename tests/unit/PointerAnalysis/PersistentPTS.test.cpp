@@ -0,0 +1,101 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "PointerAnalysis/Solver/PointsTo/PersistentPTS.h"
+
+#include <catch2/catch.hpp>
+
+using namespace pta;
+using PT = PTSTrait<PersistentPTS>;
+
+TEST_CASE("PersistentPTS shares identical sets", "[unit][PointerAnalysis]") {
+  PT::State state;
+  auto const scope = PT::bind(state);
+  for (NodeID id = 0; id < 4; id++) {
+    PT::onNewNodeCreation(id);
+  }
+  auto const initialPool = PersistentPTS::poolSize();
+
+  CHECK(PT::isEmpty(0));
+  CHECK(PT::insert(0, 10));
+  CHECK_FALSE(PT::insert(0, 10));
+  CHECK(PT::insert(1, 10));
+  // {10} is stored once
+  CHECK(PT::equal(0, 1));
+  CHECK(PersistentPTS::poolSize() == initialPool + 1);
+
+  CHECK(PT::insert(2, 20));
+  CHECK(PT::unionWith(0, 2));
+  CHECK(PT::has(0, 10));
+  CHECK(PT::has(0, 20));
+  CHECK(PT::count(0) == 2);
+  CHECK_FALSE(PT::unionWith(0, 2));
+  CHECK(PT::contains(0, 1));
+  CHECK_FALSE(PT::contains(1, 0));
+
+  // the same union again is memoized and does not add to the pool
+  auto const poolSize = PersistentPTS::poolSize();
+  CHECK(PT::unionWith(1, 2));
+  CHECK(PT::equal(0, 1));
+  CHECK(PersistentPTS::poolSize() == poolSize);
+
+  llvm::SparseBitVector<> extra;
+  extra.set(30);
+  CHECK(PT::unionWithPts(3, extra));
+  CHECK_FALSE(PT::unionWithPts(3, extra));
+  CHECK(PT::intersectWith(3, 3));
+  CHECK_FALSE(PT::intersectWith(0, 3));
+
+  PT::clear(0);
+  CHECK(PT::isEmpty(0));
+  CHECK_FALSE(PT::equal(0, 1));
+}
+
+TEST_CASE("PersistentPTS compaction frees unused sets", "[unit][PointerAnalysis]") {
+  PT::State state;
+  auto const scope = PT::bind(state);
+  for (NodeID id = 0; id < 3; id++) {
+    PT::onNewNodeCreation(id);
+  }
+
+  // every insert leaves the previous set of node 0 behind
+  for (NodeID target = 10; target < 20; target++) {
+    PT::insert(0, target);
+  }
+  PT::insert(1, 10);
+  PT::insert(2, 20);
+  CHECK(PT::unionWith(1, 2));
+  auto const poolSize = PersistentPTS::poolSize();
+
+  PersistentPTS::compact();
+  // the empty set, {10..19}, {10, 20} and {20}
+  CHECK(PersistentPTS::poolSize() == 4);
+  CHECK(PersistentPTS::poolSize() < poolSize);
+
+  CHECK(PT::count(0) == 10);
+  CHECK(PT::has(0, 19));
+  CHECK(PT::has(1, 10));
+  CHECK(PT::has(1, 20));
+  CHECK(PT::count(1) == 2);
+
+  // new sets are still shared with the renumbered ones
+  PT::onNewNodeCreation(3);
+  PT::insert(3, 10);
+  CHECK(PersistentPTS::poolSize() == 5);
+  CHECK(PT::unionWith(3, 2));
+  CHECK(PT::equal(1, 3));
+  CHECK(PersistentPTS::poolSize() == 5);
+
+  // below the first collection size, collecting garbage does nothing
+  PT::clear(3);
+  PT::collectGarbage();
+  CHECK(PersistentPTS::poolSize() == 5);
+}
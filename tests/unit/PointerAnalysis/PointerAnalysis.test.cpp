@@ -9,6 +9,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <thread>
+
 #include <catch2/catch.hpp>
 
 #include "PointerAnalysis/Context/NoCtx.h"
@@ -16,11 +18,15 @@ limitations under the License.
 #include "PointerAnalysis/Models/MemoryModel/FieldSensitive/FSMemModel.h"
 #include "PointerAnalysis/PointerAnalysisPass.h"
 #include "PointerAnalysis/Solver/PartialUpdateSolver.h"
+#include "PointerAnalysis/Solver/PointsTo/AdaptivePTS.h"
+#include "PointerAnalysis/Solver/PointsTo/PersistentPTS.h"
 #include "PreProcessing/Passes/CanonicalizeGEPPass.h"
 #include "PreProcessing/Passes/InsertGlobalCtorCallPass.h"
 #include "PreProcessing/Passes/LoweringMemCpyPass.h"
 #include "PreProcessing/Passes/RemoveExceptionHandlerPass.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/ValueSymbolTable.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/CommandLine.h"
 
@@ -28,9 +34,54 @@ using namespace pta;
 
 using Model = DefaultLangModel<NoCtx, FSMemModel<NoCtx>>;
 using Solver = PartialUpdateSolver<Model>;
+using PersistentSolver = PartialUpdateSolver<DefaultLangModel<NoCtx, FSMemModel<NoCtx>, PersistentPTS>>;
+using AdaptiveSolver = PartialUpdateSolver<DefaultLangModel<NoCtx, FSMemModel<NoCtx>, AdaptivePTS>>;
 
 namespace {
 
+// Two pointers, and whether they are expected to alias
+using AliasCheck = std::tuple<const llvm::Value *, const llvm::Value *, bool>;
+
+// The pointers of every __cr_alias__/__cr_no_alias__ call
+std::vector<AliasCheck> getAliasChecks(const llvm::Module &module) {
+  std::vector<AliasCheck> checks;
+  for (auto const &func : module.getFunctionList()) {
+    for (auto const &basicblock : func.getBasicBlockList()) {
+      for (auto const &inst : basicblock.getInstList()) {
+        auto call = llvm::dyn_cast<llvm::CallBase>(&inst);
+        if (!call || !call->getCalledFunction() || !call->getCalledFunction()->hasName()) continue;
+
+        auto const name = call->getCalledFunction()->getName();
+        if (name.contains("__cr_no_alias__")) {
+          checks.emplace_back(call->getArgOperand(0), call->getArgOperand(1), false);
+        } else if (name.contains("__cr_alias__")) {
+          checks.emplace_back(call->getArgOperand(0), call->getArgOperand(1), true);
+        }
+      }
+    }
+  }
+  return checks;
+}
+
+// Parse the file and run the preprocessing the pointer analysis expects
+std::unique_ptr<llvm::Module> loadModule(const std::string &file, llvm::LLVMContext &context) {
+  llvm::SMDiagnostic err;
+  auto module = llvm::parseIRFile(file, err, context);
+  if (!module) {
+    err.print(file.c_str(), llvm::errs());
+    return nullptr;
+  }
+
+  llvm::legacy::PassManager passes;
+  passes.add(new LegacyCanonicalizeGEPPass());
+  passes.add(new LoweringMemCpyLegacyPass());
+  passes.add(new RemoveExceptionHandlerLegacyPass());
+  passes.add(new InsertGlobalCtorCallPass());
+  passes.run(*module);
+  return module;
+}
+
+template <typename Solver>
 class PTAVerificationPass : public llvm::ModulePass {
  public:
   using ctx = NoCtx;
@@ -49,48 +100,101 @@ class PTAVerificationPass : public llvm::ModulePass {
     this->getAnalysis<PointerAnalysisPass<Solver>>().analyze(&module, "main");
     auto &pta = *(this->getAnalysis<PointerAnalysisPass<Solver>>().getPTA());
 
-    auto const isAliasCheck = [](const llvm::CallBase *call) {
-      auto const func = call->getCalledFunction();
-      if (!func || !func->hasName()) return false;
-      return func->getName().contains("__cr_alias__");
-    };
-
-    auto const isNoAliasCheck = [](const llvm::CallBase *call) {
-      auto const func = call->getCalledFunction();
-      if (!func || !func->hasName()) return false;
-      return func->getName().contains("__cr_no_alias__");
-    };
+    // every merged node must resolve to a super node that is not merged any further
+    auto const consGraph = pta.getConsGraph();
+    uint64_t mergedNodes = 0;
+    bool resolvedToRoot = true;
+    for (auto node : *consGraph) {
+      if (node->hasSuperNode()) mergedNodes++;
+      resolvedToRoot &= !node->getSuperNode()->hasSuperNode();
+    }
+    CHECK(resolvedToRoot);
+    CHECK(mergedNodes == consGraph->getSuperNodeStats().mergedNodes);
 
-    for (auto const &func : module.getFunctionList()) {
-      for (auto const &basicblock : func.getBasicBlockList()) {
-        for (auto const &inst : basicblock.getInstList()) {
-          auto call = llvm::dyn_cast<llvm::CallBase>(&inst);
-          if (!call) continue;
-
-          if (isNoAliasCheck(call)) {
-            auto ptr1 = call->getArgOperand(0);
-            auto ptr2 = call->getArgOperand(1);
-            CHECK_FALSE(pta.alias(nullptr, ptr1, nullptr, ptr2));
-          } else if (isAliasCheck(call)) {
-            auto ptr1 = call->getArgOperand(0);
-            auto ptr2 = call->getArgOperand(1);
-            CHECK(pta.alias(nullptr, ptr1, nullptr, ptr2));
-          }
-        }
+    // the incrementally maintained order must be a topological order of the (collapsed) copy graph
+    auto const &copyOrder = pta.getCopyGraphOrder();
+    bool topological = true;
+    for (auto node : *consGraph) {
+      if (node->hasSuperNode()) continue;
+      for (auto it = node->succ_copy_begin(), ie = node->succ_copy_end(); it != ie; it++) {
+        auto const succ = (*it)->getSuperNode();
+        topological &= succ == node || copyOrder.getPosition(node) < copyOrder.getPosition(succ);
       }
     }
+    CHECK(topological);
+
+    for (auto const &[ptr1, ptr2, expected] : getAliasChecks(module)) {
+      CHECK(pta.alias(nullptr, ptr1, nullptr, ptr2) == expected);
+    }
 
     return false;
   }
 };
 
-char PTAVerificationPass::ID = 0;
+template <typename Solver>
+char PTAVerificationPass<Solver>::ID = 0;
 static llvm::RegisterPass<PointerAnalysisPass<Solver>> PAP("Pointer Analysis Wrapper Pass",
                                                            "Pointer Analysis Wrapper Pass", true, true);
+static llvm::RegisterPass<PointerAnalysisPass<PersistentSolver>> PPAP("Persistent Pointer Analysis Wrapper Pass",
+                                                                      "Pointer Analysis Wrapper Pass", true, true);
+static llvm::RegisterPass<PointerAnalysisPass<AdaptiveSolver>> APAP("Adaptive Pointer Analysis Wrapper Pass",
+                                                                    "Pointer Analysis Wrapper Pass", true, true);
+
+// Run the pointer analysis on the file and check every __cr_alias__/__cr_no_alias__ call in it
+template <typename Solver>
+void verifyPointerAnalysis(const std::string &file) {
+  llvm::SMDiagnostic err;
+  llvm::LLVMContext context;
+  auto module = llvm::parseIRFile(file, err, context);
+  if (!module) {
+    err.print(file.c_str(), llvm::errs());
+  }
+  REQUIRE(module != nullptr);
+
+  llvm::legacy::PassManager passes;
+
+  passes.add(new LegacyCanonicalizeGEPPass());
+  passes.add(new LoweringMemCpyLegacyPass());
+  passes.add(new RemoveExceptionHandlerLegacyPass());
+
+  passes.add(new InsertGlobalCtorCallPass());
+  passes.add(new PointerAnalysisPass<Solver>());
+  passes.add(new PTAVerificationPass<Solver>());
+
+  passes.run(*module);
+}
+
+// Sets a command line option until the end of the scope, also when a REQUIRE fails
+template <typename T>
+class OptionGuard {
+  llvm::cl::opt<T> &option;
+  const T previous;
+
+ public:
+  OptionGuard(llvm::cl::opt<T> &option, T value) : option(option), previous(option.getValue()) { option = value; }
+  ~OptionGuard() { option = previous; }
+
+  OptionGuard(const OptionGuard &) = delete;
+  OptionGuard &operator=(const OptionGuard &) = delete;
+};
+
+// The names of the objects the pointer with the given name in main points to
+std::set<std::string> getTargetNames(const Solver &pta, const llvm::Module &module, llvm::StringRef name) {
+  auto const ptr = module.getFunction("main")->getValueSymbolTable()->lookup(name);
+  REQUIRE(ptr != nullptr);
+
+  std::multiset<const Solver::ObjTy *> objects;
+  pta.getPointsTo(nullptr, ptr, objects);
+  std::set<std::string> names;
+  for (auto obj : objects) {
+    names.insert(obj->getValue()->getName().str());
+  }
+  return names;
+}
 
 }  // namespace
 
-TEST_CASE("PointerAnalysis", "[unit][PointerAnalysis]") {
+TEMPLATE_TEST_CASE("PointerAnalysis", "[unit][PointerAnalysis]", Solver, PersistentSolver, AdaptiveSolver) {
   const std::string prefix = "unit/PointerAnalysis/";
   auto file = GENERATE(
       "array-constIdx.ll", "global-call-struct.ll", "spec-vortex.ll", "array-varIdx2.ll", "struct-array.ll",
@@ -103,29 +207,174 @@ TEST_CASE("PointerAnalysis", "[unit][PointerAnalysis]") {
       "field-ptr-arith-constIdx.ll", "ptr-dereference2.ll", "struct-nested-array3.ll", "funptr-nested-call.ll",
       "ptr-dereference3.ll", "struct-onefld.ll", "funptr-simple.ll", "spec-equake.ll", "struct-simple.ll",
       "funptr-struct.ll", "spec-gap.ll", "struct-twoflds.ll", "global-array.ll", "spec-mesa.ll",
-      "global-call-noparam.ll", "spec-parser.ll");
+      "global-call-noparam.ll", "spec-parser.ll", "hvn-copy-chain.ll");
   // "global-call-twoparms.ll" fails without allowing more than 1 indirect target
   // TODO: this case fails so I removed it "mesa.ll",
+  // solve both sequentially and in parallel waves (points-to sets that can not be updated concurrently use 1 job)
+  auto const jobs = GENERATE(1u, 4u);
+  auto const offlineHVN = GENERATE(false, true);
 
-  SECTION(std::string(file)) {
-    llvm::SMDiagnostic err;
-    llvm::LLVMContext context;
-    auto module = llvm::parseIRFile(prefix + file, err, context);
-    if (!module) {
-      err.print(std::string(file).c_str(), llvm::errs());
+  SECTION(std::string(file) + " jobs=" + std::to_string(jobs) + " hvn=" + (offlineHVN ? "on" : "off")) {
+    OptionGuard<unsigned> jobsOption(ConfigPTAJobs, jobs);
+    OptionGuard<bool> hvnOption(ConfigPTAOfflineHVN, offlineHVN);
+    verifyPointerAnalysis<TestType>(prefix + file);
+  }
+}
+
+TEST_CASE("Offline pointer equivalence merges copies", "[unit][PointerAnalysis]") {
+  // one module per analysis, so the merged nodes of one cannot leak into the other
+  llvm::LLVMContext baselineContext;
+  llvm::LLVMContext reducedContext;
+  auto baselineModule = loadModule("unit/PointerAnalysis/hvn-copy-chain.ll", baselineContext);
+  auto reducedModule = loadModule("unit/PointerAnalysis/hvn-copy-chain.ll", reducedContext);
+  REQUIRE(baselineModule != nullptr);
+  REQUIRE(reducedModule != nullptr);
+
+  Solver baseline;
+  baseline.analyze(baselineModule.get(), "main");
+  CHECK(baseline.getPointerEquivalenceStats().mergedNodes == 0);
+
+  Solver reduced;
+  {
+    OptionGuard<bool> hvnOption(ConfigPTAOfflineHVN, true);
+    reduced.analyze(reducedModule.get(), "main");
+  }
+  // p/q share their incoming pointers, r/s copy them and m copies the loaded l
+  CHECK(reduced.getPointerEquivalenceStats().mergedNodes >= 4);
+
+  // merging must not change any points-to set
+  for (auto const name : {"p", "q", "r", "s", "l", "m"}) {
+    INFO(name);
+    auto const targets = getTargetNames(baseline, *baselineModule, name);
+    CHECK_FALSE(targets.empty());
+    CHECK(getTargetNames(reduced, *reducedModule, name) == targets);
+  }
+}
+
+TEST_CASE("PointerAnalysis degrades when it runs out of budget", "[unit][PointerAnalysis]") {
+  llvm::LLVMContext context;
+  auto module = loadModule("unit/PointerAnalysis/spec-vortex.ll", context);
+  REQUIRE(module != nullptr);
+
+  SECTION("within budget") {
+    Solver solver;
+    solver.analyze(module.get(), "main");
+    CHECK(solver.getDegradations().empty());
+  }
+
+  SECTION("over the memory budget") {
+    // any process uses more than 1MB
+    OptionGuard<unsigned> memBudget(ConfigPTAMemBudget, 1);
+    Solver solver;
+    solver.analyze(module.get(), "main");
+
+    // there are no contexts to freeze, so the first step gives up field sensitivity
+    auto const &degradations = solver.getDegradations();
+    REQUIRE_FALSE(degradations.empty());
+    CHECK(degradations.front().find("memory budget exceeded") != std::string::npos);
+    CHECK(degradations.front().find("field-insensitively") != std::string::npos);
+
+    // solving is never stopped early unless asked for
+    for (auto const &degradation : degradations) {
+      CHECK(degradation.find("stopped solving") == std::string::npos);
+    }
+  }
+}
+
+TEST_CASE("PointerAnalysis instances do not share state", "[unit][PointerAnalysis]") {
+  // one LLVMContext per module, so nothing cached from the types of one module can match the other
+  llvm::LLVMContext firstContext;
+  llvm::LLVMContext secondContext;
+  auto first = loadModule("unit/PointerAnalysis/heap-linkedlist.ll", firstContext);
+  auto second = loadModule("unit/PointerAnalysis/spec-equake.ll", secondContext);
+  REQUIRE(first != nullptr);
+  REQUIRE(second != nullptr);
+  auto const firstChecks = getAliasChecks(*first);
+  auto const secondChecks = getAliasChecks(*second);
+  REQUIRE_FALSE(firstChecks.empty());
+  REQUIRE_FALSE(secondChecks.empty());
+
+  SECTION("one after the other") {
+    // the second analysis must not reset the points-to sets or objects of the first
+    Solver firstPTA;
+    firstPTA.analyze(first.get(), "main");
+    Solver secondPTA;
+    secondPTA.analyze(second.get(), "main");
+
+    for (auto const &[ptr1, ptr2, expected] : firstChecks) {
+      CHECK(firstPTA.alias(nullptr, ptr1, nullptr, ptr2) == expected);
+    }
+    for (auto const &[ptr1, ptr2, expected] : secondChecks) {
+      CHECK(secondPTA.alias(nullptr, ptr1, nullptr, ptr2) == expected);
     }
-    REQUIRE(module != nullptr);
+  }
+
+  SECTION("at the same time") {
+    // every instance is analyzed and queried by its own thread, while the other one runs
+    auto const analyzeAndCheck = [](llvm::Module *module, const std::vector<AliasCheck> &checks, bool &correct) {
+      Solver pta;
+      pta.analyze(module, "main");
+      for (auto const &[ptr1, ptr2, expected] : checks) {
+        if (pta.alias(nullptr, ptr1, nullptr, ptr2) != expected) correct = false;
+      }
+    };
+
+    bool firstCorrect = true;
+    bool secondCorrect = true;
+    std::thread firstThread(analyzeAndCheck, first.get(), std::cref(firstChecks), std::ref(firstCorrect));
+    std::thread secondThread(analyzeAndCheck, second.get(), std::cref(secondChecks), std::ref(secondCorrect));
+    firstThread.join();
+    secondThread.join();
+
+    CHECK(firstCorrect);
+    CHECK(secondCorrect);
+  }
+}
 
-    llvm::legacy::PassManager passes;
+TEMPLATE_TEST_CASE("PointerAnalysis can be queried from many threads", "[unit][PointerAnalysis]", Solver,
+                   PersistentSolver, AdaptiveSolver) {
+  llvm::LLVMContext context;
+  auto module = loadModule("unit/PointerAnalysis/spec-equake.ll", context);
+  REQUIRE(module != nullptr);
 
-    passes.add(new LegacyCanonicalizeGEPPass());
-    passes.add(new LoweringMemCpyLegacyPass());
-    passes.add(new RemoveExceptionHandlerLegacyPass());
+  TestType pta;
+  pta.analyze(module.get(), "main");
 
-    passes.add(new InsertGlobalCtorCallPass());
-    passes.add(new PointerAnalysisPass<Solver>());
-    passes.add(new PTAVerificationPass());
+  std::vector<const llvm::Value *> pointers;
+  for (auto const &func : module->getFunctionList()) {
+    for (auto const &inst : llvm::instructions(func)) {
+      if (inst.getType()->isPointerTy()) pointers.push_back(&inst);
+    }
+  }
+  REQUIRE(pointers.size() > 100);
 
-    passes.run(*module);
+  // every thread runs the same queries on the one instance, and must get what a single thread gets
+  using Answers = std::vector<std::pair<std::multiset<const typename TestType::ObjTy *>, bool>>;
+  auto const query = [&]() {
+    Answers answers;
+    for (size_t i = 0; i < pointers.size(); i++) {
+      std::multiset<const typename TestType::ObjTy *> objects;
+      pta.getPointsTo(nullptr, pointers[i], objects);
+      auto const next = pointers[(i + 1) % pointers.size()];
+      answers.emplace_back(std::move(objects), pta.aliasIfExsit(nullptr, pointers[i], nullptr, next));
+    }
+    for (auto const &func : module->getFunctionList()) {
+      answers.emplace_back(std::multiset<const typename TestType::ObjTy *>{},
+                           pta.getDirectNodeOrNull(nullptr, &func) != nullptr);
+    }
+    return answers;
+  };
+  auto const expected = query();
+
+  std::vector<Answers> results(4);
+  std::vector<std::thread> threads;
+  for (auto &result : results) {
+    threads.emplace_back([&]() { result = query(); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto const &result : results) {
+    CHECK(result == expected);
   }
 }
@@ -0,0 +1,44 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <filesystem>
+#include <fstream>
+
+#include <catch2/catch.hpp>
+
+#include "Reporter/SourceCache.h"
+
+TEST_CASE("SourceCache returns lines of a source file", "[unit][reporter]") {
+  auto const dir = std::filesystem::temp_directory_path();
+  auto const filename = "source-cache-test.c";
+  {
+    std::ofstream source(dir / filename, std::ios::binary);
+    source << "int x;\r\n\nvoid f() { x++; }\nint y;";
+  }
+
+  race::SourceCache cache;
+  CHECK(cache.getLine(dir.string(), filename, 1) == llvm::StringRef("int x;"));
+  CHECK(cache.getLine(dir.string(), filename, 2) == llvm::StringRef(""));
+  CHECK(cache.getLine(dir.string(), filename, 3) == llvm::StringRef("void f() { x++; }"));
+  // the last line has no line break
+  CHECK(cache.getLine(dir.string(), filename, 4) == llvm::StringRef("int y;"));
+  CHECK_FALSE(cache.getLine(dir.string(), filename, 5).has_value());
+  CHECK_FALSE(cache.getLine(dir.string(), filename, 0).has_value());
+
+  // an absolute filename does not depend on the directory
+  CHECK(cache.getLine("/nonexistent", (dir / filename).string(), 4) == llvm::StringRef("int y;"));
+
+  // the file is only read once, later changes are not seen
+  std::filesystem::remove(dir / filename);
+  CHECK(cache.getLine(dir.string(), filename, 3) == llvm::StringRef("void f() { x++; }"));
+
+  CHECK_FALSE(cache.getLine(dir.string(), "missing-source-cache-test.c", 1).has_value());
+}
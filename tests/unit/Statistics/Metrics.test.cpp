@@ -0,0 +1,74 @@
+/* Copyright 2021 Coderrect Inc. All Rights Reserved.
+Licensed under the GNU Affero General Public License, version 3 or later (“AGPL”), as published by the Free Software
+Foundation. You may not use this file except in compliance with the License. You may obtain a copy of the License at
+https://www.gnu.org/licenses/agpl-3.0.en.html
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an “AS IS” BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include "Statistics/Metrics.h"
+
+TEST_CASE("Metrics adds up repeated phases and counts", "[unit][metrics]") {
+  race::Metrics metrics;
+  {
+    auto const phase = metrics.start("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  metrics.count("first", "items", 2);
+  {
+    auto const phase = metrics.start("second");
+  }
+  {
+    // e.g. once per worker
+    auto const phase = metrics.start("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  metrics.count("first", "items", 3);
+  metrics.count("first", "other", 1);
+
+  auto const &phases = metrics.getPhases();
+  REQUIRE(phases.size() == 2);
+  CHECK(phases[0].name == "first");
+  CHECK(phases[1].name == "second");
+  CHECK(phases[0].wallSeconds >= 0.01);
+  CHECK(phases[0].counts == std::vector<std::pair<std::string, uint64_t>>{{"items", 5}, {"other", 1}});
+  CHECK(phases[1].counts.empty());
+  metrics.setDegradations({"first step", "second step"});
+
+  auto const path = std::filesystem::temp_directory_path() / "metrics-test.json";
+  metrics.dump(path.string());
+  std::ifstream input(path);
+  auto const json = nlohmann::json::parse(input);
+  std::filesystem::remove(path);
+
+  REQUIRE(json["phases"].size() == 2);
+  CHECK(json["phases"][0]["name"] == "first");
+  CHECK(json["phases"][0]["counts"]["items"] == 5);
+  CHECK(json["phases"][0]["wallSeconds"] >= 0.01);
+  CHECK(json["phases"][1].contains("cpuSeconds"));
+  CHECK(json["phases"][1].contains("peakRSSDeltaKB"));
+  CHECK(json["degradations"] == nlohmann::json::array({"first step", "second step"}));
+}
+
+TEST_CASE("Metrics always lists the degradations", "[unit][metrics]") {
+  race::Metrics metrics;
+  auto const path = std::filesystem::temp_directory_path() / "metrics-no-degradations-test.json";
+  metrics.dump(path.string());
+  std::ifstream input(path);
+  auto const json = nlohmann::json::parse(input);
+  std::filesystem::remove(path);
+
+  REQUIRE(json.contains("degradations"));
+  CHECK(json["degradations"].is_array());
+  CHECK(json["degradations"].empty());
+}
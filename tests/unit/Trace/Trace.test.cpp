@@ -63,6 +63,25 @@ define i32 @main() {
   REQUIRE(events.at(3)->type == race::Event::Type::CallEnd);
   REQUIRE(events.at(4)->type == race::Event::Type::Read);
   REQUIRE(events.at(5)->type == race::Event::Type::ExternCall);
+
+  // every access is to %x, so all of them resolve to the same single object in the trace's object table
+  auto const read = llvm::cast<race::MemAccessEvent>(events.at(1).get());
+  auto const write = llvm::cast<race::MemAccessEvent>(events.at(2).get());
+  auto const pvalRead = llvm::cast<race::MemAccessEvent>(events.at(4).get());
+  REQUIRE(read->getAccessedMemory().size() == 1);
+  CHECK(read->getAccessedMemory() == write->getAccessedMemory());
+  CHECK(read->getAccessedMemory() == pvalRead->getAccessedMemory());
+  auto const x = &module->getFunction("foo")->getEntryBlock().front();
+  CHECK(program.objects.getObject(read->getAccessedMemory().front())->getValue() == x);
+
+  // events are reached through the pthread_create in main, and those in adder also through the call in foo
+  auto const spawn = llvm::cast<llvm::CallBase>(&module->getFunction("main")->getEntryBlock().front());
+  auto const callAdder = llvm::cast<llvm::CallBase>(x->getNextNode());
+  CHECK(read->getCallPath() == write->getCallPath());
+  CHECK(program.callPaths->getCallSites(read->getCallPath()) == std::vector<const llvm::CallBase *>{spawn, callAdder});
+  CHECK(program.callPaths->getCallSites(pvalRead->getCallPath()) == std::vector<const llvm::CallBase *>{spawn});
+  CHECK(events.at(3)->getCallPath() == pvalRead->getCallPath());
+  CHECK(program.callPaths->getParent(read->getCallPath()) == pvalRead->getCallPath());
 }
 
 TEST_CASE("Construct pthread ThreadTrace", "[unit][event]") {